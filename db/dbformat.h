@@ -6,6 +6,7 @@
 #include "include/leveldb/comparator.h"
 #include "include/leveldb/db.h"
 #include "include/leveldb/slice.h"
+#include "util/coding.h"
 
 namespace leveldb
 {
@@ -29,6 +30,15 @@ inline Slice ExtractUserKey(const Slice& internal_key)
 	return Slice(internal_key.data(), internal_key.size() - 8);
 }
 
+inline ValueType ExtractValueType(const Slice& internal_key)
+{
+	assert(internal_key.size() >= 8);
+	const size_t n = internal_key.size();
+	uint64_t num = DecodeFixed64(internal_key.data() + n - 8);
+	unsigned char c = num & 0xff;
+	return static_cast<ValueType>(c);
+}
+
 class InternalKeyComparator : public Comparator
 {
 private:
@@ -0,0 +1,25 @@
+#include "db/filename.h"
+
+#include <stdio.h>
+
+namespace leveldb
+{
+
+static std::string MakeFileName(const std::string& name, uint64_t number,
+								const char* suffix) {
+	char buf[100];
+	snprintf(buf, sizeof(buf), "/%06llu.%s",
+		static_cast<unsigned long long>(number),
+		suffix);
+	return name + buf;
+}
+
+std::string TableFileName(const std::string& dbname, uint64_t number) {
+	return MakeFileName(dbname, number, "ldb");
+}
+
+std::string SSTTableFileName(const std::string& dbname, uint64_t number) {
+	return MakeFileName(dbname, number, "sst");
+}
+
+}  // namespace leveldb
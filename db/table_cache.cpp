@@ -0,0 +1,167 @@
+#include "db/table_cache.h"
+
+#include <assert.h>
+#include "db/filename.h"
+#include "include/leveldb/env.h"
+#include "include/leveldb/table.h"
+#include "port/port.h"
+#include "util/coding.h"
+#include "util/mutexlock.h"
+
+namespace leveldb
+{
+
+struct TableAndFile {
+	RandomAccessFile* file;
+	Table* table;
+	RandomAccessFile::AccessPattern access_pattern;  // Outside of scans
+
+	// Guards scans and the hints given when it changes between zero and
+	// non-zero, so that they reach the file in the order of the changes
+	port::Mutex mutex;
+	int scans;  // Live iterators with sequential_scan
+};
+
+static void DeleteEntry(const Slice& key, void* value) {
+	TableAndFile* tf = reinterpret_cast<TableAndFile*>(value);
+	delete tf->table;
+	delete tf->file;
+	delete tf;
+}
+
+static void UnrefEntry(void* arg1, void* arg2) {
+	Cache* cache = reinterpret_cast<Cache*>(arg1);
+	Cache::Handle* h = reinterpret_cast<Cache::Handle*>(arg2);
+	cache->Release(h);
+}
+
+// Like UnrefEntry(), for an iterator with ReadOptions::sequential_scan.
+// Hands the file back to point lookups once the last scan is done.
+static void UnrefScanEntry(void* arg1, void* arg2) {
+	Cache* cache = reinterpret_cast<Cache*>(arg1);
+	Cache::Handle* h = reinterpret_cast<Cache::Handle*>(arg2);
+	TableAndFile* tf = reinterpret_cast<TableAndFile*>(cache->Value(h));
+	{
+		MutexLock l(&tf->mutex);
+		if (--tf->scans == 0) {
+			tf->file->Hint(tf->access_pattern);
+		}
+	}
+	cache->Release(h);
+}
+
+TableCache::TableCache(const std::string& dbname,
+					const Options& options,
+					Env* env,
+					int entries)
+	: env_(env),
+	  dbname_(dbname),
+	  options_(options),
+	  cache_(NewLRUCache(entries, 0.0, false, 0)) {
+}
+
+TableCache::~TableCache() {
+	delete cache_;
+}
+
+Status TableCache::FindTable(uint64_t file_number, uint64_t file_size,
+							Cache::Handle** handle) {
+	Status s;
+	char buf[sizeof(file_number)];
+	EncodeFixed64(buf, file_number);
+	Slice key(buf, sizeof(buf));
+	*handle = cache_->Lookup(key);
+	if (*handle == NULL) {
+		std::string fname = TableFileName(dbname_, file_number);
+		RandomAccessFile* file = NULL;
+		Table* table = NULL;
+		RandomAccessFileOptions file_options;
+		file_options.use_mmap_reads = options_.use_mmap_reads;
+		s = env_->NewRandomAccessFile(fname, file_options, &file);
+		if (!s.ok()) {
+			std::string old_fname = SSTTableFileName(dbname_, file_number);
+			if (env_->NewRandomAccessFile(old_fname, file_options, &file).ok()) {
+				s = Status::OK();
+			}
+		}
+		const RandomAccessFile::AccessPattern access_pattern = options_.advise_random_on_open ?
+			RandomAccessFile::kRandom : RandomAccessFile::kNormal;
+		if (s.ok()) {
+			file->Hint(access_pattern);
+			s = Table::Open(options_, file, file_size, &table);
+		}
+
+		if (!s.ok()) {
+			assert(table == NULL);
+			delete file;
+			// We do not cache error results so that if the error is transient,
+			// or somebody repairs the file, we recover automatically.
+		} else {
+			TableAndFile* tf = new TableAndFile;
+			tf->file = file;
+			tf->table = table;
+			tf->access_pattern = access_pattern;
+			tf->scans = 0;
+			*handle = cache_->Insert(key, tf, 1, &DeleteEntry);
+		}
+	}
+	return s;
+}
+
+Iterator* TableCache::NewIterator(const ReadOptions& options,
+								uint64_t file_number,
+								uint64_t file_size,
+								Table** tableptr) {
+	if (tableptr != NULL) {
+		*tableptr = NULL;
+	}
+
+	Cache::Handle* handle = NULL;
+	Status s = FindTable(file_number, file_size, &handle);
+	if (!s.ok()) {
+		return NewErrorIterator(s);
+	}
+
+	TableAndFile* tf = reinterpret_cast<TableAndFile*>(cache_->Value(handle));
+	Table* table = tf->table;
+	Iterator* result = table->NewIterator(options);
+	if (options.sequential_scan) {
+		{
+			MutexLock l(&tf->mutex);
+			if (tf->scans++ == 0) {
+				tf->file->Hint(RandomAccessFile::kSequential);
+			}
+		}
+		result->RegisterCleanup(&UnrefScanEntry, cache_, handle);
+	} else {
+		result->RegisterCleanup(&UnrefEntry, cache_, handle);
+	}
+	if (tableptr != NULL) {
+		*tableptr = table;
+	}
+	return result;
+}
+
+Status TableCache::Get(const ReadOptions& options,
+					uint64_t file_number,
+					uint64_t file_size,
+					const Slice& k,
+					void* arg,
+					void (*handle_result)(void*, const Slice&, const Slice&)) {
+	Cache::Handle* handle = NULL;
+	Status s = FindTable(file_number, file_size, &handle);
+	if (s.ok()) {
+		Table* t = reinterpret_cast<TableAndFile*>(cache_->Value(handle))->table;
+		s = t->InternalGet(options, k, arg, handle_result);
+		cache_->Release(handle);
+	}
+	return s;
+}
+
+void TableCache::Evict(uint64_t file_number) {
+	char buf[sizeof(file_number)];
+	EncodeFixed64(buf, file_number);
+	cache_->Erase(Slice(buf, sizeof(buf)));
+}
+
+}  // namespace leveldb
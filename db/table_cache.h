@@ -0,0 +1,69 @@
+// Thread-safe (provides internal synchronization)
+
+#ifndef STORAGE_LEVELDB_DB_TABLE_CACHE_H_
+#define STORAGE_LEVELDB_DB_TABLE_CACHE_H_
+
+#include <stdint.h>
+#include <string>
+#include "include/leveldb/cache.h"
+#include "include/leveldb/options.h"
+#include "include/leveldb/table.h"
+
+namespace leveldb
+{
+
+class Env;
+
+// Keeps the tables of a database open between reads.  An open table
+// holds a file descriptor and its parsed index and filter, so a read of
+// a cached table costs no open() and no index read.  At most "entries"
+// tables are kept open; the least recently used is closed to make room
+// for another.  Tables that iterators or reads still use stay open until
+// they are done with them, even beyond "entries".
+class TableCache
+{
+public:
+	// "options" must outlive the cache.
+	TableCache(const std::string& dbname, const Options& options, Env* env, int entries);
+	~TableCache();
+
+	// Return an iterator for the specified file number (the corresponding
+	// file length must be exactly "file_size" bytes).  If "tableptr" is
+	// non-NULL, also sets "*tableptr" to point to the Table object
+	// underlying the returned iterator, or NULL if no Table object underlies
+	// the returned iterator.  The returned "*tableptr" object is owned by
+	// the cache and should not be deleted, and is valid for as long as the
+	// returned iterator is live.
+	Iterator* NewIterator(const ReadOptions& options,
+						uint64_t file_number,
+						uint64_t file_size,
+						Table** tableptr = NULL);
+
+	// If a seek to internal key "k" in specified file finds an entry,
+	// call (*handle_result)(arg, found_key, found_value).
+	Status Get(const ReadOptions& options,
+			uint64_t file_number,
+			uint64_t file_size,
+			const Slice& k,
+			void* arg,
+			void (*handle_result)(void*, const Slice&, const Slice&));
+
+	// Evict any entry for the specified file number
+	void Evict(uint64_t file_number);
+
+private:
+	Status FindTable(uint64_t file_number, uint64_t file_size, Cache::Handle**);
+
+	Env* const env_;
+	const std::string dbname_;
+	const Options& options_;
+	Cache* cache_;  // One shard, so that "entries" is an exact bound
+
+	// No copying allowed
+	TableCache(const TableCache&);
+	void operator=(const TableCache&);
+};
+
+}  // namespace leveldb
+
+#endif  // STORAGE_LEVELDB_DB_TABLE_CACHE_H_
@@ -0,0 +1,139 @@
+#ifndef STORAGE_LEVELDB_INCLUDE_BLOB_FILE_H_
+#define STORAGE_LEVELDB_INCLUDE_BLOB_FILE_H_
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include "include/leveldb/export.h"
+#include "include/leveldb/options.h"
+#include "include/leveldb/status.h"
+
+namespace leveldb {
+
+class BlockHandle;
+class RandomAccessFile;
+class WritableFile;
+
+// Large values can be kept out of a table's data blocks: a TableBuilder
+// given a BlobFileBuilder appends every value of at least
+// Options::min_blob_size bytes to the blob file and stores only a small
+// reference to it.  Table resolves the references through the
+// BlobFileReaders registered in Options::blob_files.  Rewriting a table,
+// e.g. during a compaction, then copies the references, not the values.
+
+// Writes one blob file.  Every blob file needs a number that is unique
+// among the blob files registered with the same BlobFileSet.
+class LEVELDB_EXPORT BlobFileBuilder {
+public:
+	// Create a builder that appends blobs to *file.  Does not close the
+	// file.  It is up to the caller to close the file after calling Finish().
+	BlobFileBuilder(const Options& options, WritableFile* file, uint64_t file_number);
+
+	// REQUIRES: Either Finish() or Abandon() has been called.
+	~BlobFileBuilder();
+
+	// Append "value" to the blob file and store its location in *handle.
+	// REQUIRES: Finish(), Abandon() have not been called
+	Status Add(const Slice& value, BlockHandle* handle);
+
+	// Return non-ok iff some error has been detected.
+	Status status() const { return status_; }
+
+	// Write the footer.  Stops using the file passed to the constructor
+	// after this function returns.
+	// REQUIRES: Finish(), Abandon() have not been called
+	Status Finish();
+
+	// Indicate that the contents of this builder should be abandoned.
+	// REQUIRES: Finish(), Abandon() have not been called
+	void Abandon();
+
+	uint64_t file_number() const { return file_number_; }
+
+	// Number of calls to Add() so far.
+	uint64_t NumBlobs() const { return num_blobs_; }
+
+	// Size of the file generated so far.
+	uint64_t FileSize() const { return offset_; }
+
+private:
+	WritableFile* file_;
+	const uint64_t file_number_;
+	uint64_t offset_;
+	uint64_t num_blobs_;
+	Status status_;
+	bool closed_;
+
+	// No copying allowed
+	BlobFileBuilder(const BlobFileBuilder&);
+	void operator=(const BlobFileBuilder&);
+};
+
+// Reads blobs from one blob file.  If Options::blob_cache is non-NULL
+// the blobs read are kept in it.  Safe for concurrent use.
+class LEVELDB_EXPORT BlobFileReader {
+public:
+	// Open the blob file numbered "file_number" that is stored in bytes
+	// [0..file_size) of "file".  Reads only the footer.
+	//
+	// "file" must remain live while this BlobFileReader is in use.
+	static Status Open(const Options& options, RandomAccessFile* file,
+		uint64_t file_number, uint64_t file_size, BlobFileReader** reader);
+
+	~BlobFileReader();
+
+	// Store the blob at "handle" in *value.
+	Status Get(const ReadOptions& options, const BlockHandle& handle,
+		std::string* value) const;
+
+	uint64_t file_number() const { return file_number_; }
+
+	// Number of blobs in the file.
+	uint64_t NumBlobs() const { return num_blobs_; }
+
+private:
+	BlobFileReader(const Options& options, RandomAccessFile* file,
+		uint64_t file_number, uint64_t num_blobs);
+
+	Options options_;
+	RandomAccessFile* file_;
+	const uint64_t file_number_;
+	const uint64_t num_blobs_;
+	uint64_t cache_id_;
+
+	// No copying allowed
+	BlobFileReader(const BlobFileReader&);
+	void operator=(const BlobFileReader&);
+};
+
+// The blob files that tables may refer to, by file number.  Add() and
+// Remove() must not run concurrently with reads.
+class LEVELDB_EXPORT BlobFileSet {
+public:
+	BlobFileSet() { }
+
+	// Deletes all registered readers.
+	~BlobFileSet();
+
+	// Register "reader" under its file number and take ownership of it.
+	// A reader previously registered under that number is deleted.
+	void Add(BlobFileReader* reader);
+
+	// Unregister and delete the reader of blob file "file_number", if any.
+	void Remove(uint64_t file_number);
+
+	// Return the reader of blob file "file_number", or NULL.
+	BlobFileReader* Find(uint64_t file_number) const;
+
+private:
+	typedef std::map<uint64_t, BlobFileReader*> ReaderMap;
+	ReaderMap readers_;
+
+	// No copying allowed
+	BlobFileSet(const BlobFileSet&);
+	void operator=(const BlobFileSet&);
+};
+
+}  // namespace leveldb
+
+#endif  // STORAGE_LEVELDB_INCLUDE_BLOB_FILE_H_
@@ -10,8 +10,49 @@ namespace leveldb {
 class LEVELDB_EXPORT Cache;
 
 // Create a new cache with a fixed size capacity.  This implementation
-// of Cache uses a least-recently-used eviction policy.
-LEVELDB_EXPORT Cache* NewLRUCache(size_t capacity);
+// of Cache uses a least-recently-used eviction policy.  The cache is
+// split into 2^num_shard_bits shards by key hash, each with its own lock
+// and an equal part of the capacity, so that threads using different
+// shards do not wait for each other.  A shard evicts once its own part
+// is full, so with many shards and few large entries the cache may
+// evict before its total reaches the capacity, or hold up to one entry
+// per shard beyond it; a single shard (num_shard_bits == 0) keeps the
+// capacity exactly.
+//
+// Up to high_pri_pool_ratio of the capacity is reserved for entries
+// inserted with Cache::kHighPriority: entries of low priority are evicted
+// first, and high-priority ones only once they have been the least
+// recently used for longer than the pool holds.  Scans that stream many
+// low-priority blocks through the cache then leave the high-priority
+// ones alone.  If strict_capacity_limit is true, Insert() fails rather
+// than exceed the capacity when the entries in use fill it.
+LEVELDB_EXPORT Cache* NewLRUCache(size_t capacity, double high_pri_pool_ratio = 0.0,
+	bool strict_capacity_limit = false, int num_shard_bits = 4);
+
+// Create a new LRU cache with a fixed size capacity that admits entries
+// by frequency (W-TinyLFU).  New entries start in a small window; to
+// move on from there into the LRU list an entry must have been looked up
+// more often than the LRU entry it would displace, as told by a compact
+// frequency sketch of recently looked up keys.  Blocks that a
+// scan reads once then only pass through the window, and the blocks
+// point lookups keep coming back to stay cached even when scans do not
+// turn off ReadOptions::fill_cache.  The sketch is sized for
+// capacity / estimated_entry_charge entries, e.g. the block size.
+LEVELDB_EXPORT Cache* NewTinyLFUCache(size_t capacity, size_t estimated_entry_charge);
+
+// Create a new cache with a fixed size capacity that evicts with the
+// CLOCK (second chance) policy.  Entries are kept in a fixed-size
+// open-addressing table, sized for capacity / estimated_entry_charge
+// entries, and Lookup() and Release() take no lock: a hit only updates
+// one word of the entry with compare-and-swap.  Prefer it to
+// NewLRUCache() when many threads hit the cache.  If far more entries
+// than estimated fit in the capacity, the table fills up before the
+// capacity does and the extra entries are not cached.  Entries inserted
+// with Cache::kHighPriority survive more clock sweeps without a hit.  If
+// strict_capacity_limit is true, Insert() fails rather than exceed the
+// capacity or hand out an entry it has no room for.
+LEVELDB_EXPORT Cache* NewClockCache(size_t capacity, size_t estimated_entry_charge,
+	bool strict_capacity_limit = false);
 
 class LEVELDB_EXPORT Cache {
 public:
@@ -24,6 +65,36 @@ public:
 	// Opaque handle to an entry stored in the cache.
 	struct Handle { };
 
+	// How readily an entry gives up its place to others.  Caches that
+	// reserve room for high-priority entries evict them last.
+	enum Priority {
+		kLowPriority,
+		kHighPriority
+	};
+
+	// What an entry holds.  Caches keep their statistics by role, so that
+	// e.g. data blocks thrashing can be told from filters thrashing.
+	enum EntryRole {
+		kDataBlock,
+		kIndexBlock,
+		kFilterBlock,
+		kOtherEntry,
+		kNumEntryRoles
+	};
+
+	// Counters of a cache, by entry role.  Lookups, hits, inserts and
+	// evictions count from the creation of the cache; an insert counts if
+	// the entry was cached, an eviction if an entry went to make room for
+	// another.  Bytes is the charge of the entries of the role the cache
+	// holds.
+	struct Statistics {
+		uint64_t lookups[kNumEntryRoles];
+		uint64_t hits[kNumEntryRoles];
+		uint64_t inserts[kNumEntryRoles];
+		uint64_t evictions[kNumEntryRoles];
+		uint64_t bytes[kNumEntryRoles];
+	};
+
 	// Insert a mapping from key->value into the cache and assign it
 	// the specified charge against the total cache capacity.
 	//
@@ -33,15 +104,32 @@ public:
 	//
 	// When the inserted entry is no longer needed, the key and
 	// value will be passed to "deleter".
+	//
+	// A cache with a strict capacity limit returns NULL if the entry does
+	// not fit next to the entries in use.  Nothing is inserted then, and
+	// "deleter" is not called: the caller keeps ownership of value.
+	//
+	// "role" is what the entry holds, for the statistics.
+	//
+	// If "evictor" is non-NULL, the key and value are passed to it instead
+	// of "deleter" when the entry was evicted to make room for others, e.g.
+	// to move the value to a secondary tier.  Entries erased, replaced by
+	// an Insert() of the same key or dropped with the cache still go to
+	// "deleter".
 	virtual Handle* Insert(const Slice& key, void* value, size_t charge,
-							void (*deleter)(const Slice& key, void* value)) = 0;
+							void (*deleter)(const Slice& key, void* value),
+							Priority priority = kLowPriority,
+							EntryRole role = kOtherEntry,
+							void (*evictor)(const Slice& key, void* value) = NULL) = 0;
 
 	// If the cache has no mapping for "key", returns NULL.
 	//
 	// Else return a handle that corresponds to the mapping.  The caller
 	// must call this->Release(handle) when the returned mapping is no
 	// longer needed.
-	virtual Handle* Lookup(const Slice& key) = 0;
+	//
+	// "role" is what the caller looks for, for the statistics.
+	virtual Handle* Lookup(const Slice& key, EntryRole role = kOtherEntry) = 0;
 
 	// Release a mapping returned by a previous Lookup().
 	// REQUIRES: handle must not have been released yet.
@@ -76,14 +164,13 @@ public:
 	// cache.
 	virtual size_t TotalCharge() const = 0;
 
-private:
-	void LRU_Remove(Handle* e);
-	void LRU_Append(Handle* e);
-	void Unref(Handle* e);
-
-	struct Rep;
-	Rep* rep_;
+	// Store a snapshot of the cache's counters in *stats.  The counters
+	// are read one by one while the cache is in use, so they need not be
+	// consistent with each other.  The default implementation reports
+	// zeros.
+	virtual void GetStatistics(Statistics* stats) const;
 
+private:
 	// No copying allowed
 	Cache(const Cache&);
 	void operator=(const Cache&);
@@ -0,0 +1,52 @@
+#ifndef STORAGE_LEVELDB_INCLUDE_CUCKOO_TABLE_H_
+#define STORAGE_LEVELDB_INCLUDE_CUCKOO_TABLE_H_
+
+#include <stdint.h>
+#include "include/leveldb/export.h"
+#include "include/leveldb/status.h"
+
+namespace leveldb {
+
+struct Options;
+class RandomAccessFile;
+struct ReadOptions;
+
+// A CuckooTable is a read-only map from strings to strings that only
+// supports lookups by exact key.  The records are stored in a cuckoo hash
+// table: every key lives in one of two buckets picked by two hash
+// functions, so a Get() reads at most two buckets from the file.  There
+// is no index or filter block; only the footer is kept in memory.
+class LEVELDB_EXPORT CuckooTable {
+public:
+	// Attempt to open the cuckoo table that is stored in bytes
+	// [0..file_size) of "file".  Reads only the footer.
+	//
+	// "file" must remain live while this CuckooTable is in use.
+	static Status Open(const Options& options, RandomAccessFile* file,
+		uint64_t file_size, CuckooTable** table);
+
+	~CuckooTable();
+
+	// If the table holds "key", call (*handle_result)(arg, found_key,
+	// found_value).  For internal keys the record with the user key of
+	// "key" is passed, whatever its sequence number.  Issues at most two
+	// reads.
+	Status Get(const ReadOptions& options, const Slice& key, void* arg,
+		void (*handle_result)(void* arg, const Slice& k, const Slice& v)) const;
+
+	// Number of records in the table.
+	uint64_t NumEntries() const;
+
+private:
+	struct Rep;
+	Rep* rep_;
+	explicit CuckooTable(Rep* rep) { rep_ = rep; }
+
+	// No copying allowed
+	CuckooTable(const CuckooTable&);
+	void operator=(const CuckooTable&);
+};
+
+}
+
+#endif  // STORAGE_LEVELDB_INCLUDE_CUCKOO_TABLE_H_
@@ -0,0 +1,68 @@
+#ifndef STORAGE_LEVELDB_INCLUDE_CUCKOO_TABLE_BUILDER_H_
+#define STORAGE_LEVELDB_INCLUDE_CUCKOO_TABLE_BUILDER_H_
+
+#include <stdint.h>
+#include "include/leveldb/export.h"
+#include "include/leveldb/options.h"
+#include "include/leveldb/status.h"
+
+namespace leveldb
+{
+
+class WritableFile;
+
+// CuckooTableBuilder writes the file format read by CuckooTable.  It takes
+// the same sorted input as TableBuilder, buffers all of it in memory and
+// lays it out as a cuckoo hash table in Finish().  Every slot is as large
+// as the largest key plus the largest value, so the format suits records
+// of similar size.
+//
+// For internal keys every user key may be added only once.
+class LEVELDB_EXPORT CuckooTableBuilder
+{
+public:
+	// Create a builder that will store the contents of the table it is
+	// building in *file.  Does not close the file.  It is up to the
+	// caller to close the file after calling Finish().
+	CuckooTableBuilder(const Options& options, WritableFile* file);
+
+	// REQUIRES: Either Finish() or Abandon() has been called.
+	~CuckooTableBuilder();
+
+	// Add key,value to the table being constructed.
+	// REQUIRES: key is after any previously added key according to comparator.
+	// REQUIRES: Finish(), Abandon() have not been called
+	void Add(const Slice& key, const Slice& value);
+
+	// Return non-ok iff some error has been detected.
+	Status status() const;
+
+	// Place the buffered records and write the table.  Stops using the
+	// file passed to the constructor after this function returns.
+	// REQUIRES: Finish(), Abandon() have not been called
+	Status Finish();
+
+	// Indicate that the contents of this builder should be abandoned.
+	// REQUIRES: Finish(), Abandon() have not been called
+	void Abandon();
+
+	// Number of calls to Add() so far.
+	uint64_t NumEntries() const;
+
+	// Size of the file generated so far.  Zero until Finish() is called.
+	uint64_t FileSize() const;
+
+private:
+	bool ok() const { return status().ok(); }
+
+	struct Rep;
+	Rep* rep_;
+
+	// No copying allowed
+	CuckooTableBuilder(const CuckooTableBuilder&);
+	void operator=(const CuckooTableBuilder&);
+};
+
+}
+
+#endif  // STORAGE_LEVELDB_INCLUDE_CUCKOO_TABLE_BUILDER_H_
@@ -1,3 +1,6 @@
+#ifndef STORAGE_LEVELDB_INCLUDE_ENV_H_
+#define STORAGE_LEVELDB_INCLUDE_ENV_H_
+
 #include <stdarg.h>
 #include <stdint.h>
 #include <string>
@@ -8,6 +11,85 @@
 namespace leveldb 
 {
 
+// Options for files created by Env::NewWritableFile().
+struct LEVELDB_EXPORT WritableFileOptions {
+	// Appends are collected in a buffer of this size and written to the
+	// operating system when it fills up or on Flush(), Sync() and Close().
+	// Zero writes every Append() through immediately.
+	//
+	// Default: 1MB
+	size_t buffer_size;
+
+	// If non-zero, disk space is reserved ahead of the writes in steps of
+	// this many bytes, which keeps the file contiguous and saves the
+	// file system from allocating blocks on every write.  Set it to about
+	// the expected file size.  Space reserved past the end of the file is
+	// released on Close().  Ignored where the platform cannot preallocate.
+	//
+	// Default: 0
+	uint64_t preallocation_size;
+
+	// If non-zero, start writing back every this many bytes in the
+	// background, so that the final Sync() has little left to do.  This
+	// does not make the data durable.  Ignored where not supported.
+	//
+	// Default: 0
+	uint64_t bytes_per_sync;
+
+	WritableFileOptions()
+		: buffer_size(1024 * 1024),
+		  preallocation_size(0),
+		  bytes_per_sync(0) {
+	}
+};
+
+// Options for files opened by Env::NewRandomAccessFile().
+struct LEVELDB_EXPORT RandomAccessFileOptions {
+	// If true, the whole file is memory-mapped and reads return pointers
+	// into the mapping without copying.  If false, every read is a
+	// pread() into the caller's buffer, which keeps the address space
+	// small for many or large files and lets RandomAccessFile::Hint()
+	// steer the kernel's readahead.
+	//
+	// Default: true
+	bool use_mmap_reads;
+
+	RandomAccessFileOptions()
+		: use_mmap_reads(true) {
+	}
+};
+
+// A file abstraction for reading sequentially through a file
+class LEVELDB_EXPORT SequentialFile {
+public:
+	SequentialFile() { }
+	virtual ~SequentialFile();
+
+	// Read up to "n" bytes from the file.  "scratch[0..n-1]" may be
+	// written by this routine.  Sets "*result" to the data that was
+	// read (including if fewer than "n" bytes were successfully read).
+	// May set "*result" to point at data in "scratch[0..n-1]", so
+	// "scratch[0..n-1]" must be live when "*result" is used.
+	// If an error was encountered, returns a non-OK status.
+	//
+	// REQUIRES: External synchronization
+	virtual Status Read(size_t n, Slice* result, char* scratch) = 0;
+
+	// Skip "n" bytes from the file. This is guaranteed to be no
+	// slower that reading the same data, but may be faster.
+	//
+	// If end of file is reached, skipping will stop at the end of the
+	// file, and Skip will return OK.
+	//
+	// REQUIRES: External synchronization
+	virtual Status Skip(uint64_t n) = 0;
+
+private:
+	// No copying allowed
+	SequentialFile(const SequentialFile&);
+	void operator=(const SequentialFile&);
+};
+
 class LEVELDB_EXPORT WritableFile {
 public:
 	WritableFile() { }
@@ -17,8 +99,10 @@ public:
 
 	virtual Status Close() = 0;
 
+	// Hand buffered data to the operating system.
 	virtual Status Flush() = 0;
 
+	// Flush, then wait until the data is on stable storage.
 	virtual Status Sync() = 0;
 
 private:
@@ -45,6 +129,35 @@ public:
 	virtual Status Read(uint64_t offset, size_t n, Slice* result,
 		char* scratch) const = 0;
 
+	// Returns true iff Read() never uses "scratch" and the slices it
+	// returns stay valid for the lifetime of this file (e.g. because the
+	// file is memory-mapped).  Callers may then pass a NULL scratch
+	// buffer and use the result without copying it.
+	virtual bool ReturnsStablePointers() const { return false; }
+
+	// Store an identifier of the file in id[0,max_size-1] and return its
+	// length.  The identifier stays the same across processes and restarts
+	// and differs from that of every other file that exists at the same
+	// time, so it can name the file's blocks in a persistent cache.
+	// Returns 0 if the file has no such identifier or it needs more than
+	// "max_size" bytes.
+	virtual size_t GetUniqueId(char* id, size_t max_size) const { return 0; }
+
+	// How the file is about to be read, for the operating system to plan
+	// its readahead and caching by.  The hint applies to the whole file
+	// and to every reader of this object; the latest one wins.
+	enum AccessPattern {
+		kNormal,        // No particular pattern
+		kRandom,        // Point lookups: read no more than asked for
+		kSequential,    // Scans: read far ahead
+		kWillNeed,      // Start reading the file into memory now
+		kDontNeed       // Drop the file's cached pages
+	};
+
+	// Pass "pattern" on to the operating system.  A hint that cannot be
+	// applied is ignored.  The default implementation does nothing.
+	virtual void Hint(AccessPattern pattern) { }
+
 private:
 	// No copying allowed
 	RandomAccessFile(const RandomAccessFile&);
@@ -56,9 +169,126 @@ public:
 	Env() { }
 	virtual ~Env();
 
+	// Return a default environment suitable for the current operating
+	// system.  Sophisticated users may wish to provide their own Env
+	// implementation instead of relying on this default environment.
+	//
+	// The result of Default() belongs to leveldb and must never be deleted.
+	static Env* Default();
+
+	// Create a brand new sequentially-readable file with the specified name.
+	// On success, stores a pointer to the new file in *result and returns OK.
+	// On failure stores NULL in *result and returns non-OK.  If the file does
+	// not exist, returns a non-OK status.
+	//
+	// The returned file will only be accessed by one thread at a time.
+	virtual Status NewSequentialFile(const std::string& fname,
+		SequentialFile** result) = 0;
+
+	// Create a brand new random access read-only file with the
+	// specified name.  On success, stores a pointer to the new file in
+	// *result and returns OK.  On failure stores NULL in *result and
+	// returns non-OK.  If the file does not exist, returns a non-OK
+	// status.
+	//
+	// The returned file may be concurrently accessed by multiple threads.
+	virtual Status NewRandomAccessFile(const std::string& fname,
+		RandomAccessFile** result) = 0;
+
+	// Like NewRandomAccessFile() above, with control over how the file is
+	// read.  The default implementation ignores "options".
+	virtual Status NewRandomAccessFile(const std::string& fname,
+		const RandomAccessFileOptions& options, RandomAccessFile** result) {
+		return NewRandomAccessFile(fname, result);
+	}
+
+	// Create an object that writes to a new file with the specified
+	// name.  Deletes any existing file with the same name and creates a
+	// new file.  On success, stores a pointer to the new file in
+	// *result and returns OK.  On failure stores NULL in *result and
+	// returns non-OK.
+	//
+	// The returned file will only be accessed by one thread at a time.
 	virtual Status NewWritableFile(const std::string& fname,
 		WritableFile** result) = 0;
 
+	// Like NewWritableFile() above, with control over buffering and
+	// preallocation.  The default implementation ignores "options".
+	virtual Status NewWritableFile(const std::string& fname,
+		const WritableFileOptions& options, WritableFile** result) {
+		return NewWritableFile(fname, result);
+	}
+
+	// Store in *result the names of the children of the specified directory.
+	// The names are relative to "dir".
+	// Original contents of *results are dropped.
+	virtual Status GetChildren(const std::string& dir,
+		std::vector<std::string>* result) = 0;
+
+	// Delete the named file.
+	virtual Status RemoveFile(const std::string& fname) = 0;
+
+	// Start a new thread, invoking "function(arg)" within the new thread.
+	// When "function(arg)" returns, the thread will be destroyed.
+	virtual void StartThread(void (*function)(void* arg), void* arg) = 0;
+
+	// Returns the number of micro-seconds since some fixed point in time. Only
+	// useful for computing deltas of time.
+	virtual uint64_t NowMicros() = 0;
+
+private:
+	// No copying allowed
+	Env(const Env&);
+	void operator=(const Env&);
 };
 
-}
\ No newline at end of file
+// An implementation of Env that forwards all calls to another Env.
+// May be useful to clients who wish to override just part of the
+// functionality of another Env.
+class LEVELDB_EXPORT EnvWrapper : public Env {
+public:
+	// Initialize an EnvWrapper that delegates all calls to *t
+	explicit EnvWrapper(Env* t) : target_(t) { }
+	virtual ~EnvWrapper();
+
+	// Return the target to which this Env forwards all calls
+	Env* target() const { return target_; }
+
+	// The following text is boilerplate that forwards all methods to target()
+	Status NewSequentialFile(const std::string& f, SequentialFile** r) {
+		return target_->NewSequentialFile(f, r);
+	}
+	Status NewRandomAccessFile(const std::string& f, RandomAccessFile** r) {
+		return target_->NewRandomAccessFile(f, r);
+	}
+	Status NewRandomAccessFile(const std::string& f, const RandomAccessFileOptions& o,
+		RandomAccessFile** r) {
+		return target_->NewRandomAccessFile(f, o, r);
+	}
+	Status NewWritableFile(const std::string& f, WritableFile** r) {
+		return target_->NewWritableFile(f, r);
+	}
+	Status NewWritableFile(const std::string& f, const WritableFileOptions& o,
+		WritableFile** r) {
+		return target_->NewWritableFile(f, o, r);
+	}
+	Status GetChildren(const std::string& dir, std::vector<std::string>* r) {
+		return target_->GetChildren(dir, r);
+	}
+	Status RemoveFile(const std::string& f) {
+		return target_->RemoveFile(f);
+	}
+	void StartThread(void (*f)(void*), void* a) {
+		return target_->StartThread(f, a);
+	}
+	virtual uint64_t NowMicros() {
+		return target_->NowMicros();
+	}
+
+private:
+	Env* target_;
+};
+
+}
+
+#endif  // STORAGE_LEVELDB_INCLUDE_ENV_H_
@@ -1,6 +1,7 @@
 #ifndef STORAGE_LEVELDB_INCLUDE_FILTER_POLICY_H_
 #define STORAGE_LEVELDB_INCLUDE_FILTER_POLICY_H_
 
+#include <stdint.h>
 #include <string>
 #include "include/leveldb/export.h"
 
@@ -33,11 +34,38 @@ public:
 	// This method may return true or false if the key was not on the
 	// list, but it should aim to return false with a high probability.
 	virtual bool KeyMayMatch(const Slice& key, const Slice& filter) const = 0;
+
+	// Set results[i] to KeyMayMatch(keys[i], filters[i]) for every i in
+	// [0,n-1].  The default checks the keys one at a time; a policy can
+	// override it to overlap the memory accesses of the probes.
+	virtual void KeysMayMatch(const Slice* keys, const Slice* filters, int n,
+		bool* results) const;
+
+	// Return true if the policy can build its filters from 64-bit hashes
+	// of the keys.  Table builders then hash every key as it is added,
+	// with HashKey(), instead of buffering the key bytes, and build the
+	// filter with CreateFilterFromHashes().  The default returns false.
+	virtual bool SupportsKeyHashes() const;
+
+	// Return the hash of "key" that CreateFilterFromHashes() expects.
+	// REQUIRES: SupportsKeyHashes()
+	virtual uint64_t HashKey(const Slice& key) const;
+
+	// hashes[0,n-1] contains HashKey() of a list of keys (potentially with
+	// duplicates).  Append a filter that summarizes the keys to *dst, the
+	// same one that CreateFilter() would append for them.
+	// REQUIRES: SupportsKeyHashes()
+	virtual void CreateFilterFromHashes(const uint64_t* hashes, int n,
+		std::string* dst) const;
 };
 
 // Return a new filter policy that uses a bloom filter with approximately
 // the specified number of bits per key.  A good value for bits_per_key
-// is 10, which yields a filter with ~ 1% false positive rate.
+// is 10, which yields a filter with ~ 1% false positive rate.  The filter
+// is blocked: all bits of a key lie in one 64-byte line of the filter,
+// so a lookup reads 64 contiguous bytes rather than k scattered ones.
+// The lines are not aligned to cache lines in memory (the filter starts
+// wherever it lands in its block), so a lookup touches at most two.
 //
 // Callers must delete the result after any database that is using the
 // result has been closed.
@@ -51,6 +79,21 @@ public:
 // trailing spaces in keys.
 LEVELDB_EXPORT const FilterPolicy* NewBloomFilterPolicy(int bits_per_key);
 
+// Return a new filter policy that uses a binary fuse filter, a static
+// filter of the xor family, with fingerprints of the specified number of
+// bits (1 to 16).  The false positive rate is 2^-fingerprint_bits and
+// large filters take about 1.125 * fingerprint_bits bits per key: with
+// 7 bits, a lower false positive rate than a 10 bits per key bloom
+// filter in about 20% less space.  Filters over few keys, such as the
+// ones built per 2KB of data blocks, need far more space per key, so use
+// this policy with Options::whole_table_filter.  Building a filter is
+// slower than for a bloom filter.
+//
+// Callers must delete the result after any database that is using the
+// result has been closed.  The same caveat about comparators that ignore
+// parts of keys as for NewBloomFilterPolicy() applies.
+LEVELDB_EXPORT const FilterPolicy* NewBinaryFuseFilterPolicy(int fingerprint_bits);
+
 }
 
 #endif  // STORAGE_LEVELDB_INCLUDE_FILTER_POLICY_H_
@@ -6,8 +6,12 @@
 
 namespace leveldb {
 
+class BlobFileSet;
 class Cache;
 class Comparator;
+class FilterPolicy;
+class PersistentCache;
+class SliceTransform;
 class Snapshot;
 
 // DB contents are stored in a set of blocks, each of which holds a
@@ -48,6 +52,36 @@ struct LEVELDB_EXPORT Options {
 	// Default: NULL
 	const FilterPolicy* filter_policy;
 
+	// If true, and filter_policy is non-NULL, build a single filter over
+	// all keys of a table instead of one filter per 2KB of data blocks.
+	// Lookups for absent keys are then usually rejected from memory before
+	// the index block is searched.  The filter is built at the end of the
+	// table, so the keys of the table are kept until then: 8 bytes of hash
+	// per key for policies that support FilterPolicy::SupportsKeyHashes(),
+	// the keys themselves for other policies.
+	//
+	// Default: false
+	bool whole_table_filter;
+
+	// If non-NULL, and filter_policy is non-NULL, the prefix of every key
+	// that this transform extracts is added to the filter as well.  Scans
+	// with ReadOptions::prefix_seek can then skip tables and blocks that
+	// hold no key with the prefix sought.  The transform sees keys exactly
+	// as they are passed to TableBuilder::Add().
+	//
+	// Default: NULL
+	const SliceTransform* prefix_extractor;
+
+	// If true, build a range filter over the keys of a table (the user
+	// keys, for tables keyed by internal keys), so that Table::RangeMayMatch
+	// can rule out short key ranges without reading a data block.  The
+	// filter costs a few bytes per key.
+	//
+	// REQUIRES: the (user) keys are ordered bytewise.
+	//
+	// Default: false
+	bool range_filter;
+
 	// Approximate size of user data packed per block.  Note that the
 	// block size specified here corresponds to uncompressed data.  The
 	// actual size of the unit read from disk may be smaller if
@@ -88,8 +122,86 @@ struct LEVELDB_EXPORT Options {
 	// Default: NULL
 	Cache* block_cache;
 
+	// If true and block_cache is non-NULL, a table keeps its index block
+	// and filters in block_cache, inserted with Cache::kHighPriority,
+	// instead of holding them for as long as it is open.  Their memory
+	// then counts against the cache capacity, and a cache created with a
+	// high-priority pool keeps them resident while scans churn through
+	// data blocks.  A table holds on to any of them the cache refuses.
+	// Default: false
+	bool cache_index_and_filter_blocks;
+
+	// If non-NULL, a second tier behind block_cache that keeps blocks
+	// compressed.  Data blocks that block_cache evicts are compressed
+	// into it, and a data block that misses block_cache is looked up here
+	// before the file is read, moving back up on a hit.  Uncompressing a
+	// block costs far less than reading it, and the tier holds as many
+	// more blocks as its capacity times their compression ratio.  Ignored
+	// if block_cache is NULL.  Must outlive block_cache.
+	// Default: NULL
+	Cache* compressed_block_cache;
+
+	// If non-NULL, blocks read from table files are also stored here, and
+	// a data block that misses the caches above is looked up here before
+	// the file is read.  Meant for tables on slow storage with a cache on
+	// a fast local device that is kept across restarts.  A table's blocks
+	// are named by RandomAccessFile::GetUniqueId() of its file; tables in
+	// files without one do not use the persistent cache.
+	// Default: NULL
+	PersistentCache* persistent_cache;
+
+	// If true, table files opened by a TableCache are memory-mapped;
+	// otherwise they are read with pread().  Mapping saves a copy per
+	// read, reading keeps the address space small for many large files.
+	// See RandomAccessFileOptions::use_mmap_reads.
+	// Default: true
+	bool use_mmap_reads;
+
+	// If true, a TableCache tells the operating system that the table
+	// files it opens are read at random (RandomAccessFile::kRandom), so
+	// that point lookups do not pull in readahead they throw away.  Scans
+	// with ReadOptions::sequential_scan switch a file to sequential
+	// readahead for as long as they run.
+	// Default: true
+	bool advise_random_on_open;
+
+	// Number of bytes at the end of a table file that Table::Open() fetches
+	// with a single read.  The footer and whatever index, metaindex and
+	// filter blocks fit in this range are served from it instead of being
+	// read one by one, which matters on high-latency storage.  Files that
+	// are memory-mapped skip the prefetch.  Zero disables it.
+	//
+	// Default: 64K
+	size_t tail_prefetch_size;
+
+	// Number of leading key bytes that PlainTableBuilder hashes to find a
+	// group of records.  For internal keys the prefix is taken from the
+	// user key.  Lookups scan the records of a group one by one, so the
+	// prefix should select few records.  Keys that share a prefix must be
+	// adjacent in comparator order.  Zero hashes the whole (user) key.
+	//
+	// Default: 0
+	size_t plain_table_prefix_length;
+
+	// Values of at least this many bytes are moved to the blob file of a
+	// TableBuilder that was given one, and the table keeps a reference to
+	// them.  Zero keeps all values in the table.  This parameter can be
+	// changed dynamically.
+	//
+	// Default: 0
+	size_t min_blob_size;
+
+	// If non-NULL, use the specified cache for values read from blob files.
+	// Default: NULL
+	Cache* blob_cache;
+
+	// Blob files that the blob references of a table are resolved against.
+	// Must be non-NULL to read tables whose values were moved to blob files.
+	// Default: NULL
+	BlobFileSet* blob_files;
+
 	// Create an Options object with default values for all fields.
-	Options(){}
+	Options();
 };
 
 // Options that control read operations
@@ -111,10 +223,26 @@ struct LEVELDB_EXPORT ReadOptions {
 	// Default: NULL
 	const Snapshot* snapshot;
 
+	// If true, and Options::prefix_extractor is non-NULL, an iterator
+	// Seek() to a key in the extractor's domain only yields the keys
+	// that share its prefix, and becomes invalid after the last of them.
+	// Tables and blocks whose filter rules the prefix out are not read.
+	// Default: false
+	bool prefix_seek;
+
+	// If true, an iterator is going to read through most of each table it
+	// visits, as the inputs of a compaction are, and the table files are
+	// hinted for sequential readahead (RandomAccessFile::kSequential)
+	// until the last such iterator over a file is deleted.
+	// Default: false
+	bool sequential_scan;
+
 	ReadOptions()
 		: verify_checksums(false),
 		fill_cache(true),
-		snapshot(NULL) {
+		snapshot(NULL),
+		prefix_seek(false),
+		sequential_scan(false) {
 	}
 };
 
@@ -0,0 +1,85 @@
+#ifndef STORAGE_LEVELDB_INCLUDE_PARALLEL_TABLE_WRITER_H_
+#define STORAGE_LEVELDB_INCLUDE_PARALLEL_TABLE_WRITER_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "include/leveldb/export.h"
+#include "include/leveldb/options.h"
+#include "include/leveldb/status.h"
+
+namespace leveldb {
+
+class Env;
+
+// Describes one table file written by a ParallelTableWriter.
+struct LEVELDB_EXPORT ParallelTableFile {
+	std::string filename;
+	uint64_t file_size;
+	uint64_t num_entries;
+	std::string smallest_key;
+	std::string largest_key;
+
+	ParallelTableFile() : file_size(0), num_entries(0) { }
+};
+
+// ParallelTableWriter turns one sorted stream of key,value pairs into a
+// sequence of table files, e.g. to bulk load a prepared data set.  The
+// stream is cut into pieces of roughly target_file_size bytes of keys and
+// values, and the pieces are built into tables on num_threads background
+// threads, each with its own TableBuilder and WritableFile.
+//
+// The i-th file (counting from 0) is named fname_prefix + i + ".ldb",
+// with i written as six digits.  Add() and Finish() must be called from
+// one thread.
+class LEVELDB_EXPORT ParallelTableWriter {
+public:
+	ParallelTableWriter(const Options& options, Env* env,
+		const std::string& fname_prefix, size_t target_file_size, int num_threads);
+
+	// REQUIRES: Either Finish() or Abandon() has been called.
+	~ParallelTableWriter();
+
+	// Add key,value to the stream.  The current piece ends before "key"
+	// once it holds target_file_size bytes, unless "key" has the same
+	// user key as the previous key: all versions of a user key go to the
+	// same file.  Blocks while all threads are busy and enough pieces are
+	// waiting for them.
+	// REQUIRES: key is after any previously added key according to comparator.
+	// REQUIRES: Finish(), Abandon() have not been called
+	void Add(const Slice& key, const Slice& value);
+
+	// Return non-ok iff some error has been detected, in this thread or
+	// in a background thread.
+	Status status() const;
+
+	// Build the last piece, wait for all files to be written, synced and
+	// closed, and return the first error, if any.
+	// REQUIRES: Finish(), Abandon() have not been called
+	Status Finish();
+
+	// Stop writing: pieces that have not been started are dropped and the
+	// call waits for the ones being built.  Files already written are
+	// left in place.
+	// REQUIRES: Finish(), Abandon() have not been called
+	void Abandon();
+
+	// The files written, in key order.  Complete after Finish() returns OK.
+	const std::vector<ParallelTableFile>& files() const;
+
+private:
+	struct Rep;
+	Rep* rep_;
+
+	void Submit();
+	void WaitForWorkers();
+	static void BGWork(void* arg);
+
+	// No copying allowed
+	ParallelTableWriter(const ParallelTableWriter&);
+	void operator=(const ParallelTableWriter&);
+};
+
+}  // namespace leveldb
+
+#endif  // STORAGE_LEVELDB_INCLUDE_PARALLEL_TABLE_WRITER_H_
@@ -0,0 +1,77 @@
+#ifndef STORAGE_LEVELDB_INCLUDE_PERSISTENT_CACHE_H_
+#define STORAGE_LEVELDB_INCLUDE_PERSISTENT_CACHE_H_
+
+#include <stdint.h>
+#include <string>
+#include "include/leveldb/export.h"
+#include "include/leveldb/slice.h"
+#include "include/leveldb/status.h"
+
+namespace leveldb {
+
+class Env;
+
+// A cache of blocks kept in files on a fast local device, for tables
+// that live on slow (e.g. network) storage.  Unlike a Cache it holds
+// copies of the block contents, not objects, so that it can outlive the
+// process: a cache opened again on the same files finds the blocks that
+// an earlier process stored.  See Options::persistent_cache.
+//
+// Safe for concurrent use by multiple threads.
+class LEVELDB_EXPORT PersistentCache {
+public:
+	PersistentCache() { }
+
+	// Closes the cache files; the blocks stay in them for the next open.
+	virtual ~PersistentCache();
+
+	// Store a copy of "data" under "key".  Does nothing if "key" is
+	// already present.  Errors only mean that the data was not stored.
+	virtual Status Insert(const Slice& key, const Slice& data) = 0;
+
+	// If "key" is present, store a copy of its data in *data and return
+	// OK.  Otherwise returns a NotFound status.
+	virtual Status Lookup(const Slice& key, std::string* data) = 0;
+
+	// Return the number of bytes of data the cache holds.
+	virtual uint64_t Size() = 0;
+
+private:
+	// No copying allowed
+	PersistentCache(const PersistentCache&);
+	void operator=(const PersistentCache&);
+};
+
+struct LEVELDB_EXPORT PersistentCacheOptions {
+	// Directory that holds the cache files.  Must exist.  The cache
+	// names its files "<path>/<number>.pcache"; nothing else may use them.
+	std::string path;
+
+	// Used to create and read the cache files.  Must be set, e.g. to
+	// Env::Default().
+	// Default: NULL
+	Env* env;
+
+	// Bytes of cache files to keep.  The oldest file is reused once the
+	// files fill this, dropping the blocks it held.
+	// Default: 1GB
+	uint64_t capacity;
+
+	// Size of each cache file.  Blocks are appended to one file at a time,
+	// whose contents are also kept in memory until it is full, since
+	// only complete files are read back.
+	// Default: 4MB
+	size_t file_size;
+
+	PersistentCacheOptions();
+};
+
+// Open the persistent cache in options.path, recovering the index of the
+// blocks stored there by an earlier process, and store it in *result.
+// The caller should delete *result when it is no longer needed.
+LEVELDB_EXPORT Status NewPersistentCache(const PersistentCacheOptions& options,
+	PersistentCache** result);
+
+}  // namespace leveldb
+
+#endif  // STORAGE_LEVELDB_INCLUDE_PERSISTENT_CACHE_H_
@@ -0,0 +1,67 @@
+#ifndef STORAGE_LEVELDB_INCLUDE_PLAIN_TABLE_H_
+#define STORAGE_LEVELDB_INCLUDE_PLAIN_TABLE_H_
+
+#include <stdint.h>
+#include "include/leveldb/export.h"
+#include "include/leveldb/iterator.h"
+
+namespace leveldb {
+
+struct Options;
+class RandomAccessFile;
+struct ReadOptions;
+
+// A PlainTable is a read-only sorted map from strings to strings meant
+// for tables that are kept entirely in memory, typically through a
+// memory-mapped file.  Records are stored one after another without
+// blocks, compression or restart points, and a hash index over key
+// prefixes (Options::plain_table_prefix_length) finds the records of a
+// prefix without a binary search.  The block cache is never used.
+class LEVELDB_EXPORT PlainTable {
+public:
+	// Attempt to open the plain table that is stored in bytes [0..file_size)
+	// of "file".  If the file returns stable pointers (see
+	// RandomAccessFile::ReturnsStablePointers) the records are used in
+	// place, otherwise the whole file is read into memory.
+	//
+	// "file" must remain live while this PlainTable is in use.
+	static Status Open(const Options& options, RandomAccessFile* file,
+		uint64_t file_size, PlainTable** table);
+
+	~PlainTable();
+
+	// Find the records whose prefix is the prefix of "key" and pass the
+	// first of them at or after "key", if any, to
+	// (*handle_result)(arg, found_key, found_value).
+	Status Get(const ReadOptions& options, const Slice& key, void* arg,
+		void (*handle_result)(void* arg, const Slice& k, const Slice& v)) const;
+
+	// Return an iterator over the table contents.  Seek() goes straight
+	// to the records of the target's prefix; when the table has no record
+	// with that prefix it falls back to a scan from the first record.
+	// Prev() is not supported and leaves the iterator invalid with a
+	// NotSupported status.
+	Iterator* NewIterator(const ReadOptions& options) const;
+
+	// Number of records in the table.
+	uint64_t NumEntries() const;
+
+private:
+	struct Rep;
+	Rep* rep_;
+	explicit PlainTable(Rep* rep) { rep_ = rep; }
+
+	// Return the offset of the first record whose prefix is "prefix", or
+	// kPlainTableEmptyBucket if there is none.
+	uint32_t FindPrefix(const Slice& prefix) const;
+
+	friend class PlainTableIterator;
+
+	// No copying allowed
+	PlainTable(const PlainTable&);
+	void operator=(const PlainTable&);
+};
+
+}
+
+#endif  // STORAGE_LEVELDB_INCLUDE_PLAIN_TABLE_H_
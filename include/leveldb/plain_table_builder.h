@@ -0,0 +1,67 @@
+#ifndef STORAGE_LEVELDB_INCLUDE_PLAIN_TABLE_BUILDER_H_
+#define STORAGE_LEVELDB_INCLUDE_PLAIN_TABLE_BUILDER_H_
+
+#include <stdint.h>
+#include "include/leveldb/export.h"
+#include "include/leveldb/options.h"
+#include "include/leveldb/status.h"
+
+namespace leveldb
+{
+
+class WritableFile;
+
+// PlainTableBuilder writes the file format read by PlainTable.  The
+// records are written uncompressed, one after another, as they are added;
+// the hash index over their prefixes is written by Finish().
+//
+// Options::block_size, block_restart_interval, compression and
+// filter_policy do not apply to this format.
+class LEVELDB_EXPORT PlainTableBuilder
+{
+public:
+	// Create a builder that will store the contents of the table it is
+	// building in *file.  Does not close the file.  It is up to the
+	// caller to close the file after calling Finish().
+	PlainTableBuilder(const Options& options, WritableFile* file);
+
+	// REQUIRES: Either Finish() or Abandon() has been called.
+	~PlainTableBuilder();
+
+	// Add key,value to the table being constructed.
+	// REQUIRES: key is after any previously added key according to comparator.
+	// REQUIRES: Finish(), Abandon() have not been called
+	void Add(const Slice& key, const Slice& value);
+
+	// Return non-ok iff some error has been detected.
+	Status status() const;
+
+	// Finish building the table.  Stops using the file passed to the
+	// constructor after this function returns.
+	// REQUIRES: Finish(), Abandon() have not been called
+	Status Finish();
+
+	// Indicate that the contents of this builder should be abandoned.
+	// REQUIRES: Finish(), Abandon() have not been called
+	void Abandon();
+
+	// Number of calls to Add() so far.
+	uint64_t NumEntries() const;
+
+	// Size of the file generated so far.
+	uint64_t FileSize() const;
+
+private:
+	bool ok() const { return status().ok(); }
+
+	struct Rep;
+	Rep* rep_;
+
+	// No copying allowed
+	PlainTableBuilder(const PlainTableBuilder&);
+	void operator=(const PlainTableBuilder&);
+};
+
+}
+
+#endif  // STORAGE_LEVELDB_INCLUDE_PLAIN_TABLE_BUILDER_H_
@@ -0,0 +1,53 @@
+#ifndef STORAGE_LEVELDB_INCLUDE_SLICE_TRANSFORM_H_
+#define STORAGE_LEVELDB_INCLUDE_SLICE_TRANSFORM_H_
+
+#include <stddef.h>
+#include "include/leveldb/export.h"
+#include "include/leveldb/slice.h"
+
+namespace leveldb {
+
+// A SliceTransform maps a key to a prefix of it.  Installed as
+// Options::prefix_extractor, the prefix of every key is added to the
+// table's filter next to the key itself, so that a scan over all keys
+// with a given prefix can skip the tables and blocks that hold none.
+//
+// Keys that share a prefix must be adjacent in comparator order.
+class LEVELDB_EXPORT SliceTransform {
+public:
+	virtual ~SliceTransform();
+
+	// The name of the transform.  It is stored in every table built with
+	// it, and prefix filtering is only used on tables whose stored name
+	// equals the name of the transform they are read with.  Change the
+	// name whenever the transform changes.
+	virtual const char* Name() const = 0;
+
+	// Return the prefix of "key".  The result points into "key".
+	// REQUIRES: InDomain(key)
+	virtual Slice Transform(const Slice& key) const = 0;
+
+	// Return true if "key" has a prefix.  Keys outside the domain do not
+	// add a prefix to the filter.
+	virtual bool InDomain(const Slice& key) const = 0;
+};
+
+// Return a new transform whose prefix is the first prefix_len bytes of
+// a key.  Shorter keys are outside its domain.
+//
+// Callers must delete the result after any table that is using the
+// result has been closed.
+LEVELDB_EXPORT const SliceTransform* NewFixedPrefixTransform(size_t prefix_len);
+
+// Return a new transform whose prefix runs up to and including the
+// count-th occurrence of "delimiter".  With delimiter '|' and count 2 the
+// key "tenant|entity|ts" has the prefix "tenant|entity|".  Keys with
+// fewer delimiters are outside its domain.
+//
+// Callers must delete the result after any table that is using the
+// result has been closed.
+LEVELDB_EXPORT const SliceTransform* NewDelimitedPrefixTransform(char delimiter, int count);
+
+}  // namespace leveldb
+
+#endif  // STORAGE_LEVELDB_INCLUDE_SLICE_TRANSFORM_H_
@@ -2,13 +2,18 @@
 #define STORAGE_LEVELDB_INCLUDE_TABLE_H_
 
 #include <stdint.h>
+#include <string>
+#include "include/leveldb/cache.h"
 #include "include/leveldb/export.h"
 #include "include/leveldb/iterator.h"
+#include "include/leveldb/table_properties.h"
 
 namespace leveldb {
 
 class Block;
 class BlockHandle;
+struct BlockContents;
+class FilePrefetchBuffer;
 class Footer;
 struct Options;
 class RandomAccessFile;
@@ -19,23 +24,107 @@ class LEVELDB_EXPORT Table {
 public:
 	static Status Open(const Options& options, RandomAccessFile* file, uint64_t file_size, Table** table);
 	~Table();
+
+	// Returns a new iterator over the table contents.  The result of
+	// NewIterator() is initially invalid (caller must call one of the
+	// Seek methods on the iterator before using it).  With
+	// ReadOptions::prefix_seek, a Seek() only yields the keys that share
+	// the prefix of its target (see Options::prefix_extractor).
 	Iterator* NewIterator(const ReadOptions&) const;
+
 	uint64_t ApproximateOffsetOf(const Slice& key) const;
 
+	// Statistics about the table's contents, read from its properties
+	// block when the table was opened.  Needs no data block I/O.
+	const TableProperties& properties() const;
+
+	// Returns false if the table's whole-table filter shows that no key
+	// of the table starts with "prefix", as extracted by
+	// Options::prefix_extractor.  Returns true if the table may hold such
+	// keys, or has no such filter.  Needs no I/O.
+	bool PrefixMayMatch(const Slice& prefix) const;
+
+	// Returns false if the table's range filter shows that no key k of
+	// the table (no user key, for tables keyed by internal keys) satisfies
+	// start <= k < limit.  Returns true if such a key may exist, or if the
+	// table was built without Options::range_filter.  Needs no I/O.
+	bool RangeMayMatch(const Slice& start, const Slice& limit) const;
+
+	// Look up a batch of keys.  keys[0,n-1] need not be sorted.  Keys that
+	// the filter rules out are skipped; for every other key the first entry
+	// at or after it in its data block, if any, is passed to
+	// (*handle_result)(arg, i, found_key, found_value) where i is the
+	// position of the key in keys[].  Keys that land in the same data block
+	// share one block read, and the reads of physically adjacent blocks are
+	// merged into a single larger read.
+	Status MultiGet(const ReadOptions& options, const Slice* keys, int n, void* arg,
+		void (*handle_result)(void* arg, int index, const Slice& k, const Slice& v));
+
 private:
 	struct Rep;
 	Rep* rep_;
 	explicit Table(Rep* rep) { rep_ = rep; }
-	static Iterator* BlockReader(void*, const ReadOptions& const Slice&);
+	static Iterator* BlockReader(void*, const ReadOptions&, const Slice&);
+
+	class PrefixIterator;
+	class BlobValueIterator;
+
+	// BlockReader() for an iterator in prefix mode: "arg" is a
+	// PrefixIterator.  Skips blocks whose filter rules the prefix out.
+	static Iterator* PrefixBlockReader(void*, const ReadOptions&, const Slice&);
 
 	friend class TableCache;
 
 	Status InternalGet(const ReadOptions&, const Slice& key, void* arg,
 		void (*handle_result)(void* arg, const Slice& k, const Slice& v));
 
-	void ReadMeta(const Footer& footer);
+	void ReadMeta(const Footer& footer, const FilePrefetchBuffer* prefetch);
+
+	void ReadFilter(const Slice& filter_handle_value, bool whole_table,
+		const FilePrefetchBuffer* prefetch);
+
+	void ReadProperties(const Slice& properties_handle_value, const FilePrefetchBuffer* prefetch);
+
+	void ReadRangeFilter(const Slice& filter_handle_value, const FilePrefetchBuffer* prefetch);
+
+	// Hand the index block and filters over to the block cache
+	// (Options::cache_index_and_filter_blocks).
+	void CacheMeta();
+
+	enum MetaKind { kIndexMeta, kFilterMeta, kRangeFilterMeta };
+
+	// The index block, filter or range filter of the table while in use.
+	struct MetaRef {
+		void* object;            // NULL for a filter the table lacks
+		Cache::Handle* handle;   // Pins object in the block cache, or NULL
+		// Frees an object read for this use alone, or NULL
+		void (*deleter)(const Slice& key, void* value);
+	};
+
+	// Set *ref to the block of the given kind, reading it back into the
+	// block cache if it was evicted from there.  Release with ReleaseMeta().
+	Status AcquireMeta(MetaKind kind, MetaRef* ref) const;
+	void ReleaseMeta(const MetaRef& ref) const;
+
+	// Returns an iterator over the index block that keeps it pinned.
+	Iterator* NewIndexIterator() const;
+
+	// Read the block at "handle" from Options::persistent_cache if it is
+	// there, else from the file, storing it in the persistent cache.
+	Status FetchBlock(const ReadOptions& options, const BlockHandle& handle,
+		BlockContents* contents) const;
+
+	// The halves of FetchBlock(): look the block at "handle" up in the
+	// persistent cache, returning true on a hit, and store a block read
+	// from the file there.
+	bool ReadPersistentBlock(const BlockHandle& handle, BlockContents* contents) const;
+	void FillPersistentCache(const BlockHandle& handle, const BlockContents& contents) const;
 
-	void ReadFilter(const Slice& filter_handle_value);
+	// Set *value to the value that "stored" represents: "stored" itself, or
+	// for tables with separated values the inline value or the blob it
+	// references, which is read into *blob.
+	Status ResolveValue(const ReadOptions& options, const Slice& stored,
+		std::string* blob, Slice* value) const;
 
 	// No copying allowed
 	Table(const Table&);
@@ -9,6 +9,7 @@
 namespace leveldb 
 {
 
+class BlobFileBuilder;
 class BlockBuilder;
 class WritableFile;
 class BlockHandle;
@@ -21,6 +22,12 @@ public:
 	// caller to close the file after calling Finish().
 	TableBuilder(const Options& options, WritableFile* file);
 
+	// Like the constructor above, but values of at least
+	// options.min_blob_size bytes are appended to *blob_file and the
+	// table stores references to them.  Does not finish or close the blob
+	// file; the caller should do so after calling Finish().
+	TableBuilder(const Options& options, WritableFile* file, BlobFileBuilder* blob_file);
+
 	// REQUIRES: Either Finish() or Abandon() has been called.
 	~TableBuilder();
 
@@ -0,0 +1,71 @@
+#ifndef STORAGE_LEVELDB_INCLUDE_TABLE_PROPERTIES_H_
+#define STORAGE_LEVELDB_INCLUDE_TABLE_PROPERTIES_H_
+
+#include <stdint.h>
+#include <string>
+#include "include/leveldb/export.h"
+
+namespace leveldb {
+
+// Summary statistics of a table, computed by TableBuilder and stored in
+// the table's properties block so that readers can learn them without
+// touching any data block.  Tables written without a properties block
+// report all fields as zero/empty.
+struct LEVELDB_EXPORT TableProperties {
+	// Number of entries added to the table.
+	uint64_t num_entries;
+
+	// Number of entries that are deletion markers.  Only counted when the
+	// table is keyed by internal keys (see db/dbformat.h).
+	uint64_t num_deletions;
+
+	// Total size of all keys and of all values as passed to Add().
+	uint64_t raw_key_size;
+	uint64_t raw_value_size;
+
+	// Number of data blocks and their total on-disk size, trailers included.
+	uint64_t num_data_blocks;
+	uint64_t data_size;
+
+	// Size of the index block and of the filter block, trailers excluded.
+	uint64_t index_size;
+	uint64_t filter_size;
+
+	// Size of the range filter block, trailer excluded.
+	uint64_t range_filter_size;
+
+	// True if every value in the table starts with a tag telling whether
+	// it is stored inline or in a blob file (see include/leveldb/blob_file.h).
+	bool separated_values;
+
+	// Number of values moved to blob files and their total size.
+	uint64_t num_blob_references;
+	uint64_t blob_size;
+
+	// First and last key added to the table.
+	std::string smallest_key;
+	std::string largest_key;
+
+	// Name of the prefix extractor whose prefixes were added to the
+	// table's filter, or empty if none were.
+	std::string prefix_extractor_name;
+
+	TableProperties()
+		: num_entries(0),
+		  num_deletions(0),
+		  raw_key_size(0),
+		  raw_value_size(0),
+		  num_data_blocks(0),
+		  data_size(0),
+		  index_size(0),
+		  filter_size(0),
+		  range_filter_size(0),
+		  separated_values(false),
+		  num_blob_references(0),
+		  blob_size(0) {
+	}
+};
+
+}  // namespace leveldb
+
+#endif  // STORAGE_LEVELDB_INCLUDE_TABLE_PROPERTIES_H_
@@ -9,6 +9,50 @@ int main()
 
 	MemTableTest();
 
+	//TableMultiGetTest();
+
+	//TableOpenTest();
+
+	//TableCompressionTest();
+
+	//PlainTableTest();
+
+	//CuckooTableTest();
+
+	//BlobFileTest();
+
+	//ParallelTableWriterTest();
+
+	//BufferedWritableFileTest();
+
+	//BloomFilterTest();
+
+	//BinaryFuseFilterTest();
+
+	//PrefixSeekTest();
+
+	//RangeFilterTest();
+
+	//FilterBuildTest();
+
+	//CacheTest();
+
+	//ClockCacheTest();
+
+	//CachePriorityTest();
+
+	//TinyLFUTest();
+
+	//CompressedCacheTest();
+
+	//PersistentCacheTest();
+
+	//TableCacheTest();
+
+	//CacheStatisticsTest();
+
+	//EnvPosixTest();
+
 	system("pause");
 	return 0;
 }
\ No newline at end of file
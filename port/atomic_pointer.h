@@ -47,6 +47,61 @@ public:
 	}
 };
 
+// A 64-bit integer shared between threads.  Load() has acquire and
+// Store() release semantics; the read-modify-write operations are full
+// memory barriers.
+class AtomicUint64
+{
+private:
+	volatile uint64_t rep_;
+public:
+	AtomicUint64() : rep_(0) {}
+
+	explicit AtomicUint64(uint64_t v) : rep_(v) {}
+
+	uint64_t Load() const
+	{
+		uint64_t result = rep_;
+		MemoryBarrier();
+		return result;
+	}
+
+	void Store(uint64_t v)
+	{
+		MemoryBarrier();
+		rep_ = v;
+	}
+
+	// If the value is "expected", replace it with "desired" and return
+	// true; otherwise leave it alone and return false.
+	bool CompareAndSwap(uint64_t expected, uint64_t desired)
+	{
+#if defined(_MSC_VER)
+		return static_cast<uint64_t>(InterlockedCompareExchange64(
+			reinterpret_cast<volatile LONGLONG*>(&rep_),
+			static_cast<LONGLONG>(desired), static_cast<LONGLONG>(expected))) == expected;
+#else
+		return __sync_bool_compare_and_swap(&rep_, expected, desired);
+#endif
+	}
+
+	// Add "delta" and return the previous value.
+	uint64_t FetchAdd(uint64_t delta)
+	{
+#if defined(_MSC_VER)
+		return static_cast<uint64_t>(InterlockedExchangeAdd64(
+			reinterpret_cast<volatile LONGLONG*>(&rep_), static_cast<LONGLONG>(delta)));
+#else
+		return __sync_fetch_and_add(&rep_, delta);
+#endif
+	}
+
+private:
+	// No copying allowed
+	AtomicUint64(const AtomicUint64&);
+	void operator=(const AtomicUint64&);
+};
+
 #else
 #error Please implement AtomicPointer for this platform
 #endif
@@ -1,11 +1,78 @@
 #ifndef STORAGE_LEVELDB_PORT_PORT_POSIX_H_
 #define STORAGE_LEVELDB_PORT_PORT_POSIX_H_
 
+#include <pthread.h>
+#include <stddef.h>
+#include <string>
 #include "port/atomic_pointer.h"
 
 namespace leveldb{
 namespace port {
 
+class CondVar;
+
+class Mutex {
+public:
+	Mutex();
+	~Mutex();
+
+	void Lock();
+	void Unlock();
+	void AssertHeld() { }
+
+private:
+	friend class CondVar;
+	pthread_mutex_t mu_;
+
+	// No copying
+	Mutex(const Mutex&);
+	void operator=(const Mutex&);
+};
+
+class CondVar {
+public:
+	explicit CondVar(Mutex* mu);
+	~CondVar();
+	void Wait();
+	void Signal();
+	void SignalAll();
+
+private:
+	pthread_cond_t cv_;
+	Mutex* mu_;
+};
+
+typedef pthread_once_t OnceType;
+#define LEVELDB_ONCE_INIT PTHREAD_ONCE_INIT
+extern void InitOnce(OnceType* once, void (*initializer)());
+
+// Hint that the cache line holding "addr" is about to be read.
+inline void Prefetch(const void* addr) {
+	__builtin_prefetch(addr);
+}
+
+// Returns the number of the CPU the calling thread runs on, or -1 if
+// the platform cannot tell.
+extern int CurrentCpu();
+
+// Store the Snappy compression of "input[0,input_length-1]" in *output.
+// Returns false if Snappy is not supported by this port.
+extern bool Snappy_Compress(const char* input, size_t input_length, std::string* output);
+
+// If input[0,input_length-1] looks like a valid Snappy compressed buffer,
+// store the size of the uncompressed data in *result and return true.
+// Else return false.
+extern bool Snappy_GetUncompressedLength(const char* input, size_t input_length, size_t* result);
+
+// Attempt to Snappy uncompress input[0,input_length-1] into *output.
+// Returns true if successful, false if the input is invalid Snappy
+// compressed data.
+//
+// REQUIRES: at least the first "n" bytes of output[] must be writable
+// where "n" is the result of a successful call to
+// Snappy_GetUncompressedLength.
+extern bool Snappy_Uncompress(const char* input_data, size_t input_length, char* output);
+
 }
 
 }
@@ -7,13 +7,43 @@
 namespace leveldb {
 namespace port {
 
+Mutex::Mutex() { InitializeCriticalSection(&cs_); }
 
+Mutex::~Mutex() { DeleteCriticalSection(&cs_); }
+
+void Mutex::Lock() { EnterCriticalSection(&cs_); }
+
+void Mutex::Unlock() { LeaveCriticalSection(&cs_); }
+
+CondVar::CondVar(Mutex* mu)
+	: mu_(mu) {
+	InitializeConditionVariable(&cv_);
+}
+
+CondVar::~CondVar() { }
+
+void CondVar::Wait() {
+	SleepConditionVariableCS(&cv_, &mu_->cs_, INFINITE);
+}
+
+void CondVar::Signal() {
+	WakeConditionVariable(&cv_);
+}
+
+void CondVar::SignalAll() {
+	WakeAllConditionVariable(&cv_);
+}
 
 void InitOnce(OnceType* once, void (*initializer)()) 
 {
 	initializer();
 }
 
+int CurrentCpu()
+{
+	return static_cast<int>(GetCurrentProcessorNumber());
+}
+
 
 }
 }
\ No newline at end of file
@@ -0,0 +1,243 @@
+#include "port/port.h"
+
+#include <string.h>
+
+// A self-contained implementation of the Snappy block format, so that no
+// port needs the snappy library.  A compressed buffer is the varint32
+// length of the uncompressed data followed by a sequence of elements,
+// each starting with a tag byte whose two low bits give its kind:
+//
+//    00  literal: the length minus one is in the upper six bits, or, if
+//        those hold 60..63, in the 1..4 little-endian bytes that follow;
+//        the literal bytes come next
+//    01  copy of 4..11 bytes with an 11-bit offset: length - 4 in bits
+//        2..4, the offset's high bits in bits 5..7, its low byte next
+//    10  copy of 1..64 bytes with a 16-bit little-endian offset
+//    11  copy of 1..64 bytes with a 32-bit little-endian offset
+//
+// A copy repeats bytes that were produced "offset" bytes earlier and may
+// overlap the bytes it produces.  The compressor works on fragments of
+// 64K, so it never needs the 32-bit form.
+
+namespace leveldb {
+namespace port {
+
+namespace {
+
+static const size_t kFragmentSize = 1 << 16;
+static const int kHashBits = 14;
+
+inline uint32_t Load32(const char* p) {
+	uint32_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+inline uint32_t HashBytes(uint32_t bytes) {
+	return (bytes * 0x1e35a7bd) >> (32 - kHashBits);
+}
+
+void AppendVarint32(std::string* dst, uint32_t v) {
+	while (v >= 128) {
+		dst->push_back(static_cast<char>(v | 128));
+		v >>= 7;
+	}
+	dst->push_back(static_cast<char>(v));
+}
+
+void EmitLiteral(std::string* dst, const char* literal, size_t len) {
+	const size_t n = len - 1;
+	if (n < 60) {
+		dst->push_back(static_cast<char>(n << 2));
+	} else {
+		char buf[4];
+		int count = 0;
+		for (size_t v = n; v > 0; v >>= 8) {
+			buf[count++] = static_cast<char>(v & 0xff);
+		}
+		dst->push_back(static_cast<char>((59 + count) << 2));
+		dst->append(buf, count);
+	}
+	dst->append(literal, len);
+}
+
+void EmitCopyAtMost64(std::string* dst, size_t offset, size_t len) {
+	if (len < 12 && offset < 2048) {
+		dst->push_back(static_cast<char>(1 | ((len - 4) << 2) | ((offset >> 8) << 5)));
+		dst->push_back(static_cast<char>(offset & 0xff));
+	} else {
+		dst->push_back(static_cast<char>(2 | ((len - 1) << 2)));
+		dst->push_back(static_cast<char>(offset & 0xff));
+		dst->push_back(static_cast<char>(offset >> 8));
+	}
+}
+
+void EmitCopy(std::string* dst, size_t offset, size_t len) {
+	// Keep the last piece at least 4 bytes long, so that it can use the
+	// short form
+	while (len >= 68) {
+		EmitCopyAtMost64(dst, offset, 64);
+		len -= 64;
+	}
+	if (len > 64) {
+		EmitCopyAtMost64(dst, offset, 60);
+		len -= 60;
+	}
+	EmitCopyAtMost64(dst, offset, len);
+}
+
+// Compress input[0,n-1], n <= kFragmentSize, onto *dst.  Matches are
+// found with a hash table of the positions of 4-byte sequences; the
+// search skips ahead faster the longer it goes without a match, which
+// keeps incompressible data cheap.
+void CompressFragment(const char* input, size_t n, uint16_t* table, std::string* dst) {
+	const char* ip = input;
+	const char* end = input + n;
+	const char* next_emit = input;
+	if (n >= 15) {
+		memset(table, 0, sizeof(uint16_t) << kHashBits);
+		const char* ip_limit = end - 4;
+		ip++;
+		uint32_t skip = 32;
+		while (ip < ip_limit) {
+			const uint32_t bytes = Load32(ip);
+			const uint32_t h = HashBytes(bytes);
+			const char* candidate = input + table[h];
+			table[h] = static_cast<uint16_t>(ip - input);
+			if (candidate >= ip || Load32(candidate) != bytes) {
+				ip += skip >> 5;
+				skip++;
+				continue;
+			}
+			skip = 32;
+			if (ip > next_emit) {
+				EmitLiteral(dst, next_emit, ip - next_emit);
+			}
+			size_t len = 4;
+			while (ip + len < end && candidate[len] == ip[len]) {
+				len++;
+			}
+			EmitCopy(dst, ip - candidate, len);
+			ip += len;
+			next_emit = ip;
+			if (ip < ip_limit) {
+				table[HashBytes(Load32(ip - 1))] = static_cast<uint16_t>(ip - 1 - input);
+			}
+		}
+	}
+	if (next_emit < end) {
+		EmitLiteral(dst, next_emit, end - next_emit);
+	}
+}
+
+// Parse the varint32 length header of a compressed buffer.
+const char* ParseLength(const char* p, const char* limit, uint32_t* length) {
+	uint32_t result = 0;
+	for (uint32_t shift = 0; shift <= 28 && p < limit; shift += 7) {
+		const uint32_t byte = static_cast<unsigned char>(*p++);
+		result |= (byte & 127) << shift;
+		if (byte < 128) {
+			*length = result;
+			return p;
+		}
+	}
+	return NULL;
+}
+
+}  // namespace
+
+bool Snappy_Compress(const char* input, size_t input_length, std::string* output) {
+	output->clear();
+	if (input_length > 0xffffffffu) {
+		return false;
+	}
+	output->reserve(32 + input_length + input_length / 6);
+	AppendVarint32(output, static_cast<uint32_t>(input_length));
+	uint16_t* table = new uint16_t[1 << kHashBits];
+	for (size_t pos = 0; pos < input_length; pos += kFragmentSize) {
+		const size_t n = (input_length - pos < kFragmentSize ? input_length - pos : kFragmentSize);
+		CompressFragment(input + pos, n, table, output);
+	}
+	delete[] table;
+	return true;
+}
+
+bool Snappy_GetUncompressedLength(const char* input, size_t input_length, size_t* result) {
+	uint32_t length;
+	if (ParseLength(input, input + input_length, &length) == NULL) {
+		return false;
+	}
+	*result = length;
+	return true;
+}
+
+bool Snappy_Uncompress(const char* input_data, size_t input_length, char* output) {
+	const char* limit = input_data + input_length;
+	uint32_t length;
+	const char* p = ParseLength(input_data, limit, &length);
+	if (p == NULL) {
+		return false;
+	}
+	char* op = output;
+	char* const op_limit = output + length;
+	while (p < limit) {
+		const uint32_t tag = static_cast<unsigned char>(*p++);
+		if ((tag & 3) == 0) {
+			size_t len = (tag >> 2) + 1;
+			if (len > 60) {
+				const size_t count = len - 60;
+				if (static_cast<size_t>(limit - p) < count) {
+					return false;
+				}
+				len = 0;
+				for (size_t i = 0; i < count; i++) {
+					len |= static_cast<size_t>(static_cast<unsigned char>(p[i])) << (8 * i);
+				}
+				len++;
+				p += count;
+			}
+			if (static_cast<size_t>(limit - p) < len || static_cast<size_t>(op_limit - op) < len) {
+				return false;
+			}
+			memcpy(op, p, len);
+			p += len;
+			op += len;
+			continue;
+		}
+
+		size_t len;
+		size_t offset;
+		if ((tag & 3) == 1) {
+			if (p >= limit) return false;
+			len = ((tag >> 2) & 7) + 4;
+			offset = ((tag >> 5) << 8) | static_cast<unsigned char>(*p++);
+		} else if ((tag & 3) == 2) {
+			if (limit - p < 2) return false;
+			len = (tag >> 2) + 1;
+			offset = static_cast<unsigned char>(p[0]) |
+				(static_cast<size_t>(static_cast<unsigned char>(p[1])) << 8);
+			p += 2;
+		} else {
+			if (limit - p < 4) return false;
+			len = (tag >> 2) + 1;
+			offset = 0;
+			for (int i = 0; i < 4; i++) {
+				offset |= static_cast<size_t>(static_cast<unsigned char>(p[i])) << (8 * i);
+			}
+			p += 4;
+		}
+		if (offset == 0 || offset > static_cast<size_t>(op - output) ||
+			static_cast<size_t>(op_limit - op) < len) {
+			return false;
+		}
+		const char* src = op - offset;
+		for (size_t i = 0; i < len; i++) {
+			op[i] = src[i];
+		}
+		op += len;
+	}
+	return op == op_limit;
+}
+
+}  // namespace port
+}  // namespace leveldb
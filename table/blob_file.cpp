@@ -0,0 +1,202 @@
+#include "include/leveldb/blob_file.h"
+
+#include <assert.h>
+#include "include/leveldb/cache.h"
+#include "include/leveldb/env.h"
+#include "table/blob_file_format.h"
+#include "table/format.h"
+#include "util/coding.h"
+#include "util/crc32c.h"
+
+namespace leveldb {
+
+void EncodeBlobReference(uint64_t file_number, const BlockHandle& handle,
+	std::string* dst)
+{
+	dst->push_back(static_cast<char>(kBlobReference));
+	PutVarint64(dst, file_number);
+	handle.EncodeTo(dst);
+}
+
+Status DecodeBlobReference(Slice* input, uint64_t* file_number, BlockHandle* handle)
+{
+	if (input->empty() || (*input)[0] != static_cast<char>(kBlobReference)) {
+		return Status::Corruption("not a blob reference");
+	}
+	input->remove_prefix(1);
+	if (!GetVarint64(input, file_number)) {
+		return Status::Corruption("bad blob reference");
+	}
+	return handle->DecodeFrom(input);
+}
+
+BlobFileBuilder::BlobFileBuilder(const Options& options, WritableFile* file,
+	uint64_t file_number)
+	: file_(file),
+	  file_number_(file_number),
+	  offset_(0),
+	  num_blobs_(0),
+	  closed_(false)
+{
+}
+
+BlobFileBuilder::~BlobFileBuilder()
+{
+	assert(closed_);
+}
+
+Status BlobFileBuilder::Add(const Slice& value, BlockHandle* handle)
+{
+	assert(!closed_);
+	if (!status_.ok()) return status_;
+
+	handle->set_offset(offset_);
+	handle->set_size(value.size());
+	status_ = file_->Append(value);
+	if (status_.ok()) {
+		char trailer[kBlockTrailerSize];
+		trailer[0] = kNoCompression;
+		uint32_t crc = crc32c::Value(value.data(), value.size());
+		crc = crc32c::Extend(crc, trailer, 1);
+		EncodeFixed32(trailer + 1, crc32c::Mask(crc));
+		status_ = file_->Append(Slice(trailer, kBlockTrailerSize));
+		if (status_.ok()) {
+			offset_ += value.size() + kBlockTrailerSize;
+			num_blobs_++;
+		}
+	}
+	return status_;
+}
+
+Status BlobFileBuilder::Finish()
+{
+	assert(!closed_);
+	closed_ = true;
+	if (!status_.ok()) return status_;
+
+	std::string footer;
+	PutFixed64(&footer, num_blobs_);
+	PutFixed64(&footer, kBlobFileMagicNumber);
+	status_ = file_->Append(footer);
+	if (status_.ok()) {
+		offset_ += footer.size();
+	}
+	return status_;
+}
+
+void BlobFileBuilder::Abandon()
+{
+	assert(!closed_);
+	closed_ = true;
+}
+
+BlobFileReader::BlobFileReader(const Options& options, RandomAccessFile* file,
+	uint64_t file_number, uint64_t num_blobs)
+	: options_(options),
+	  file_(file),
+	  file_number_(file_number),
+	  num_blobs_(num_blobs),
+	  cache_id_(options.blob_cache != NULL ? options.blob_cache->NewId() : 0)
+{
+}
+
+BlobFileReader::~BlobFileReader()
+{
+}
+
+Status BlobFileReader::Open(const Options& options, RandomAccessFile* file,
+	uint64_t file_number, uint64_t size, BlobFileReader** reader)
+{
+	*reader = NULL;
+	if (size < kBlobFileFooterLength) {
+		return Status::Corruption("file is too short to be a blob file");
+	}
+
+	char footer_space[kBlobFileFooterLength];
+	Slice footer;
+	Status s = file->Read(size - kBlobFileFooterLength, kBlobFileFooterLength,
+		&footer, footer_space);
+	if (!s.ok()) return s;
+	if (footer.size() != kBlobFileFooterLength ||
+		DecodeFixed64(footer.data() + 8) != kBlobFileMagicNumber) {
+		return Status::Corruption("not a blob file (bad magic number)");
+	}
+
+	*reader = new BlobFileReader(options, file, file_number, DecodeFixed64(footer.data()));
+	return s;
+}
+
+static void DeleteCachedBlob(const Slice& key, void* value) {
+	delete reinterpret_cast<std::string*>(value);
+}
+
+Status BlobFileReader::Get(const ReadOptions& options, const BlockHandle& handle,
+	std::string* value) const
+{
+	Cache* blob_cache = options_.blob_cache;
+	char cache_key_buffer[16];
+	Slice key(cache_key_buffer, sizeof(cache_key_buffer));
+	if (blob_cache != NULL) {
+		EncodeFixed64(cache_key_buffer, cache_id_);
+		EncodeFixed64(cache_key_buffer + 8, handle.offset());
+		Cache::Handle* cache_handle = blob_cache->Lookup(key);
+		if (cache_handle != NULL) {
+			*value = *reinterpret_cast<std::string*>(blob_cache->Value(cache_handle));
+			blob_cache->Release(cache_handle);
+			return Status::OK();
+		}
+	}
+
+	BlockContents contents;
+	Status s = ReadBlock(file_, options, handle, &contents);
+	if (!s.ok()) return s;
+	value->assign(contents.data.data(), contents.data.size());
+	if (contents.heap_allocated) {
+		delete[] contents.data.data();
+	}
+
+	if (blob_cache != NULL && contents.cachable && options.fill_cache) {
+		std::string* cached = new std::string(*value);
+		Cache::Handle* cache_handle = blob_cache->Insert(key, cached, cached->size(),
+			&DeleteCachedBlob);
+		if (cache_handle != NULL) {
+			blob_cache->Release(cache_handle);
+		} else {
+			delete cached;
+		}
+	}
+	return s;
+}
+
+BlobFileSet::~BlobFileSet()
+{
+	for (ReaderMap::iterator it = readers_.begin(); it != readers_.end(); ++it) {
+		delete it->second;
+	}
+}
+
+void BlobFileSet::Add(BlobFileReader* reader)
+{
+	BlobFileReader*& slot = readers_[reader->file_number()];
+	if (slot != reader) {
+		delete slot;
+		slot = reader;
+	}
+}
+
+void BlobFileSet::Remove(uint64_t file_number)
+{
+	ReaderMap::iterator it = readers_.find(file_number);
+	if (it != readers_.end()) {
+		delete it->second;
+		readers_.erase(it);
+	}
+}
+
+BlobFileReader* BlobFileSet::Find(uint64_t file_number) const
+{
+	ReaderMap::const_iterator it = readers_.find(file_number);
+	return (it == readers_.end() ? NULL : it->second);
+}
+
+}  // namespace leveldb
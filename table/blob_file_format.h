@@ -0,0 +1,47 @@
+#ifndef STORAGE_LEVELDB_TABLE_BLOB_FILE_FORMAT_H_
+#define STORAGE_LEVELDB_TABLE_BLOB_FILE_FORMAT_H_
+
+#include <stdint.h>
+#include <string>
+#include "include/leveldb/slice.h"
+#include "include/leveldb/status.h"
+
+namespace leveldb {
+
+class BlockHandle;
+
+// A blob file looks like:
+//
+//    [blob 1]            raw value followed by a block trailer
+//    ...                 (1-byte type + 32-bit crc, see table/format.h)
+//    [blob N]
+//    [footer]            fixed64 number of blobs, fixed64 magic
+//
+// Blobs are read with ReadBlock(), so they are checksummed like blocks.
+
+static const uint64_t kBlobFileMagicNumber = 0x3ab0c5f2e71d6b94ull;
+
+static const size_t kBlobFileFooterLength = 8 + 8;
+
+// In a table built with a blob file every value starts with one of these
+// tags.  An inline value follows its tag directly; a blob reference is
+// followed by the varint64 number of the blob file and the BlockHandle
+// of the blob in that file.
+enum ValueTag {
+	kInlineValue = 0x0,
+	kBlobReference = 0x1
+};
+
+// Append the tag and encoding of a reference to the blob at "handle" in
+// blob file "file_number" to *dst.
+extern void EncodeBlobReference(uint64_t file_number, const BlockHandle& handle,
+	std::string* dst);
+
+// Parse a blob reference with its tag from the start of *input and
+// advance *input past it.
+extern Status DecodeBlobReference(Slice* input, uint64_t* file_number,
+	BlockHandle* handle);
+
+}  // namespace leveldb
+
+#endif  // STORAGE_LEVELDB_TABLE_BLOB_FILE_FORMAT_H_
@@ -15,9 +15,10 @@ class Block
 public:
 	explicit Block(const struct BlockContents& contents);
 
-	~Block(void) { if (owned_) delete[] data_;}
+	virtual ~Block(void) { if (owned_) delete[] data_;}
 
 	size_t size() const { return size_; }
+	const char* data() const { return data_; }
 
 	Iterator* NewIterator(const Comparator* comparator);
 private:
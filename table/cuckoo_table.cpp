@@ -0,0 +1,111 @@
+#include "include/leveldb/cuckoo_table.h"
+
+#include "include/leveldb/env.h"
+#include "include/leveldb/options.h"
+#include "table/cuckoo_table_format.h"
+#include "util/coding.h"
+
+namespace leveldb {
+
+struct CuckooTable::Rep {
+	Options options;
+	RandomAccessFile* file;
+	CuckooTableFooter footer;
+	bool internal_keys;
+};
+
+Status CuckooTable::Open(const Options& options, RandomAccessFile* file,
+	uint64_t size, CuckooTable** table)
+{
+	*table = NULL;
+	if (size < CuckooTableFooter::kEncodedLength) {
+		return Status::Corruption("file is too short to be a cuckoo table");
+	}
+
+	char footer_space[CuckooTableFooter::kEncodedLength];
+	Slice footer_input;
+	Status s = file->Read(size - CuckooTableFooter::kEncodedLength,
+		CuckooTableFooter::kEncodedLength, &footer_input, footer_space);
+	if (!s.ok()) return s;
+
+	CuckooTableFooter footer;
+	s = footer.DecodeFrom(&footer_input);
+	if (!s.ok()) return s;
+	if (footer.num_buckets == 0 || footer.slots_per_bucket == 0 ||
+		footer.num_buckets * footer.bucket_size() +
+		CuckooTableFooter::kEncodedLength != size) {
+		return Status::Corruption("bad cuckoo table footer");
+	}
+
+	Rep* rep = new CuckooTable::Rep;
+	rep->options = options;
+	rep->file = file;
+	rep->footer = footer;
+	rep->internal_keys = (footer.flags & CuckooTableFooter::kInternalKeys) != 0;
+	*table = new CuckooTable(rep);
+	return s;
+}
+
+CuckooTable::~CuckooTable()
+{
+	delete rep_;
+}
+
+uint64_t CuckooTable::NumEntries() const
+{
+	return rep_->footer.num_entries;
+}
+
+Status CuckooTable::Get(const ReadOptions& options, const Slice& k, void* arg,
+	void (*saver)(void*, const Slice&, const Slice&)) const
+{
+	const Rep* r = rep_;
+	const CuckooTableFooter& footer = r->footer;
+	const Slice hash_key = CuckooTableHashKey(k, r->internal_keys);
+	uint64_t buckets[2];
+	CuckooTableBuckets(hash_key, footer.hash_seed, footer.num_buckets,
+		&buckets[0], &buckets[1]);
+
+	const size_t slot_size = footer.slot_size();
+	const size_t bucket_size = footer.bucket_size();
+	char* scratch = (r->file->ReturnsStablePointers() ? NULL : new char[bucket_size]);
+	Status s;
+	for (int b = 0; b < 2; b++) {
+		if (b == 1 && buckets[1] == buckets[0]) {
+			break;
+		}
+		Slice contents;
+		s = r->file->Read(buckets[b] * bucket_size, bucket_size, &contents, scratch);
+		if (!s.ok()) break;
+		if (contents.size() != bucket_size) {
+			s = Status::Corruption("truncated cuckoo table read");
+			break;
+		}
+
+		bool found = false;
+		for (uint32_t j = 0; j < footer.slots_per_bucket; j++) {
+			const char* p = contents.data() + j * slot_size;
+			const uint32_t key_size = DecodeFixed32(p);
+			if (key_size == kCuckooEmptySlot) {
+				continue;
+			}
+			const char* v = p + 4 + footer.max_key_length;
+			const uint32_t value_size = DecodeFixed32(v);
+			if (key_size > footer.max_key_length || value_size > footer.max_value_length) {
+				s = Status::Corruption("bad entry in cuckoo table");
+				break;
+			}
+			const Slice key(p + 4, key_size);
+			if (CuckooTableHashKey(key, r->internal_keys) == hash_key) {
+				(*saver)(arg, key, Slice(v + 4, value_size));
+				found = true;
+				break;
+			}
+		}
+		if (found || !s.ok()) break;
+	}
+	delete[] scratch;
+	return s;
+}
+
+}  // namespace leveldb
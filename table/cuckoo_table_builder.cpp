@@ -0,0 +1,231 @@
+#include "include/leveldb/cuckoo_table_builder.h"
+
+#include <assert.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include "include/leveldb/comparator.h"
+#include "include/leveldb/env.h"
+#include "table/cuckoo_table_format.h"
+#include "util/coding.h"
+#include "util/random.h"
+
+namespace leveldb {
+
+static const uint32_t kSlotsPerBucket = 4;
+
+// Fraction of the slots that the first placement attempt fills.
+static const double kMaxLoadFactor = 0.9;
+
+// Number of records that one insertion may move before the placement
+// is given up and retried with more buckets and a different hash seed.
+static const int kMaxDisplacements = 500;
+
+static const int kMaxPlacementAttempts = 16;
+
+struct CuckooTableBuilder::Rep {
+	struct Entry {
+		size_t offset;          // Key at data[offset], value right after it
+		uint32_t key_size;
+		uint32_t value_size;
+	};
+
+	Options options;
+	WritableFile* file;
+	uint64_t offset;
+	Status status;
+	std::string data;           // All keys and values added so far
+	std::vector<Entry> entries;
+	uint32_t max_key_length;
+	uint32_t max_value_length;
+	bool closed;                // Either Finish() or Abandon() has been called.
+	bool internal_keys;
+
+	Rep(const Options& opt, WritableFile* f)
+		: options(opt),
+		  file(f),
+		  offset(0),
+		  max_key_length(0),
+		  max_value_length(0),
+		  closed(false),
+		  internal_keys(strcmp(opt.comparator->Name(), "leveldb.InternalKeyComparator") == 0) {
+	}
+
+	Slice Key(size_t i) const {
+		return Slice(data.data() + entries[i].offset, entries[i].key_size);
+	}
+	Slice Value(size_t i) const {
+		return Slice(data.data() + entries[i].offset + entries[i].key_size,
+			entries[i].value_size);
+	}
+
+	// Try to give every entry a slot of a table with "num_buckets"
+	// buckets.  On success (*slots)[s] is the entry in slot s, or -1.
+	bool Place(uint64_t num_buckets, uint32_t seed, std::vector<int64_t>* slots) const;
+};
+
+bool CuckooTableBuilder::Rep::Place(uint64_t num_buckets, uint32_t seed,
+	std::vector<int64_t>* slots) const
+{
+	slots->assign(num_buckets * kSlotsPerBucket, -1);
+	Random rnd(seed);
+	for (size_t i = 0; i < entries.size(); i++) {
+		int64_t entry = static_cast<int64_t>(i);
+		bool placed = false;
+		for (int d = 0; d <= kMaxDisplacements && !placed; d++) {
+			uint64_t buckets[2];
+			CuckooTableBuckets(CuckooTableHashKey(Key(entry), internal_keys), seed,
+				num_buckets, &buckets[0], &buckets[1]);
+			for (int b = 0; b < 2 && !placed; b++) {
+				for (uint32_t j = 0; j < kSlotsPerBucket; j++) {
+					int64_t& slot = (*slots)[buckets[b] * kSlotsPerBucket + j];
+					if (slot < 0) {
+						slot = entry;
+						placed = true;
+						break;
+					}
+				}
+			}
+			if (!placed) {
+				// Both buckets are full: evict a random occupant and
+				// move it to its other bucket in the next round.
+				const uint64_t b = buckets[rnd.Uniform(2)];
+				std::swap(entry, (*slots)[b * kSlotsPerBucket + rnd.Uniform(kSlotsPerBucket)]);
+			}
+		}
+		if (!placed) {
+			return false;
+		}
+	}
+	return true;
+}
+
+CuckooTableBuilder::CuckooTableBuilder(const Options& options, WritableFile* file)
+	: rep_(new Rep(options, file))
+{
+}
+
+CuckooTableBuilder::~CuckooTableBuilder()
+{
+	assert(rep_->closed);
+	delete rep_;
+}
+
+void CuckooTableBuilder::Add(const Slice& key, const Slice& value)
+{
+	Rep* r = rep_;
+	assert(!r->closed);
+	if (!ok()) return;
+	if (!r->entries.empty()) {
+		const Slice last_key = r->Key(r->entries.size() - 1);
+		assert(r->options.comparator->Compare(key, last_key) > 0);
+		if (CuckooTableHashKey(key, r->internal_keys) ==
+			CuckooTableHashKey(last_key, r->internal_keys)) {
+			r->status = Status::InvalidArgument("cuckoo table needs distinct user keys");
+			return;
+		}
+	}
+
+	Rep::Entry e;
+	e.offset = r->data.size();
+	e.key_size = static_cast<uint32_t>(key.size());
+	e.value_size = static_cast<uint32_t>(value.size());
+	r->data.append(key.data(), key.size());
+	r->data.append(value.data(), value.size());
+	r->entries.push_back(e);
+	if (e.key_size > r->max_key_length) r->max_key_length = e.key_size;
+	if (e.value_size > r->max_value_length) r->max_value_length = e.value_size;
+}
+
+Status CuckooTableBuilder::status() const
+{
+	return rep_->status;
+}
+
+Status CuckooTableBuilder::Finish()
+{
+	Rep* r = rep_;
+	assert(!r->closed);
+	r->closed = true;
+	if (!ok()) return r->status;
+
+	uint64_t num_buckets = static_cast<uint64_t>(
+		r->entries.size() / (kSlotsPerBucket * kMaxLoadFactor)) + 1;
+	uint32_t seed = 0xbc9f1d34;
+	std::vector<int64_t> slots;
+	bool placed = false;
+	for (int attempt = 0; attempt < kMaxPlacementAttempts && !placed; attempt++) {
+		placed = r->Place(num_buckets, seed, &slots);
+		if (!placed) {
+			num_buckets += num_buckets / 10 + 1;
+			seed = seed * 0x01000193 + attempt;
+		}
+	}
+	if (!placed) {
+		r->status = Status::InvalidArgument("cannot place keys in cuckoo table");
+		return r->status;
+	}
+
+	CuckooTableFooter footer;
+	footer.num_buckets = num_buckets;
+	footer.num_entries = r->entries.size();
+	footer.slots_per_bucket = kSlotsPerBucket;
+	footer.max_key_length = r->max_key_length;
+	footer.max_value_length = r->max_value_length;
+	footer.hash_seed = seed;
+	footer.flags = (r->internal_keys ? CuckooTableFooter::kInternalKeys : 0);
+
+	// Write the table one bucket at a time
+	const size_t slot_size = footer.slot_size();
+	std::string bucket;
+	for (uint64_t b = 0; b < num_buckets && ok(); b++) {
+		bucket.assign(footer.bucket_size(), '\0');
+		for (uint32_t j = 0; j < kSlotsPerBucket; j++) {
+			char* p = &bucket[j * slot_size];
+			const int64_t entry = slots[b * kSlotsPerBucket + j];
+			if (entry < 0) {
+				EncodeFixed32(p, kCuckooEmptySlot);
+				continue;
+			}
+			const Slice key = r->Key(entry);
+			const Slice value = r->Value(entry);
+			EncodeFixed32(p, static_cast<uint32_t>(key.size()));
+			memcpy(p + 4, key.data(), key.size());
+			p += 4 + r->max_key_length;
+			EncodeFixed32(p, static_cast<uint32_t>(value.size()));
+			memcpy(p + 4, value.data(), value.size());
+		}
+		r->status = r->file->Append(bucket);
+		if (ok()) {
+			r->offset += bucket.size();
+		}
+	}
+
+	if (ok()) {
+		std::string footer_encoding;
+		footer.EncodeTo(&footer_encoding);
+		r->status = r->file->Append(footer_encoding);
+		if (ok()) {
+			r->offset += footer_encoding.size();
+		}
+	}
+	return r->status;
+}
+
+void CuckooTableBuilder::Abandon()
+{
+	assert(!rep_->closed);
+	rep_->closed = true;
+}
+
+uint64_t CuckooTableBuilder::NumEntries() const
+{
+	return rep_->entries.size();
+}
+
+uint64_t CuckooTableBuilder::FileSize() const
+{
+	return rep_->offset;
+}
+
+}  // namespace leveldb
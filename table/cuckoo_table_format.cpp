@@ -0,0 +1,62 @@
+#include "table/cuckoo_table_format.h"
+
+#include <assert.h>
+#include "util/coding.h"
+#include "util/hash.h"
+
+namespace leveldb {
+
+void CuckooTableFooter::EncodeTo(std::string* dst) const {
+	const size_t original_size = dst->size();
+	PutFixed64(dst, num_buckets);
+	PutFixed64(dst, num_entries);
+	PutFixed32(dst, slots_per_bucket);
+	PutFixed32(dst, max_key_length);
+	PutFixed32(dst, max_value_length);
+	PutFixed32(dst, hash_seed);
+	PutFixed32(dst, flags);
+	PutFixed64(dst, kCuckooTableMagicNumber);
+	assert(dst->size() == original_size + kEncodedLength);
+	(void)original_size;  // Disable unused variable warning.
+}
+
+Status CuckooTableFooter::DecodeFrom(Slice* input) {
+	if (input->size() < kEncodedLength) {
+		return Status::Corruption("cuckoo table footer too short");
+	}
+	const char* p = input->data();
+	if (DecodeFixed64(p + kEncodedLength - 8) != kCuckooTableMagicNumber) {
+		return Status::Corruption("not a cuckoo table (bad magic number)");
+	}
+	num_buckets = DecodeFixed64(p);
+	num_entries = DecodeFixed64(p + 8);
+	slots_per_bucket = DecodeFixed32(p + 16);
+	max_key_length = DecodeFixed32(p + 20);
+	max_value_length = DecodeFixed32(p + 24);
+	hash_seed = DecodeFixed32(p + 28);
+	flags = DecodeFixed32(p + 32);
+	input->remove_prefix(kEncodedLength);
+	return Status::OK();
+}
+
+Slice CuckooTableHashKey(const Slice& key, bool internal_keys)
+{
+	if (internal_keys && key.size() >= 8) {
+		return Slice(key.data(), key.size() - 8);
+	}
+	return key;
+}
+
+void CuckooTableBuckets(const Slice& hash_key, uint32_t hash_seed,
+	uint64_t num_buckets, uint64_t* bucket1, uint64_t* bucket2)
+{
+	const uint32_t h1 = Hash(hash_key.data(), hash_key.size(), hash_seed);
+	const uint32_t h2 = Hash(hash_key.data(), hash_key.size(), hash_seed ^ 0x9e3779b9u);
+	*bucket1 = h1 % num_buckets;
+	*bucket2 = h2 % num_buckets;
+	if (*bucket2 == *bucket1 && num_buckets > 1) {
+		*bucket2 = (*bucket1 + 1) % num_buckets;
+	}
+}
+
+}  // namespace leveldb
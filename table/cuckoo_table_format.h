@@ -0,0 +1,75 @@
+#ifndef STORAGE_LEVELDB_TABLE_CUCKOO_TABLE_FORMAT_H_
+#define STORAGE_LEVELDB_TABLE_CUCKOO_TABLE_FORMAT_H_
+
+#include <stdint.h>
+#include <string>
+#include "include/leveldb/slice.h"
+#include "include/leveldb/status.h"
+
+namespace leveldb {
+
+// A cuckoo table file looks like:
+//
+//    [bucket 0]
+//    ...
+//    [bucket num_buckets-1]
+//    [footer]                CuckooTableFooter::kEncodedLength bytes
+//
+// Every bucket holds slots_per_bucket slots of the same size:
+//
+//    fixed32 key length, or kCuckooEmptySlot for an unused slot
+//    key, zero padded to max_key_length bytes
+//    fixed32 value length
+//    value, zero padded to max_value_length bytes
+//
+// A key lives in one of its two candidate buckets, chosen by two hash
+// functions of the key (of the user key for internal keys), so a lookup
+// reads at most two buckets and nothing else.
+
+static const uint64_t kCuckooTableMagicNumber = 0x926789d0c5f17873ull;
+
+static const uint32_t kCuckooEmptySlot = 0xffffffffu;
+
+class CuckooTableFooter {
+public:
+	enum Flags {
+		// Keys are internal keys; buckets are chosen by the user key.
+		kInternalKeys = 0x1
+	};
+
+	CuckooTableFooter()
+		: num_buckets(0), num_entries(0), slots_per_bucket(0),
+		  max_key_length(0), max_value_length(0), hash_seed(0), flags(0) { }
+
+	uint64_t num_buckets;
+	uint64_t num_entries;
+	uint32_t slots_per_bucket;
+	uint32_t max_key_length;
+	uint32_t max_value_length;
+	uint32_t hash_seed;
+	uint32_t flags;
+
+	// Size in bytes of one slot and one bucket
+	size_t slot_size() const { return 8 + max_key_length + max_value_length; }
+	size_t bucket_size() const { return slots_per_bucket * slot_size(); }
+
+	void EncodeTo(std::string* dst) const;
+	Status DecodeFrom(Slice* input);
+
+	// fixed64 num_buckets, fixed64 num_entries, fixed32 slots_per_bucket,
+	// fixed32 max_key_length, fixed32 max_value_length, fixed32 hash_seed,
+	// fixed32 flags, fixed64 magic
+	enum { kEncodedLength = 8 + 8 + 4 + 4 + 4 + 4 + 4 + 8 };
+};
+
+// Return the part of "key" that is hashed and compared by lookups.
+extern Slice CuckooTableHashKey(const Slice& key, bool internal_keys);
+
+// Store the two candidate buckets of "hash_key" in *bucket1 and *bucket2.
+// They differ whenever num_buckets > 1.
+extern void CuckooTableBuckets(const Slice& hash_key, uint32_t hash_seed,
+	uint64_t num_buckets, uint64_t* bucket1, uint64_t* bucket2);
+
+}  // namespace leveldb
+
+#endif  // STORAGE_LEVELDB_TABLE_CUCKOO_TABLE_FORMAT_H_
@@ -0,0 +1,275 @@
+#include "table/filter_block.h"
+
+#include <assert.h>
+#include "include/leveldb/filter_policy.h"
+#include "include/leveldb/slice_transform.h"
+#include "util/coding.h"
+
+namespace leveldb {
+
+// Generate new filter every 2KB of data
+static const size_t kFilterBaseLg = 11;
+static const size_t kFilterBase = 1 << kFilterBaseLg;
+
+FilterBlockBuilder::FilterBlockBuilder(const FilterPolicy* policy,
+	const SliceTransform* prefix_extractor)
+	: policy_(policy),
+	  prefix_extractor_(prefix_extractor),
+	  hash_keys_(policy->SupportsKeyHashes()),
+	  has_last_prefix_(false)
+{
+}
+
+void FilterBlockBuilder::StartBlock(uint64_t block_offset)
+{
+	uint64_t filter_index = (block_offset / kFilterBase);
+	assert(filter_index >= filter_offsets_.size());
+	while (filter_index > filter_offsets_.size()) {
+		GenerateFilter();
+	}
+}
+
+void FilterBlockBuilder::AddKey(const Slice& key)
+{
+	if (hash_keys_) {
+		hashes_.push_back(policy_->HashKey(key));
+	} else {
+		start_.push_back(keys_.size());
+		keys_.append(key.data(), key.size());
+	}
+	if (prefix_extractor_ != NULL && prefix_extractor_->InDomain(key)) {
+		AddPrefix(prefix_extractor_->Transform(key));
+	}
+}
+
+void FilterBlockBuilder::AddPrefix(const Slice& prefix)
+{
+	// Keys arrive sorted, so a run of keys sharing a prefix adds it once
+	// per filter.
+	if (has_last_prefix_ && prefix == Slice(last_prefix_)) {
+		return;
+	}
+	if (hash_keys_) {
+		hashes_.push_back(policy_->HashKey(prefix));
+	} else {
+		start_.push_back(keys_.size());
+		keys_.append(prefix.data(), prefix.size());
+	}
+	last_prefix_.assign(prefix.data(), prefix.size());
+	has_last_prefix_ = true;
+}
+
+Slice FilterBlockBuilder::Finish()
+{
+	if (!start_.empty() || !hashes_.empty()) {
+		GenerateFilter();
+	}
+
+	// Append array of per-filter offsets
+	const uint32_t array_offset = result_.size();
+	for (size_t i = 0; i < filter_offsets_.size(); i++) {
+		PutFixed32(&result_, filter_offsets_[i]);
+	}
+
+	PutFixed32(&result_, array_offset);
+	result_.push_back(kFilterBaseLg);  // Save encoding parameter in result
+	return Slice(result_);
+}
+
+void FilterBlockBuilder::GenerateFilter()
+{
+	const size_t num_keys = (hash_keys_ ? hashes_.size() : start_.size());
+	if (num_keys == 0) {
+		// Fast path if there are no keys for this filter
+		filter_offsets_.push_back(result_.size());
+		return;
+	}
+
+	if (hash_keys_) {
+		filter_offsets_.push_back(result_.size());
+		policy_->CreateFilterFromHashes(&hashes_[0], static_cast<int>(num_keys), &result_);
+		hashes_.clear();
+		has_last_prefix_ = false;
+		return;
+	}
+
+	// Make list of keys from flattened key structure
+	start_.push_back(keys_.size());  // Simplify length computation
+	tmp_keys_.resize(num_keys);
+	for (size_t i = 0; i < num_keys; i++) {
+		const char* base = keys_.data() + start_[i];
+		size_t length = start_[i+1] - start_[i];
+		tmp_keys_[i] = Slice(base, length);
+	}
+
+	// Generate filter for current set of keys and append to result_.
+	filter_offsets_.push_back(result_.size());
+	policy_->CreateFilter(&tmp_keys_[0], static_cast<int>(num_keys), &result_);
+
+	tmp_keys_.clear();
+	keys_.clear();
+	start_.clear();
+	has_last_prefix_ = false;
+}
+
+FilterBlockReader::FilterBlockReader(const FilterPolicy* policy, const Slice& contents)
+	: policy_(policy),
+	  data_(NULL),
+	  offset_(NULL),
+	  num_(0),
+	  base_lg_(0)
+{
+	size_t n = contents.size();
+	if (n < 5) return;  // 1 byte for base_lg_ and 4 for start of offset array
+	base_lg_ = contents[n-1];
+	uint32_t last_word = DecodeFixed32(contents.data() + n - 5);
+	if (last_word > n - 5) return;
+	data_ = contents.data();
+	offset_ = data_ + last_word;
+	num_ = (n - 5 - last_word) / 4;
+}
+
+bool FilterBlockReader::KeyMayMatch(uint64_t block_offset, const Slice& key) const
+{
+	Slice filter;
+	bool match;
+	if (!FindFilter(block_offset, &filter, &match)) {
+		return match;
+	}
+	return policy_->KeyMayMatch(key, filter);
+}
+
+void FilterBlockReader::KeysMayMatch(const uint64_t* block_offsets, const Slice* keys, int n,
+	bool* results) const
+{
+	// Gather the keys that have a filter and probe them in one call
+	std::vector<Slice> probe_keys;
+	std::vector<Slice> filters;
+	std::vector<int> positions;
+	for (int i = 0; i < n; i++) {
+		Slice filter;
+		if (FindFilter(block_offsets[i], &filter, &results[i])) {
+			probe_keys.push_back(keys[i]);
+			filters.push_back(filter);
+			positions.push_back(i);
+		}
+	}
+	if (positions.empty()) {
+		return;
+	}
+
+	const int m = static_cast<int>(positions.size());
+	bool* matches = new bool[m];
+	policy_->KeysMayMatch(&probe_keys[0], &filters[0], m, matches);
+	for (int i = 0; i < m; i++) {
+		results[positions[i]] = matches[i];
+	}
+	delete[] matches;
+}
+
+bool FilterBlockReader::FindFilter(uint64_t block_offset, Slice* filter, bool* match) const
+{
+	uint64_t index = block_offset >> base_lg_;
+	if (index < num_) {
+		uint32_t start = DecodeFixed32(offset_ + index*4);
+		uint32_t limit = DecodeFixed32(offset_ + index*4 + 4);
+		if (start <= limit && limit <= static_cast<size_t>(offset_ - data_)) {
+			*filter = Slice(data_ + start, limit - start);
+			return true;
+		} else if (start == limit) {
+			// Empty filters do not match any keys
+			*match = false;
+			return false;
+		}
+	}
+	*match = true;  // Errors are treated as potential matches
+	return false;
+}
+
+FullFilterBlockBuilder::FullFilterBlockBuilder(const FilterPolicy* policy,
+	const SliceTransform* prefix_extractor)
+	: policy_(policy),
+	  prefix_extractor_(prefix_extractor),
+	  hash_keys_(policy->SupportsKeyHashes()),
+	  has_last_prefix_(false)
+{
+}
+
+void FullFilterBlockBuilder::AddKey(const Slice& key)
+{
+	Append(key);
+	if (prefix_extractor_ != NULL && prefix_extractor_->InDomain(key)) {
+		Slice prefix = prefix_extractor_->Transform(key);
+		if (!has_last_prefix_ || prefix != Slice(last_prefix_)) {
+			Append(prefix);
+			last_prefix_.assign(prefix.data(), prefix.size());
+			has_last_prefix_ = true;
+		}
+	}
+}
+
+void FullFilterBlockBuilder::Append(const Slice& key)
+{
+	if (hash_keys_) {
+		hashes_.push_back(policy_->HashKey(key));
+	} else {
+		start_.push_back(keys_.size());
+		keys_.append(key.data(), key.size());
+	}
+}
+
+Slice FullFilterBlockBuilder::Finish()
+{
+	if (hash_keys_) {
+		if (!hashes_.empty()) {
+			policy_->CreateFilterFromHashes(&hashes_[0], static_cast<int>(hashes_.size()), &result_);
+		}
+		std::vector<uint64_t>().swap(hashes_);
+		return Slice(result_);
+	}
+
+	const size_t num_keys = start_.size();
+	if (num_keys > 0) {
+		start_.push_back(keys_.size());  // Simplify length computation
+		std::vector<Slice> tmp_keys(num_keys);
+		for (size_t i = 0; i < num_keys; i++) {
+			tmp_keys[i] = Slice(keys_.data() + start_[i], start_[i+1] - start_[i]);
+		}
+		policy_->CreateFilter(&tmp_keys[0], static_cast<int>(num_keys), &result_);
+	}
+	keys_.clear();
+	start_.clear();
+	return Slice(result_);
+}
+
+FullFilterBlockReader::FullFilterBlockReader(const FilterPolicy* policy, const Slice& contents)
+	: policy_(policy),
+	  filter_(contents)
+{
+}
+
+bool FullFilterBlockReader::KeyMayMatch(const Slice& key) const
+{
+	if (filter_.empty()) {
+		// A table without keys
+		return false;
+	}
+	return policy_->KeyMayMatch(key, filter_);
+}
+
+void FullFilterBlockReader::KeysMayMatch(const Slice* keys, int n, bool* results) const
+{
+	if (n <= 0) {
+		return;
+	}
+	if (filter_.empty()) {
+		for (int i = 0; i < n; i++) {
+			results[i] = false;
+		}
+		return;
+	}
+	std::vector<Slice> filters(n, filter_);
+	policy_->KeysMayMatch(keys, &filters[0], n, results);
+}
+
+}
@@ -1,3 +1,6 @@
+#ifndef STORAGE_LEVELDB_TABLE_FILTER_BLOCK_H_
+#define STORAGE_LEVELDB_TABLE_FILTER_BLOCK_H_
+
 #include <stddef.h>
 #include <stdint.h>
 #include <string>
@@ -7,10 +10,22 @@
 namespace leveldb {
 
 class FilterPolicy;
+class SliceTransform;
 
+// A FilterBlockBuilder is used to construct all of the filters for a
+// particular Table.  It generates a single string which is stored as
+// a special block in the Table.
+//
+// If a prefix extractor is given, the prefix of every key in its domain
+// is added to the filters as well.  Keys are hashed as they are added if
+// the policy supports it, otherwise their bytes are buffered until the
+// filter is generated.
+//
+// The sequence of calls to FilterBlockBuilder must match the regexp:
+//      (StartBlock AddKey*)* Finish
 class FilterBlockBuilder {
 public:
-	explicit FilterBlockBuilder(const FilterPolicy*);
+	FilterBlockBuilder(const FilterPolicy*, const SliceTransform* prefix_extractor);
 
 	void StartBlock(uint64_t block_offset);
 	void AddKey(const Slice& key);
@@ -18,10 +33,16 @@ public:
 
 private:
 	void GenerateFilter();
+	void AddPrefix(const Slice& prefix);
 
 	const FilterPolicy* policy_;
-	std::string keys_;              // Flattened key contents
+	const SliceTransform* prefix_extractor_;
+	const bool hash_keys_;          // policy_->SupportsKeyHashes()
+	std::vector<uint64_t> hashes_;  // Key hashes, if hash_keys_
+	std::string keys_;              // Flattened key contents, if !hash_keys_
 	std::vector<size_t> start_;     // Starting index in keys_ of each key
+	std::string last_prefix_;       // Last prefix added to the current filter
+	bool has_last_prefix_;
 	std::string result_;            // Filter data computed so far
 	std::vector<Slice> tmp_keys_;   // policy_->CreateFilter() argument
 	std::vector<uint32_t> filter_offsets_;
@@ -31,4 +52,77 @@ private:
 	void operator=(const FilterBlockBuilder&);
 };
 
-}
\ No newline at end of file
+class FilterBlockReader {
+public:
+	// REQUIRES: "contents" and *policy must stay live while *this is live.
+	FilterBlockReader(const FilterPolicy* policy, const Slice& contents);
+
+	bool KeyMayMatch(uint64_t block_offset, const Slice& key) const;
+
+	// Set results[i] to KeyMayMatch(block_offsets[i], keys[i]) for every
+	// i in [0,n-1].  The filters of all the keys are probed together, so
+	// that the policy can overlap their cache misses.
+	void KeysMayMatch(const uint64_t* block_offsets, const Slice* keys, int n,
+		bool* results) const;
+
+private:
+	// Set *filter to the filter of the block at "block_offset" and return
+	// true, or return false with the answer in *match if there is none.
+	bool FindFilter(uint64_t block_offset, Slice* filter, bool* match) const;
+
+	const FilterPolicy* policy_;
+	const char* data_;    // Pointer to filter data (at block-start)
+	const char* offset_;  // Pointer to beginning of offset array (at block-end)
+	size_t num_;          // Number of entries in offset array
+	size_t base_lg_;      // Encoding parameter (see kFilterBaseLg in .cpp file)
+};
+
+// A FullFilterBlockBuilder builds one filter over every key of a Table
+// instead of one filter per range of data blocks.  A lookup can then be
+// rejected before the index block is searched at all.
+//
+// The sequence of calls to FullFilterBlockBuilder must match the regexp:
+//      AddKey* Finish
+class FullFilterBlockBuilder {
+public:
+	FullFilterBlockBuilder(const FilterPolicy*, const SliceTransform* prefix_extractor);
+
+	void AddKey(const Slice& key);
+	Slice Finish();
+
+private:
+	void Append(const Slice& key);
+
+	const FilterPolicy* policy_;
+	const SliceTransform* prefix_extractor_;
+	const bool hash_keys_;          // policy_->SupportsKeyHashes()
+	std::vector<uint64_t> hashes_;  // Key hashes, if hash_keys_
+	std::string keys_;              // Flattened key contents, if !hash_keys_
+	std::vector<size_t> start_;     // Starting index in keys_ of each key
+	std::string last_prefix_;       // Last prefix added
+	bool has_last_prefix_;
+	std::string result_;            // Filter data
+
+	// No copying allowed
+	FullFilterBlockBuilder(const FullFilterBlockBuilder&);
+	void operator=(const FullFilterBlockBuilder&);
+};
+
+class FullFilterBlockReader {
+public:
+	// REQUIRES: "contents" and *policy must stay live while *this is live.
+	FullFilterBlockReader(const FilterPolicy* policy, const Slice& contents);
+
+	bool KeyMayMatch(const Slice& key) const;
+
+	// Set results[i] to KeyMayMatch(keys[i]) for every i in [0,n-1].
+	void KeysMayMatch(const Slice* keys, int n, bool* results) const;
+
+private:
+	const FilterPolicy* policy_;
+	Slice filter_;
+};
+
+}
+
+#endif
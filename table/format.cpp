@@ -59,6 +59,43 @@ Status Footer::DecodeFrom(Slice* input) {
   return result;
 }
 
+// Verify the trailer of the raw block in "data[0..n+kBlockTrailerSize-1]"
+// and return its compression type in *type.
+static Status CheckBlockTrailer(const ReadOptions& options,
+								const char* data,
+								size_t n,
+								CompressionType* type)
+{
+	if (options.verify_checksums) {
+		const uint32_t crc = crc32c::Unmask(DecodeFixed32(data + n + 1));
+		const uint32_t actual = crc32c::Value(data, n + 1);
+		if (actual != crc) {
+			return Status::Corruption("block checksum mismatch");
+		}
+	}
+	*type = static_cast<CompressionType>(data[n]);
+	return Status::OK();
+}
+
+// Uncompress the Snappy block "data[0..n-1]" into a new heap buffer that
+// *result takes.
+static Status UncompressSnappyBlock(const char* data, size_t n, BlockContents* result)
+{
+	size_t ulength = 0;
+	if (!port::Snappy_GetUncompressedLength(data, n, &ulength)) {
+		return Status::Corruption("corrupted compressed block contents");
+	}
+	char* ubuf = new char[ulength];
+	if (!port::Snappy_Uncompress(data, n, ubuf)) {
+		delete[] ubuf;
+		return Status::Corruption("corrupted compressed block contents");
+	}
+	result->data = Slice(ubuf, ulength);
+	result->heap_allocated = true;
+	result->cachable = true;
+	return Status::OK();
+}
+
 Status ReadBlock(RandomAccessFile* file, 
 				const ReadOptions& options,
 				const BlockHandle& handle, 
@@ -68,8 +105,13 @@ Status ReadBlock(RandomAccessFile* file,
 	result->data = Slice();
 	result->heap_allocated = false;
 
+	// Files that hand out stable pointers (e.g. mmap) are read without a
+	// scratch buffer; the block is then used in place with no copy.
 	size_t n = static_cast<size_t>(handle.size());
-	char* buf = new char[n + kBlockTrailerSize];
+	char* buf = NULL;
+	if (!file->ReturnsStablePointers()) {
+		buf = new char[n + kBlockTrailerSize];
+	}
 	Slice contents;
 	Status s = file->Read(handle.offset(), n + kBlockTrailerSize, &contents, buf);
 	if (!s.ok()) {
@@ -82,17 +124,13 @@ Status ReadBlock(RandomAccessFile* file,
 	}
 
 	const char* data = contents.data();
-	if (options.verify_checksums) {
-		const uint32_t crc = crc32c::Unmask(DecodeFixed32(data + n + 1));
-		const uint32_t actual = crc32c::Value(data, n + 1);
-		if (actual != crc) {
-			delete[] buf;
-			s = Status::Corruption("block checksum mismatch");
-			return s;
-		}
+	CompressionType type;
+	s = CheckBlockTrailer(options, data, n, &type);
+	if (!s.ok()) {
+		delete[] buf;
+		return s;
 	}
 
-	CompressionType type = static_cast<CompressionType>(data[n]);
 	switch (type)
 	{
 	case kNoCompression:
@@ -110,7 +148,9 @@ Status ReadBlock(RandomAccessFile* file,
 		}
 		break;
 	case kSnappyCompression:
-		break;
+		s = UncompressSnappyBlock(data, n, result);
+		delete[] buf;
+		return s;
 	default:
 		delete[] buf;
 		return Status::Corruption("bad block type");
@@ -118,4 +158,79 @@ Status ReadBlock(RandomAccessFile* file,
 	return Status::OK();
 }
 
+Status DecodeBlock(const ReadOptions& options,
+				const BlockHandle& handle,
+				const Slice& raw,
+				BlockContents* result)
+{
+	result->cachable = false;
+	result->data = Slice();
+	result->heap_allocated = false;
+
+	size_t n = static_cast<size_t>(handle.size());
+	if (raw.size() != n + kBlockTrailerSize) {
+		return Status::Corruption("truncated block read");
+	}
+
+	CompressionType type;
+	Status s = CheckBlockTrailer(options, raw.data(), n, &type);
+	if (!s.ok()) {
+		return s;
+	}
+
+	switch (type)
+	{
+	case kNoCompression:
+		{
+			char* buf = new char[n];
+			memcpy(buf, raw.data(), n);
+			result->data = Slice(buf, n);
+			result->heap_allocated = true;
+			result->cachable = true;
+			break;
+		}
+	case kSnappyCompression:
+		return UncompressSnappyBlock(raw.data(), n, result);
+	default:
+		return Status::Corruption("bad block type");
+	}
+	return Status::OK();
+}
+
+Status ReadBlock(RandomAccessFile* file,
+				const FilePrefetchBuffer* prefetch,
+				const ReadOptions& options,
+				const BlockHandle& handle,
+				BlockContents* result)
+{
+	Slice raw;
+	if (prefetch != NULL &&
+		prefetch->TryRead(handle.offset(),
+			static_cast<size_t>(handle.size()) + kBlockTrailerSize, &raw)) {
+		return DecodeBlock(options, handle, raw, result);
+	}
+	return ReadBlock(file, options, handle, result);
+}
+
+Status FilePrefetchBuffer::Prefetch(RandomAccessFile* file, uint64_t offset, size_t n)
+{
+	delete[] buf_;
+	buf_ = new char[n];
+	offset_ = offset;
+	Status s = file->Read(offset, n, &data_, buf_);
+	if (!s.ok()) {
+		data_ = Slice();
+	}
+	return s;
+}
+
+bool FilePrefetchBuffer::TryRead(uint64_t offset, size_t n, Slice* result) const
+{
+	if (offset < offset_ || offset + n > offset_ + data_.size()) {
+		return false;
+	}
+	*result = Slice(data_.data() + (offset - offset_), n);
+	return true;
+}
+
 }  // namespace leveldb
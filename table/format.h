@@ -2,11 +2,17 @@
 #ifndef STORAGE_LEVELDB_TABLE_FORMAT_H_
 #define STORAGE_LEVELDB_TABLE_FORMAT_H_
 
+#include <stdint.h>
+#include <string>
 #include "include/leveldb/slice.h"
+#include "include/leveldb/status.h"
 
 namespace leveldb 
 {
 
+class RandomAccessFile;
+struct ReadOptions;
+
 // kTableMagicNumber was picked by running
 //    echo http://code.google.com/p/leveldb/ | sha1sum
 // and taking the leading 64 bits.
@@ -76,11 +82,59 @@ private:
 	BlockHandle index_handle_;
 };
 
+// Holds a range of a file that was fetched ahead of time with a single
+// read, so that blocks lying entirely inside it need no read of their own.
+class FilePrefetchBuffer {
+public:
+	FilePrefetchBuffer() : offset_(0), buf_(NULL) { }
+	~FilePrefetchBuffer() { delete[] buf_; }
+
+	// Read bytes [offset, offset+n-1] of "file" in one call.
+	Status Prefetch(RandomAccessFile* file, uint64_t offset, size_t n);
+
+	// If bytes [offset, offset+n-1] were prefetched, point *result at them
+	// and return true.  *result stays valid while *this is live.
+	bool TryRead(uint64_t offset, size_t n, Slice* result) const;
+
+private:
+	uint64_t offset_;
+	Slice data_;
+	char* buf_;
+
+	// No copying allowed
+	FilePrefetchBuffer(const FilePrefetchBuffer&);
+	void operator=(const FilePrefetchBuffer&);
+};
+
+inline BlockHandle::BlockHandle()
+	: offset_(~static_cast<uint64_t>(0)),
+	  size_(~static_cast<uint64_t>(0)) {
+}
+
 extern Status ReadBlock(RandomAccessFile* file, 
 					const ReadOptions& options,
 					const BlockHandle& handle, 
 					BlockContents* result);
 
+// Like ReadBlock(), but serves the block from "prefetch" when it was
+// prefetched.  "prefetch" may be NULL.  Blocks taken from the prefetch
+// buffer are copied, so the buffer may be freed once this returns.
+extern Status ReadBlock(RandomAccessFile* file,
+					const FilePrefetchBuffer* prefetch,
+					const ReadOptions& options,
+					const BlockHandle& handle,
+					BlockContents* result);
+
+// Decode the block identified by "handle" from "raw", which must hold the
+// block contents immediately followed by its trailer, e.g. a piece of one
+// larger read that covered several adjacent blocks.  On success
+// result->data is a heap allocated copy owned by the caller, so "raw"
+// need not outlive the result.
+extern Status DecodeBlock(const ReadOptions& options,
+					const BlockHandle& handle,
+					const Slice& raw,
+					BlockContents* result);
+
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,274 @@
+#include "include/leveldb/parallel_table_writer.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <deque>
+#include "include/leveldb/comparator.h"
+#include "include/leveldb/env.h"
+#include "include/leveldb/table_builder.h"
+#include "db/dbformat.h"
+#include "port/port.h"
+#include "util/coding.h"
+#include "util/mutexlock.h"
+
+namespace leveldb {
+
+namespace {
+
+// A run of the input stream that becomes one file.  The pairs are stored
+// as varint32 key length, key, varint32 value length, value.
+struct Piece {
+	uint64_t number;
+	std::string data;
+};
+
+}  // namespace
+
+struct ParallelTableWriter::Rep {
+	Options options;
+	Env* env;
+	std::string fname_prefix;
+	size_t target_file_size;
+	int num_threads;
+	bool internal_keys;
+
+	// Only used by the thread calling Add() and Finish()
+	Piece* current;
+	uint64_t next_number;
+	std::string last_key;
+	uint64_t num_entries;
+	bool closed;
+
+	port::Mutex mu;
+	port::CondVar cv;                    // Signalled on every state change
+	std::deque<Piece*> queue;            // Pieces waiting for a thread
+	int running_threads;
+	bool no_more_pieces;
+	Status bg_status;                    // First error of any thread
+	std::vector<ParallelTableFile> files;
+
+	Rep(const Options& opt, Env* e, const std::string& prefix, size_t target, int threads)
+		: options(opt),
+		  env(e),
+		  fname_prefix(prefix),
+		  target_file_size(target),
+		  num_threads(threads < 1 ? 1 : threads),
+		  internal_keys(strcmp(opt.comparator->Name(), "leveldb.InternalKeyComparator") == 0),
+		  current(NULL),
+		  next_number(0),
+		  num_entries(0),
+		  closed(false),
+		  cv(&mu),
+		  running_threads(0),
+		  no_more_pieces(false) {
+	}
+
+	Slice UserKey(const Slice& key) const {
+		return internal_keys ? ExtractUserKey(key) : key;
+	}
+
+	// Build "piece" into its file and describe the result in *meta.
+	Status BuildTable(const Piece* piece, ParallelTableFile* meta);
+};
+
+Status ParallelTableWriter::Rep::BuildTable(const Piece* piece, ParallelTableFile* meta)
+{
+	char buf[32];
+	snprintf(buf, sizeof(buf), "%06llu.ldb",
+		static_cast<unsigned long long>(piece->number));
+	meta->filename = fname_prefix + buf;
+	meta->num_entries = 0;
+	meta->file_size = 0;
+
+	// The file will be about target_file_size bytes, so reserve its space
+	// in one step and let the kernel write it back while it is built.
+	WritableFileOptions file_options;
+	file_options.preallocation_size = target_file_size + target_file_size / 4;
+	file_options.bytes_per_sync = 1024 * 1024;
+	WritableFile* file;
+	Status s = env->NewWritableFile(meta->filename, file_options, &file);
+	if (!s.ok()) {
+		return s;
+	}
+
+	TableBuilder builder(options, file);
+	const char* p = piece->data.data();
+	const char* limit = p + piece->data.size();
+	Slice key, value;
+	while (p < limit) {
+		uint32_t key_length, value_length;
+		p = GetVarint32Ptr(p, limit, &key_length);
+		key = Slice(p, key_length);
+		p = GetVarint32Ptr(p + key_length, limit, &value_length);
+		value = Slice(p, value_length);
+		p += value_length;
+		if (meta->num_entries == 0) {
+			meta->smallest_key = key.ToString();
+		}
+		builder.Add(key, value);
+		meta->num_entries++;
+	}
+	meta->largest_key = key.ToString();
+
+	s = builder.Finish();
+	if (s.ok()) {
+		meta->file_size = builder.FileSize();
+		s = file->Sync();
+	}
+	if (s.ok()) {
+		s = file->Close();
+	}
+	delete file;
+	return s;
+}
+
+ParallelTableWriter::ParallelTableWriter(const Options& options, Env* env,
+	const std::string& fname_prefix, size_t target_file_size, int num_threads)
+	: rep_(new Rep(options, env, fname_prefix, target_file_size, num_threads))
+{
+	MutexLock l(&rep_->mu);
+	for (int i = 0; i < rep_->num_threads; i++) {
+		rep_->running_threads++;
+		env->StartThread(&ParallelTableWriter::BGWork, rep_);
+	}
+}
+
+ParallelTableWriter::~ParallelTableWriter()
+{
+	assert(rep_->closed);
+	delete rep_->current;
+	delete rep_;
+}
+
+void ParallelTableWriter::BGWork(void* arg)
+{
+	Rep* r = reinterpret_cast<Rep*>(arg);
+	MutexLock l(&r->mu);
+	while (true) {
+		while (r->queue.empty() && !r->no_more_pieces) {
+			r->cv.Wait();
+		}
+		if (r->queue.empty()) {
+			break;
+		}
+		Piece* piece = r->queue.front();
+		r->queue.pop_front();
+		r->cv.SignalAll();
+
+		ParallelTableFile meta;
+		r->mu.Unlock();
+		Status s = r->BuildTable(piece, &meta);
+		r->mu.Lock();
+
+		if (r->files.size() <= piece->number) {
+			r->files.resize(piece->number + 1);
+		}
+		r->files[piece->number] = meta;
+		if (!s.ok() && r->bg_status.ok()) {
+			r->bg_status = s;
+		}
+		delete piece;
+	}
+	r->running_threads--;
+	r->cv.SignalAll();
+}
+
+void ParallelTableWriter::Add(const Slice& key, const Slice& value)
+{
+	Rep* r = rep_;
+	assert(!r->closed);
+	if (r->num_entries > 0) {
+		assert(r->options.comparator->Compare(key, Slice(r->last_key)) > 0);
+	}
+
+	if (r->current != NULL &&
+		r->current->data.size() >= r->target_file_size &&
+		r->UserKey(key) != r->UserKey(r->last_key)) {
+		Submit();
+	}
+	if (r->current == NULL) {
+		if (!status().ok()) return;
+		r->current = new Piece;
+		r->current->number = r->next_number++;
+		r->current->data.reserve(r->target_file_size + r->target_file_size / 8);
+	}
+
+	PutVarint32(&r->current->data, static_cast<uint32_t>(key.size()));
+	r->current->data.append(key.data(), key.size());
+	PutVarint32(&r->current->data, static_cast<uint32_t>(value.size()));
+	r->current->data.append(value.data(), value.size());
+	r->last_key.assign(key.data(), key.size());
+	r->num_entries++;
+}
+
+void ParallelTableWriter::Submit()
+{
+	Rep* r = rep_;
+	Piece* piece = r->current;
+	r->current = NULL;
+
+	// Bound the memory held by pieces nobody works on yet
+	MutexLock l(&r->mu);
+	while (r->bg_status.ok() &&
+		r->queue.size() >= static_cast<size_t>(r->num_threads)) {
+		r->cv.Wait();
+	}
+	if (!r->bg_status.ok()) {
+		delete piece;
+		return;
+	}
+	r->queue.push_back(piece);
+	r->cv.SignalAll();
+}
+
+void ParallelTableWriter::WaitForWorkers()
+{
+	Rep* r = rep_;
+	MutexLock l(&r->mu);
+	r->no_more_pieces = true;
+	r->cv.SignalAll();
+	while (r->running_threads > 0) {
+		r->cv.Wait();
+	}
+}
+
+Status ParallelTableWriter::status() const
+{
+	MutexLock l(&rep_->mu);
+	return rep_->bg_status;
+}
+
+Status ParallelTableWriter::Finish()
+{
+	Rep* r = rep_;
+	assert(!r->closed);
+	r->closed = true;
+	if (r->current != NULL) {
+		Submit();
+	}
+	WaitForWorkers();
+	return r->bg_status;
+}
+
+void ParallelTableWriter::Abandon()
+{
+	Rep* r = rep_;
+	assert(!r->closed);
+	r->closed = true;
+	{
+		MutexLock l(&r->mu);
+		while (!r->queue.empty()) {
+			delete r->queue.front();
+			r->queue.pop_front();
+		}
+	}
+	WaitForWorkers();
+}
+
+const std::vector<ParallelTableFile>& ParallelTableWriter::files() const
+{
+	return rep_->files;
+}
+
+}  // namespace leveldb
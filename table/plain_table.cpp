@@ -0,0 +1,231 @@
+#include "include/leveldb/plain_table.h"
+
+#include <assert.h>
+#include "include/leveldb/comparator.h"
+#include "include/leveldb/env.h"
+#include "include/leveldb/options.h"
+#include "table/plain_table_format.h"
+#include "util/coding.h"
+#include "util/hash.h"
+
+namespace leveldb {
+
+struct PlainTable::Rep {
+	Options options;
+	PlainTableFooter footer;
+	const char* data;          // Records, hash index and footer of the file
+	const char* data_limit;    // End of the records
+	const char* buckets;       // Hash index
+	char* owned_data;          // Copy of the file if it is not memory-mapped
+	bool internal_keys;
+
+	~Rep() {
+		delete[] owned_data;
+	}
+};
+
+Status PlainTable::Open(const Options& options, RandomAccessFile* file,
+	uint64_t size, PlainTable** table)
+{
+	*table = NULL;
+	if (size < PlainTableFooter::kEncodedLength) {
+		return Status::Corruption("file is too short to be a plain table");
+	}
+	if (size != static_cast<size_t>(size)) {
+		return Status::InvalidArgument("plain table does not fit in memory");
+	}
+
+	// The whole file is needed in memory.  A memory-mapped file already is,
+	// anything else is read once up front.
+	char* owned_data = NULL;
+	Slice contents;
+	Status s;
+	if (file->ReturnsStablePointers()) {
+		s = file->Read(0, static_cast<size_t>(size), &contents, NULL);
+	} else {
+		owned_data = new char[static_cast<size_t>(size)];
+		s = file->Read(0, static_cast<size_t>(size), &contents, owned_data);
+	}
+	if (s.ok() && contents.size() != size) {
+		s = Status::Corruption("truncated plain table read");
+	}
+
+	PlainTableFooter footer;
+	if (s.ok()) {
+		Slice footer_input(contents.data() + size - PlainTableFooter::kEncodedLength,
+			PlainTableFooter::kEncodedLength);
+		s = footer.DecodeFrom(&footer_input);
+	}
+	if (s.ok() &&
+		(footer.num_buckets == 0 ||
+		 footer.index_offset + uint64_t(footer.num_buckets) * 4 +
+		 PlainTableFooter::kEncodedLength != size)) {
+		s = Status::Corruption("bad plain table index");
+	}
+	if (!s.ok()) {
+		delete[] owned_data;
+		return s;
+	}
+
+	Rep* rep = new PlainTable::Rep;
+	rep->options = options;
+	rep->footer = footer;
+	rep->data = contents.data();
+	rep->data_limit = contents.data() + footer.index_offset;
+	rep->buckets = rep->data_limit;
+	rep->owned_data = owned_data;
+	rep->internal_keys = (footer.flags & PlainTableFooter::kInternalKeys) != 0;
+	*table = new PlainTable(rep);
+	return s;
+}
+
+PlainTable::~PlainTable()
+{
+	delete rep_;
+}
+
+uint64_t PlainTable::NumEntries() const
+{
+	return rep_->footer.num_entries;
+}
+
+uint32_t PlainTable::FindPrefix(const Slice& prefix) const
+{
+	const Rep* r = rep_;
+	const uint32_t num_buckets = r->footer.num_buckets;
+	uint32_t b = Hash(prefix.data(), prefix.size(), kPlainTableHashSeed) % num_buckets;
+	for (uint32_t probes = 0; probes < num_buckets; probes++) {
+		const uint32_t offset = DecodeFixed32(r->buckets + b * 4);
+		if (offset == kPlainTableEmptyBucket || offset >= r->footer.index_offset) {
+			break;
+		}
+		Slice key, value;
+		if (DecodePlainTableRecord(r->data + offset, r->data_limit, &key, &value) == NULL) {
+			break;
+		}
+		if (PlainTablePrefix(key, r->internal_keys, r->footer.prefix_length) == prefix) {
+			return offset;
+		}
+		b = (b + 1 == num_buckets ? 0 : b + 1);
+	}
+	return kPlainTableEmptyBucket;
+}
+
+Status PlainTable::Get(const ReadOptions& options, const Slice& k, void* arg,
+	void (*saver)(void*, const Slice&, const Slice&)) const
+{
+	const Rep* r = rep_;
+	const Slice prefix = PlainTablePrefix(k, r->internal_keys, r->footer.prefix_length);
+	const uint32_t offset = FindPrefix(prefix);
+	if (offset == kPlainTableEmptyBucket) {
+		// Not found
+		return Status::OK();
+	}
+
+	const Comparator* comparator = r->options.comparator;
+	const char* p = r->data + offset;
+	while (p < r->data_limit) {
+		Slice key, value;
+		p = DecodePlainTableRecord(p, r->data_limit, &key, &value);
+		if (p == NULL) {
+			return Status::Corruption("bad entry in plain table");
+		}
+		if (PlainTablePrefix(key, r->internal_keys, r->footer.prefix_length) != prefix) {
+			break;
+		}
+		if (comparator->Compare(key, k) >= 0) {
+			(*saver)(arg, key, value);
+			break;
+		}
+	}
+	return Status::OK();
+}
+
+class PlainTableIterator : public Iterator {
+public:
+	explicit PlainTableIterator(const PlainTable* table)
+		: table_(table),
+		  rep_(table->rep_),
+		  current_(NULL),
+		  next_(NULL) {
+	}
+
+	virtual bool Valid() const { return current_ != NULL; }
+	virtual Slice key() const { assert(Valid()); return key_; }
+	virtual Slice value() const { assert(Valid()); return value_; }
+	virtual Status status() const { return status_; }
+
+	virtual void SeekToFirst() {
+		ParseAt(rep_->data);
+	}
+
+	virtual void SeekToLast() {
+		// There is no index of the last record, walk to it.
+		SeekToFirst();
+		const char* last = current_;
+		while (Valid()) {
+			last = current_;
+			Next();
+		}
+		if (status_.ok() && last != NULL) {
+			ParseAt(last);
+		}
+	}
+
+	virtual void Seek(const Slice& target) {
+		const Slice prefix = PlainTablePrefix(target, rep_->internal_keys,
+			rep_->footer.prefix_length);
+		const uint32_t offset = table_->FindPrefix(prefix);
+		if (offset != kPlainTableEmptyBucket) {
+			ParseAt(rep_->data + offset);
+		} else {
+			SeekToFirst();
+		}
+		const Comparator* comparator = rep_->options.comparator;
+		while (Valid() && comparator->Compare(key_, target) < 0) {
+			Next();
+		}
+	}
+
+	virtual void Next() {
+		assert(Valid());
+		ParseAt(next_);
+	}
+
+	virtual void Prev() {
+		assert(Valid());
+		current_ = NULL;
+		status_ = Status::NotSupported("plain table iterators cannot move backwards");
+	}
+
+private:
+	// Make the record at "p" current.  "p" at the end of the records
+	// leaves the iterator invalid.
+	void ParseAt(const char* p) {
+		current_ = NULL;
+		if (p >= rep_->data_limit) {
+			return;
+		}
+		next_ = DecodePlainTableRecord(p, rep_->data_limit, &key_, &value_);
+		if (next_ == NULL) {
+			status_ = Status::Corruption("bad entry in plain table");
+			return;
+		}
+		current_ = p;
+	}
+
+	const PlainTable* const table_;
+	const PlainTable::Rep* const rep_;
+	const char* current_;   // Record at the iterator, NULL if !Valid()
+	const char* next_;      // Record after current_
+	Slice key_;
+	Slice value_;
+	Status status_;
+};
+
+Iterator* PlainTable::NewIterator(const ReadOptions& options) const
+{
+	return new PlainTableIterator(this);
+}
+
+}  // namespace leveldb
@@ -0,0 +1,149 @@
+#include "include/leveldb/plain_table_builder.h"
+
+#include <assert.h>
+#include <string.h>
+#include <vector>
+#include "include/leveldb/comparator.h"
+#include "include/leveldb/env.h"
+#include "table/plain_table_format.h"
+#include "util/coding.h"
+#include "util/hash.h"
+
+namespace leveldb {
+
+// The hash index is sized for at most this many groups per 4 buckets.
+static const uint32_t kMaxGroupsPerFourBuckets = 3;
+
+struct PlainTableBuilder::Rep {
+	Options options;
+	WritableFile* file;
+	uint64_t offset;
+	Status status;
+	std::string last_key;
+	std::string last_prefix;        // Prefix of last_key
+	uint64_t num_entries;
+	bool closed;                    // Either Finish() or Abandon() has been called.
+	bool internal_keys;
+	std::vector<uint32_t> group_hashes;   // Hash of the prefix of each group
+	std::vector<uint32_t> group_offsets;  // Offset of the first record of each group
+	std::string record;             // Scratch space for one encoded record
+
+	Rep(const Options& opt, WritableFile* f)
+		: options(opt),
+		  file(f),
+		  offset(0),
+		  num_entries(0),
+		  closed(false),
+		  internal_keys(strcmp(opt.comparator->Name(), "leveldb.InternalKeyComparator") == 0) {
+	}
+};
+
+PlainTableBuilder::PlainTableBuilder(const Options& options, WritableFile* file)
+	: rep_(new Rep(options, file))
+{
+}
+
+PlainTableBuilder::~PlainTableBuilder()
+{
+	assert(rep_->closed);
+	delete rep_;
+}
+
+void PlainTableBuilder::Add(const Slice& key, const Slice& value)
+{
+	Rep* r = rep_;
+	assert(!r->closed);
+	if (!ok()) return;
+	if (r->num_entries > 0) {
+		assert(r->options.comparator->Compare(key, Slice(r->last_key)) > 0);
+	}
+
+	Slice prefix = PlainTablePrefix(key, r->internal_keys,
+		static_cast<uint32_t>(r->options.plain_table_prefix_length));
+	if (r->num_entries == 0 || prefix != Slice(r->last_prefix)) {
+		if (r->offset >= kPlainTableEmptyBucket) {
+			r->status = Status::InvalidArgument("plain table records exceed 4GB");
+			return;
+		}
+		r->group_hashes.push_back(Hash(prefix.data(), prefix.size(), kPlainTableHashSeed));
+		r->group_offsets.push_back(static_cast<uint32_t>(r->offset));
+		r->last_prefix.assign(prefix.data(), prefix.size());
+	}
+
+	r->record.clear();
+	PutVarint32(&r->record, static_cast<uint32_t>(key.size()));
+	r->record.append(key.data(), key.size());
+	PutVarint32(&r->record, static_cast<uint32_t>(value.size()));
+	r->record.append(value.data(), value.size());
+	r->status = r->file->Append(r->record);
+	if (ok()) {
+		r->offset += r->record.size();
+	}
+
+	r->last_key.assign(key.data(), key.size());
+	r->num_entries++;
+}
+
+Status PlainTableBuilder::status() const
+{
+	return rep_->status;
+}
+
+Status PlainTableBuilder::Finish()
+{
+	Rep* r = rep_;
+	assert(!r->closed);
+	r->closed = true;
+	if (!ok()) return r->status;
+
+	// Build the hash index
+	const size_t num_groups = r->group_offsets.size();
+	const uint32_t num_buckets = static_cast<uint32_t>(
+		num_groups * 4 / kMaxGroupsPerFourBuckets + 1);
+	std::vector<uint32_t> buckets(num_buckets, kPlainTableEmptyBucket);
+	for (size_t i = 0; i < num_groups; i++) {
+		uint32_t b = r->group_hashes[i] % num_buckets;
+		while (buckets[b] != kPlainTableEmptyBucket) {
+			b = (b + 1 == num_buckets ? 0 : b + 1);
+		}
+		buckets[b] = r->group_offsets[i];
+	}
+
+	std::string index;
+	index.reserve(num_buckets * 4 + PlainTableFooter::kEncodedLength);
+	for (uint32_t b = 0; b < num_buckets; b++) {
+		PutFixed32(&index, buckets[b]);
+	}
+
+	PlainTableFooter footer;
+	footer.index_offset = r->offset;
+	footer.num_entries = r->num_entries;
+	footer.num_buckets = num_buckets;
+	footer.prefix_length = static_cast<uint32_t>(r->options.plain_table_prefix_length);
+	footer.flags = (r->internal_keys ? PlainTableFooter::kInternalKeys : 0);
+	footer.EncodeTo(&index);
+
+	r->status = r->file->Append(index);
+	if (ok()) {
+		r->offset += index.size();
+	}
+	return r->status;
+}
+
+void PlainTableBuilder::Abandon()
+{
+	assert(!rep_->closed);
+	rep_->closed = true;
+}
+
+uint64_t PlainTableBuilder::NumEntries() const
+{
+	return rep_->num_entries;
+}
+
+uint64_t PlainTableBuilder::FileSize() const
+{
+	return rep_->offset;
+}
+
+}  // namespace leveldb
@@ -0,0 +1,65 @@
+#include "table/plain_table_format.h"
+
+#include <assert.h>
+#include "util/coding.h"
+
+namespace leveldb {
+
+void PlainTableFooter::EncodeTo(std::string* dst) const {
+	const size_t original_size = dst->size();
+	PutFixed64(dst, index_offset);
+	PutFixed64(dst, num_entries);
+	PutFixed32(dst, num_buckets);
+	PutFixed32(dst, prefix_length);
+	PutFixed32(dst, flags);
+	PutFixed64(dst, kPlainTableMagicNumber);
+	assert(dst->size() == original_size + kEncodedLength);
+	(void)original_size;  // Disable unused variable warning.
+}
+
+Status PlainTableFooter::DecodeFrom(Slice* input) {
+	if (input->size() < kEncodedLength) {
+		return Status::Corruption("plain table footer too short");
+	}
+	const char* p = input->data();
+	if (DecodeFixed64(p + kEncodedLength - 8) != kPlainTableMagicNumber) {
+		return Status::Corruption("not a plain table (bad magic number)");
+	}
+	index_offset = DecodeFixed64(p);
+	num_entries = DecodeFixed64(p + 8);
+	num_buckets = DecodeFixed32(p + 16);
+	prefix_length = DecodeFixed32(p + 20);
+	flags = DecodeFixed32(p + 24);
+	input->remove_prefix(kEncodedLength);
+	return Status::OK();
+}
+
+Slice PlainTablePrefix(const Slice& key, bool internal_keys, uint32_t prefix_length)
+{
+	Slice prefix = key;
+	if (internal_keys && prefix.size() >= 8) {
+		// Drop the sequence number and type so that all versions of a
+		// user key fall into the same group.
+		prefix = Slice(prefix.data(), prefix.size() - 8);
+	}
+	if (prefix_length > 0 && prefix.size() > prefix_length) {
+		prefix = Slice(prefix.data(), prefix_length);
+	}
+	return prefix;
+}
+
+const char* DecodePlainTableRecord(const char* p, const char* limit,
+	Slice* key, Slice* value)
+{
+	uint32_t key_length, value_length;
+	if ((p = GetVarint32Ptr(p, limit, &key_length)) == NULL) return NULL;
+	if (static_cast<uint32_t>(limit - p) < key_length) return NULL;
+	*key = Slice(p, key_length);
+	p += key_length;
+	if ((p = GetVarint32Ptr(p, limit, &value_length)) == NULL) return NULL;
+	if (static_cast<uint32_t>(limit - p) < value_length) return NULL;
+	*value = Slice(p, value_length);
+	return p + value_length;
+}
+
+}  // namespace leveldb
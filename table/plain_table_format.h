@@ -0,0 +1,67 @@
+#ifndef STORAGE_LEVELDB_TABLE_PLAIN_TABLE_FORMAT_H_
+#define STORAGE_LEVELDB_TABLE_PLAIN_TABLE_FORMAT_H_
+
+#include <stdint.h>
+#include <string>
+#include "include/leveldb/slice.h"
+#include "include/leveldb/status.h"
+
+namespace leveldb {
+
+// A plain table file looks like:
+//
+//    [record 1]          record: varint32 key length, key,
+//    ...                         varint32 value length, value
+//    [record N]
+//    [hash index]        num_buckets fixed32 record offsets
+//    [footer]            PlainTableFooter::kEncodedLength bytes
+//
+// The records are in comparator order and are never compressed or
+// split into blocks.  Records whose keys share a prefix form a group;
+// each bucket of the hash index holds the offset of the first record of
+// one group, or kPlainTableEmptyBucket.  Collisions are resolved by
+// linear probing.  Offsets are 32 bits, so the records must fit in 4GB.
+
+static const uint64_t kPlainTableMagicNumber = 0x8242229663bf9564ull;
+
+static const uint32_t kPlainTableEmptyBucket = 0xffffffffu;
+
+// Seed for the hash of a record prefix.
+static const uint32_t kPlainTableHashSeed = 0x6b2d39a1;
+
+class PlainTableFooter {
+public:
+	enum Flags {
+		// Keys are internal keys; prefixes are taken from the user key.
+		kInternalKeys = 0x1
+	};
+
+	PlainTableFooter()
+		: index_offset(0), num_entries(0), num_buckets(0),
+		  prefix_length(0), flags(0) { }
+
+	uint64_t index_offset;      // Offset of the hash index == size of the records
+	uint64_t num_entries;
+	uint32_t num_buckets;
+	uint32_t prefix_length;     // 0: the whole (user) key is hashed
+	uint32_t flags;
+
+	void EncodeTo(std::string* dst) const;
+	Status DecodeFrom(Slice* input);
+
+	// fixed64 index_offset, fixed64 num_entries, fixed32 num_buckets,
+	// fixed32 prefix_length, fixed32 flags, fixed64 magic
+	enum { kEncodedLength = 8 + 8 + 4 + 4 + 4 + 8 };
+};
+
+// Return the part of "key" that selects its hash bucket.
+extern Slice PlainTablePrefix(const Slice& key, bool internal_keys, uint32_t prefix_length);
+
+// Parse the record at "p", which must lie before "limit".  Returns a
+// pointer just past the record, or NULL if the record is malformed.
+extern const char* DecodePlainTableRecord(const char* p, const char* limit,
+	Slice* key, Slice* value);
+
+}  // namespace leveldb
+
+#endif  // STORAGE_LEVELDB_TABLE_PLAIN_TABLE_FORMAT_H_
@@ -0,0 +1,110 @@
+#include "table/properties_block.h"
+
+#include "include/leveldb/comparator.h"
+#include "include/leveldb/iterator.h"
+#include "table/block.h"
+#include "table/block_builder.h"
+#include "util/coding.h"
+
+namespace leveldb {
+
+const char kPropertiesBlockName[] = "leveldb.properties";
+
+// Property names.  They must stay sorted because they are the keys of
+// the properties block.
+static const char kBlobSize[] = "leveldb.blob.size";
+static const char kDataSize[] = "leveldb.data.size";
+static const char kFilterSize[] = "leveldb.filter.size";
+static const char kIndexSize[] = "leveldb.index.size";
+static const char kLargestKey[] = "leveldb.largest.key";
+static const char kNumBlobReferences[] = "leveldb.num.blob.references";
+static const char kNumDataBlocks[] = "leveldb.num.data.blocks";
+static const char kNumDeletions[] = "leveldb.num.deletions";
+static const char kNumEntries[] = "leveldb.num.entries";
+static const char kPrefixExtractor[] = "leveldb.prefix.extractor";
+static const char kRangeFilterSize[] = "leveldb.range.filter.size";
+static const char kRawKeySize[] = "leveldb.raw.key.size";
+static const char kRawValueSize[] = "leveldb.raw.value.size";
+static const char kSeparatedValues[] = "leveldb.separated.values";
+static const char kSmallestKey[] = "leveldb.smallest.key";
+
+static void AddNumber(BlockBuilder* block, const char* name, uint64_t value)
+{
+	std::string encoding;
+	PutVarint64(&encoding, value);
+	block->Add(name, encoding);
+}
+
+void AddPropertiesToBlock(const TableProperties& props, BlockBuilder* block)
+{
+	assert(block->empty());
+	AddNumber(block, kBlobSize, props.blob_size);
+	AddNumber(block, kDataSize, props.data_size);
+	AddNumber(block, kFilterSize, props.filter_size);
+	AddNumber(block, kIndexSize, props.index_size);
+	block->Add(kLargestKey, props.largest_key);
+	AddNumber(block, kNumBlobReferences, props.num_blob_references);
+	AddNumber(block, kNumDataBlocks, props.num_data_blocks);
+	AddNumber(block, kNumDeletions, props.num_deletions);
+	AddNumber(block, kNumEntries, props.num_entries);
+	block->Add(kPrefixExtractor, props.prefix_extractor_name);
+	AddNumber(block, kRangeFilterSize, props.range_filter_size);
+	AddNumber(block, kRawKeySize, props.raw_key_size);
+	AddNumber(block, kRawValueSize, props.raw_value_size);
+	AddNumber(block, kSeparatedValues, props.separated_values ? 1 : 0);
+	block->Add(kSmallestKey, props.smallest_key);
+}
+
+Status ReadPropertiesFromBlock(Block* block, TableProperties* props)
+{
+	uint64_t separated_values = 0;
+	struct {
+		const char* name;
+		uint64_t* value;
+	} numbers[] = {
+		{ kBlobSize, &props->blob_size },
+		{ kDataSize, &props->data_size },
+		{ kFilterSize, &props->filter_size },
+		{ kIndexSize, &props->index_size },
+		{ kNumBlobReferences, &props->num_blob_references },
+		{ kNumDataBlocks, &props->num_data_blocks },
+		{ kNumDeletions, &props->num_deletions },
+		{ kNumEntries, &props->num_entries },
+		{ kRangeFilterSize, &props->range_filter_size },
+		{ kRawKeySize, &props->raw_key_size },
+		{ kRawValueSize, &props->raw_value_size },
+		{ kSeparatedValues, &separated_values },
+	};
+	const size_t num_numbers = sizeof(numbers) / sizeof(numbers[0]);
+
+	Status s;
+	Iterator* iter = block->NewIterator(BytewiseComparator());
+	for (iter->SeekToFirst(); s.ok() && iter->Valid(); iter->Next()) {
+		Slice name = iter->key();
+		if (name == Slice(kSmallestKey)) {
+			props->smallest_key = iter->value().ToString();
+		} else if (name == Slice(kLargestKey)) {
+			props->largest_key = iter->value().ToString();
+		} else if (name == Slice(kPrefixExtractor)) {
+			props->prefix_extractor_name = iter->value().ToString();
+		} else {
+			for (size_t i = 0; i < num_numbers; i++) {
+				if (name == Slice(numbers[i].name)) {
+					Slice v = iter->value();
+					if (!GetVarint64(&v, numbers[i].value)) {
+						s = Status::Corruption("bad table property", name);
+					}
+					break;
+				}
+			}
+		}
+	}
+	if (s.ok()) {
+		s = iter->status();
+	}
+	props->separated_values = (separated_values != 0);
+	delete iter;
+	return s;
+}
+
+}  // namespace leveldb
@@ -0,0 +1,25 @@
+#ifndef STORAGE_LEVELDB_TABLE_PROPERTIES_BLOCK_H_
+#define STORAGE_LEVELDB_TABLE_PROPERTIES_BLOCK_H_
+
+#include "include/leveldb/status.h"
+#include "include/leveldb/table_properties.h"
+
+namespace leveldb {
+
+class Block;
+class BlockBuilder;
+
+// Name of the metaindex entry that points at the properties block.
+extern const char kPropertiesBlockName[];
+
+// Add the encoding of *props to *block, one entry per property.  The
+// entries are added in sorted order, so "block" must be empty.
+extern void AddPropertiesToBlock(const TableProperties& props, BlockBuilder* block);
+
+// Parse a properties block written by AddPropertiesToBlock() into *props.
+// Properties that this code does not know about are ignored.
+extern Status ReadPropertiesFromBlock(Block* block, TableProperties* props);
+
+}  // namespace leveldb
+
+#endif  // STORAGE_LEVELDB_TABLE_PROPERTIES_BLOCK_H_
@@ -0,0 +1,229 @@
+#include "table/range_filter_block.h"
+
+#include <assert.h>
+#include "table/format.h"
+#include "util/coding.h"
+
+namespace leveldb {
+
+const char kRangeFilterBlockName[] = "rangefilter";
+
+// Bytes of every key kept past the prefix that distinguishes it.  Each
+// byte makes a false positive for a range next to a key about 256 times
+// less likely.
+static const size_t kRangeFilterSuffixBytes = 1;
+
+// Number of prefixes between restart points, which store a whole prefix.
+static const int kRangeFilterRestartInterval = 16;
+
+// A prefix is encoded as
+//    header: char          (shared << 4) | non_shared if shared < 15 and
+//                          non_shared < 16, else kLongHeader
+//    [shared: varint32]    only after kLongHeader
+//    [non_shared: varint32]
+//    bytes: char[non_shared]
+// and the block ends with the restart offsets and their number, as
+// fixed32s.
+static const unsigned char kLongHeader = 0xff;
+
+static size_t SharedPrefixLength(const Slice& a, const Slice& b)
+{
+	const size_t n = (a.size() < b.size() ? a.size() : b.size());
+	size_t i = 0;
+	while (i < n && a[i] == b[i]) {
+		i++;
+	}
+	return i;
+}
+
+RangeFilterBlockBuilder::RangeFilterBlockBuilder()
+	: counter_(0),
+	  pending_shared_(0),
+	  has_pending_(false)
+{
+}
+
+void RangeFilterBlockBuilder::AddKey(const Slice& key)
+{
+	size_t shared = 0;
+	if (has_pending_) {
+		if (key == Slice(pending_key_)) {
+			return;
+		}
+		assert(key.compare(pending_key_) > 0);
+		shared = SharedPrefixLength(pending_key_, key);
+		AddPending(shared);
+	}
+	pending_key_.assign(key.data(), key.size());
+	pending_shared_ = shared;
+	has_pending_ = true;
+}
+
+void RangeFilterBlockBuilder::AddPending(size_t next_shared)
+{
+	// The first byte past the prefixes shared with both neighbours tells
+	// the key apart from them.
+	size_t n = (pending_shared_ > next_shared ? pending_shared_ : next_shared);
+	n += 1 + kRangeFilterSuffixBytes;
+	if (n > pending_key_.size()) {
+		n = pending_key_.size();
+	}
+	Slice prefix(pending_key_.data(), n);
+
+	size_t shared = 0;
+	if (counter_ == kRangeFilterRestartInterval || restarts_.empty()) {
+		restarts_.push_back(static_cast<uint32_t>(buffer_.size()));
+		counter_ = 0;
+	} else {
+		shared = SharedPrefixLength(last_prefix_, prefix);
+	}
+	const size_t non_shared = n - shared;
+	if (shared < 15 && non_shared < 16) {
+		buffer_.push_back(static_cast<char>((shared << 4) | non_shared));
+	} else {
+		buffer_.push_back(static_cast<char>(kLongHeader));
+		PutVarint32(&buffer_, static_cast<uint32_t>(shared));
+		PutVarint32(&buffer_, static_cast<uint32_t>(non_shared));
+	}
+	buffer_.append(prefix.data() + shared, non_shared);
+	last_prefix_.assign(prefix.data(), prefix.size());
+	counter_++;
+}
+
+Slice RangeFilterBlockBuilder::Finish()
+{
+	if (has_pending_) {
+		AddPending(0);
+		has_pending_ = false;
+	}
+	for (size_t i = 0; i < restarts_.size(); i++) {
+		PutFixed32(&buffer_, restarts_[i]);
+	}
+	PutFixed32(&buffer_, static_cast<uint32_t>(restarts_.size()));
+	return Slice(buffer_);
+}
+
+// Decode the prefix at "p", which shares its first "shared" bytes with
+// *prefix, into *prefix.  Returns the position past it, or NULL if the
+// encoding runs past "limit" or does not fit *prefix.
+static const char* DecodePrefix(const char* p, const char* limit, std::string* prefix)
+{
+	if (p >= limit) return NULL;
+	const unsigned char header = static_cast<unsigned char>(*p++);
+	uint32_t shared, non_shared;
+	if (header != kLongHeader) {
+		shared = header >> 4;
+		non_shared = header & 0xf;
+	} else {
+		if ((p = GetVarint32Ptr(p, limit, &shared)) == NULL) return NULL;
+		if ((p = GetVarint32Ptr(p, limit, &non_shared)) == NULL) return NULL;
+	}
+	if (shared > prefix->size() || static_cast<uint32_t>(limit - p) < non_shared) {
+		return NULL;
+	}
+	prefix->resize(shared);
+	prefix->append(p, non_shared);
+	return p + non_shared;
+}
+
+// Point *prefix at the prefix stored at restart point "p", which shares
+// nothing with its predecessor.  Returns false if the encoding is bad.
+static bool DecodeRestartPrefix(const char* p, const char* limit, Slice* prefix)
+{
+	if (p >= limit) return false;
+	const unsigned char header = static_cast<unsigned char>(*p++);
+	uint32_t shared, non_shared;
+	if (header != kLongHeader) {
+		shared = header >> 4;
+		non_shared = header & 0xf;
+	} else {
+		if ((p = GetVarint32Ptr(p, limit, &shared)) == NULL) return false;
+		if ((p = GetVarint32Ptr(p, limit, &non_shared)) == NULL) return false;
+	}
+	if (shared != 0 || static_cast<uint32_t>(limit - p) < non_shared) {
+		return false;
+	}
+	*prefix = Slice(p, non_shared);
+	return true;
+}
+
+RangeFilterBlockReader::RangeFilterBlockReader(const BlockContents& contents)
+	: data_(contents.data.data()),
+	  size_(contents.data.size()),
+	  owned_(contents.heap_allocated),
+	  restarts_(NULL),
+	  num_restarts_(0)
+{
+	if (size_ >= sizeof(uint32_t)) {
+		num_restarts_ = DecodeFixed32(data_ + size_ - sizeof(uint32_t));
+		const size_t max_restarts = (size_ - sizeof(uint32_t)) / sizeof(uint32_t);
+		if (num_restarts_ <= max_restarts) {
+			restarts_ = data_ + size_ - (1 + num_restarts_) * sizeof(uint32_t);
+		}
+	}
+}
+
+RangeFilterBlockReader::~RangeFilterBlockReader()
+{
+	if (owned_) {
+		delete[] data_;
+	}
+}
+
+bool RangeFilterBlockReader::RangeMayMatch(const Slice& start, const Slice& limit) const
+{
+	if (start.compare(limit) >= 0) {
+		return false;
+	}
+	if (restarts_ == NULL) {
+		// Errors are treated as potential matches
+		return true;
+	}
+	if (num_restarts_ == 0) {
+		// No keys
+		return false;
+	}
+
+	// Find the last restart point whose prefix is at most "start"
+	const char* entries_limit = restarts_;
+	uint32_t left = 0;
+	uint32_t right = num_restarts_ - 1;
+	while (left < right) {
+		uint32_t mid = (left + right + 1) / 2;
+		uint32_t offset = DecodeFixed32(restarts_ + mid * sizeof(uint32_t));
+		Slice restart_prefix;
+		if (offset >= size_ || !DecodeRestartPrefix(data_ + offset, entries_limit, &restart_prefix)) {
+			return true;
+		}
+		if (restart_prefix.compare(start) <= 0) {
+			left = mid;
+		} else {
+			right = mid - 1;
+		}
+	}
+
+	// Every key extends its stored prefix.  The keys behind the first
+	// prefix at or after "start" are no smaller than that prefix, and of
+	// the prefixes before "start" only one that "start" extends can stand
+	// for a key at or after "start".
+	uint32_t offset = DecodeFixed32(restarts_ + left * sizeof(uint32_t));
+	if (offset >= size_) {
+		return true;
+	}
+	const char* p = data_ + offset;
+	std::string prefix;
+	bool previous_may_match = false;   // "start" extends the previous prefix
+	while (p < entries_limit) {
+		p = DecodePrefix(p, entries_limit, &prefix);
+		if (p == NULL) {
+			return true;
+		}
+		if (Slice(prefix).compare(start) >= 0) {
+			return previous_may_match || Slice(prefix).compare(limit) < 0;
+		}
+		previous_may_match = start.starts_with(prefix);
+	}
+	return previous_may_match;
+}
+
+}  // namespace leveldb
@@ -0,0 +1,78 @@
+#ifndef STORAGE_LEVELDB_TABLE_RANGE_FILTER_BLOCK_H_
+#define STORAGE_LEVELDB_TABLE_RANGE_FILTER_BLOCK_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "include/leveldb/slice.h"
+
+namespace leveldb {
+
+struct BlockContents;
+
+// Name of the metaindex entry that points at the range filter block.
+extern const char kRangeFilterBlockName[];
+
+// A range filter answers "may the table hold a key in [start, limit)?"
+// from memory.  Like the pruned trie of a SuRF, it keeps of every key only
+// the shortest prefix that tells it apart from its neighbours, plus one
+// byte of the real key to cut false positives.  The prefixes are front
+// coded, so the bytes that neighbouring prefixes share are stored once, as
+// in the upper levels of a trie.  Every prefix costs a one byte header and
+// the bytes it does not share with its predecessor.
+//
+// Keys must be added in increasing bytewise order; duplicates are
+// ignored.
+//
+// The sequence of calls to RangeFilterBlockBuilder must match the regexp:
+//      AddKey* Finish
+class RangeFilterBlockBuilder {
+public:
+	RangeFilterBlockBuilder();
+
+	void AddKey(const Slice& key);
+	Slice Finish();
+
+private:
+	// Add the pruned prefix of pending_key_, whose successor shares
+	// "next_shared" bytes with it.
+	void AddPending(size_t next_shared);
+
+	std::string buffer_;           // Encoded prefixes
+	std::vector<uint32_t> restarts_;
+	int counter_;                  // Prefixes added since the last restart
+	std::string last_prefix_;
+	std::string pending_key_;      // Last key added, not yet pruned
+	size_t pending_shared_;        // Bytes pending_key_ shares with its predecessor
+	bool has_pending_;
+
+	// No copying allowed
+	RangeFilterBlockBuilder(const RangeFilterBlockBuilder&);
+	void operator=(const RangeFilterBlockBuilder&);
+};
+
+class RangeFilterBlockReader {
+public:
+	// Takes ownership of the data of "contents" if it is heap allocated.
+	explicit RangeFilterBlockReader(const BlockContents& contents);
+	~RangeFilterBlockReader();
+
+	// Return false if no key added to the filter lies in [start, limit).
+	bool RangeMayMatch(const Slice& start, const Slice& limit) const;
+
+private:
+	const char* data_;
+	size_t size_;
+	bool owned_;
+	const char* restarts_;         // Restart offset array, NULL if corrupt
+	uint32_t num_restarts_;
+
+	// No copying allowed
+	RangeFilterBlockReader(const RangeFilterBlockReader&);
+	void operator=(const RangeFilterBlockReader&);
+};
+
+}  // namespace leveldb
+
+#endif  // STORAGE_LEVELDB_TABLE_RANGE_FILTER_BLOCK_H_
@@ -1,30 +1,87 @@
 #include "include/leveldb/table.h"
 
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include "include/leveldb/blob_file.h"
 #include "include/leveldb/cache.h"
 #include "include/leveldb/comparator.h"
 #include "include/leveldb/env.h"
 #include "include/leveldb/filter_policy.h"
 #include "include/leveldb/options.h"
+#include "include/leveldb/persistent_cache.h"
+#include "include/leveldb/slice_transform.h"
+#include "port/port.h"
+#include "table/blob_file_format.h"
 #include "table/block.h"
 #include "table/filter_block.h"
 #include "table/format.h"
-//#include "table/two_level_iterator.h"
+#include "table/properties_block.h"
+#include "table/range_filter_block.h"
+#include "table/two_level_iterator.h"
 #include "util/coding.h"
+#include "util/crc32c.h"
 
 namespace leveldb {
 
+namespace {
+
+// The filter of a table: one for the whole table or one per data block.
+struct TableFilter {
+	FilterBlockReader* per_block;
+	FullFilterBlockReader* whole_table;
+	const char* data;    // Owned filter block data, or NULL
+
+	// Takes ownership of the data of "block" if it is heap allocated.
+	TableFilter(const FilterPolicy* policy, const BlockContents& block, bool whole_table_filter)
+		: per_block(NULL),
+		  whole_table(NULL),
+		  data(block.heap_allocated ? block.data.data() : NULL) {
+		if (whole_table_filter) {
+			whole_table = new FullFilterBlockReader(policy, block.data);
+		} else {
+			per_block = new FilterBlockReader(policy, block.data);
+		}
+	}
+
+	~TableFilter() {
+		delete per_block;
+		delete whole_table;
+		delete[] data;
+	}
+};
+
+}  // namespace
+
 struct Table::Rep {
 	Options options;
 	Status status;
 	RandomAccessFile* file;
 	uint64_t cache_id;
-	FilterBlockBuilder* filter;
-	const char* filter_data;
+	// Names the table's blocks in options.persistent_cache: the file's
+	// unique id and size.  Empty if the persistent cache is not used.
+	std::string persistent_key_prefix;
+	TableFilter* filter;
+	bool prefix_filtered;                // Filter holds options.prefix_extractor's prefixes
+	RangeFilterBlockReader* range_filter;
 	BlockHandle metaindex_handle;
 	Block* index_block;
+	TableProperties properties;
+
+	// With options.cache_index_and_filter_blocks the block cache holds the
+	// index block and filters instead of the fields above, which are then
+	// NULL, and they are read back from these locations after eviction.
+	bool cache_meta;
+	BlockHandle index_handle;
+	BlockHandle filter_handle;
+	bool has_filter;
+	bool whole_table_filter;
+	BlockHandle range_filter_handle;
+	bool has_range_filter;
+
 	~Rep() {
 		delete filter;
-		delete[] filter_data;
+		delete range_filter;
 		delete index_block;
 	}
 };
@@ -37,10 +94,32 @@ Status Table::Open(const Options& options, RandomAccessFile* file, uint64_t size
 		return Status::Corruption("file is too short to be an sstable");
 	}
 
+	// Fetch the tail of the file with one read; the footer and usually the
+	// index, metaindex and filter blocks that precede it are all inside.
+	// A memory-mapped file is already in memory, so it is not prefetched.
+	FilePrefetchBuffer tail;
+	FilePrefetchBuffer* prefetch = NULL;
+	if (options.tail_prefetch_size > 0 && !file->ReturnsStablePointers()) {
+		size_t tail_size = options.tail_prefetch_size;
+		if (tail_size < Footer::kEncodedLength) {
+			tail_size = Footer::kEncodedLength;
+		}
+		if (tail_size > size) {
+			tail_size = static_cast<size_t>(size);
+		}
+		Status s = tail.Prefetch(file, size - tail_size, tail_size);
+		if (!s.ok()) return s;
+		prefetch = &tail;
+	}
+
 	char footer_space[Footer::kEncodedLength];
 	Slice footer_input;
-	Status s = file->Read(size - Footer::kEncodedLength, Footer::kEncodedLength, &footer_input, footer_space);
-	if (!s.ok()) return s;
+	Status s;
+	if (prefetch == NULL ||
+		!prefetch->TryRead(size - Footer::kEncodedLength, Footer::kEncodedLength, &footer_input)) {
+		s = file->Read(size - Footer::kEncodedLength, Footer::kEncodedLength, &footer_input, footer_space);
+		if (!s.ok()) return s;
+	}
 
 	Footer footer;
 	s = footer.DecodeFrom(&footer_input);
@@ -52,7 +131,7 @@ Status Table::Open(const Options& options, RandomAccessFile* file, uint64_t size
 		if (options.paranoid_checks) {
 			opt.verify_checksums = true;
 		}
-		s = ReadBlock(file,opt, footer.index_handle(), &index_block_contents);
+		s = ReadBlock(file, prefetch, opt, footer.index_handle(), &index_block_contents);
 	}
 	if (s.ok())	{
 		Block* index_block = new Block(index_block_contents);
@@ -62,43 +141,124 @@ Status Table::Open(const Options& options, RandomAccessFile* file, uint64_t size
 		rep->metaindex_handle = footer.metaindex_handle();
 		rep->index_block = index_block;
 		rep->cache_id = (options.block_cache ? options.block_cache->NewId() : 0);
-		rep->filter_data = NULL;
+		if (options.persistent_cache != NULL) {
+			char id[64];
+			const size_t id_size = file->GetUniqueId(id, sizeof(id));
+			if (id_size > 0) {
+				rep->persistent_key_prefix.assign(id, id_size);
+				PutFixed64(&rep->persistent_key_prefix, size);
+			}
+		}
 		rep->filter = NULL;
+		rep->prefix_filtered = false;
+		rep->range_filter = NULL;
+		rep->cache_meta = (options.cache_index_and_filter_blocks && options.block_cache != NULL);
+		rep->index_handle = footer.index_handle();
+		rep->has_filter = false;
+		rep->whole_table_filter = false;
+		rep->has_range_filter = false;
 		*table = new Table(rep);
-		(*table)->ReadMeta(footer);
+		(*table)->ReadMeta(footer, prefetch);
+		if (rep->cache_meta) {
+			(*table)->CacheMeta();
+		}
 	}
 
 	return s;
 }
 
-void Table::ReadMeta(const Footer& footer)
+void Table::ReadMeta(const Footer& footer, const FilePrefetchBuffer* prefetch)
 {
-	if (rep_->options.filter_policy == NULL) {
-		return;
-	}
-
+	// Errors are not propagated: the metadata only speeds up reads and
+	// describes the table, the table is usable without it.
 	ReadOptions opt;
 	if (rep_->options.paranoid_checks) {
 		opt.verify_checksums = true;
 	}
 
 	BlockContents contents;
-	if (!ReadBlock(rep_->file, opt, footer.metaindex_handle(), &contents).ok()) {
+	if (!ReadBlock(rep_->file, prefetch, opt, footer.metaindex_handle(), &contents).ok()) {
 		return;
 	}
 	Block* meta = new Block(contents);
 	Iterator* iter = meta->NewIterator(BytewiseComparator());
-	std::string key = "filter.";
-	key.append(rep_->options.filter_policy->Name());
-	iter->Seek(key);
-	if (iter->Valid() && iter->key() == Slice(key)) {
-		ReadFilter(iter->value());
+	if (rep_->options.filter_policy != NULL) {
+		std::string key = "filter.";
+		key.append(rep_->options.filter_policy->Name());
+		iter->Seek(key);
+		if (iter->Valid() && iter->key() == Slice(key)) {
+			ReadFilter(iter->value(), false, prefetch);
+		} else {
+			key = "fullfilter.";
+			key.append(rep_->options.filter_policy->Name());
+			iter->Seek(key);
+			if (iter->Valid() && iter->key() == Slice(key)) {
+				ReadFilter(iter->value(), true, prefetch);
+			}
+		}
+	}
+	iter->Seek(kPropertiesBlockName);
+	if (iter->Valid() && iter->key() == Slice(kPropertiesBlockName)) {
+		ReadProperties(iter->value(), prefetch);
+	}
+	iter->Seek(kRangeFilterBlockName);
+	if (iter->Valid() && iter->key() == Slice(kRangeFilterBlockName)) {
+		ReadRangeFilter(iter->value(), prefetch);
 	}
 	delete iter;
 	delete meta;
+
+	// Prefixes only help if the table's filter holds the ones the reader
+	// extracts.
+	const SliceTransform* extractor = rep_->options.prefix_extractor;
+	rep_->prefix_filtered = (extractor != NULL && rep_->filter != NULL &&
+		rep_->properties.prefix_extractor_name == extractor->Name());
+}
+
+void Table::ReadProperties(const Slice& properties_handle_value, const FilePrefetchBuffer* prefetch)
+{
+	Slice v = properties_handle_value;
+	BlockHandle properties_handle;
+	if (!properties_handle.DecodeFrom(&v).ok()) {
+		return;
+	}
+
+	ReadOptions opt;
+	if (rep_->options.paranoid_checks) {
+		opt.verify_checksums = true;
+	}
+	BlockContents contents;
+	if (!ReadBlock(rep_->file, prefetch, opt, properties_handle, &contents).ok()) {
+		return;
+	}
+	Block properties_block(contents);
+	TableProperties props;
+	if (ReadPropertiesFromBlock(&properties_block, &props).ok()) {
+		rep_->properties = props;
+	}
+}
+
+const TableProperties& Table::properties() const
+{
+	return rep_->properties;
 }
 
-void Table::ReadFilter(const Slice& filter_handle_value)
+bool Table::PrefixMayMatch(const Slice& prefix) const
+{
+	if (!rep_->prefix_filtered) {
+		return true;
+	}
+	MetaRef ref;
+	AcquireMeta(kFilterMeta, &ref);
+	const TableFilter* filter = reinterpret_cast<const TableFilter*>(ref.object);
+	const bool may_match = (filter == NULL || filter->whole_table == NULL ||
+		filter->whole_table->KeyMayMatch(prefix));
+	ReleaseMeta(ref);
+	return may_match;
+}
+
+void Table::ReadFilter(const Slice& filter_handle_value, bool whole_table,
+	const FilePrefetchBuffer* prefetch)
 {
 	Slice v = filter_handle_value;
 	BlockHandle filter_handle;
@@ -111,13 +271,45 @@ void Table::ReadFilter(const Slice& filter_handle_value)
 		opt.verify_checksums = true;
 	}
 	BlockContents block;
-	if (!ReadBlock(rep_->file, opt, filter_handle, &block).ok()) {
+	if (!ReadBlock(rep_->file, prefetch, opt, filter_handle, &block).ok()) {
 		return;
 	}
-	if (block.heap_allocated) {
-		rep_->filter_data = block.data.data();
+	rep_->filter = new TableFilter(rep_->options.filter_policy, block, whole_table);
+	rep_->filter_handle = filter_handle;
+	rep_->has_filter = true;
+	rep_->whole_table_filter = whole_table;
+}
+
+void Table::ReadRangeFilter(const Slice& filter_handle_value, const FilePrefetchBuffer* prefetch)
+{
+	Slice v = filter_handle_value;
+	BlockHandle filter_handle;
+	if (!filter_handle.DecodeFrom(&v).ok()) {
+		return;
 	}
-	rep_->filter = new FilterBlockBuilder(rep_->options.filter_policy, block.data);
+
+	ReadOptions opt;
+	if (rep_->options.paranoid_checks) {
+		opt.verify_checksums = true;
+	}
+	BlockContents block;
+	if (!ReadBlock(rep_->file, prefetch, opt, filter_handle, &block).ok()) {
+		return;
+	}
+	rep_->range_filter = new RangeFilterBlockReader(block);
+	rep_->range_filter_handle = filter_handle;
+	rep_->has_range_filter = true;
+}
+
+bool Table::RangeMayMatch(const Slice& start, const Slice& limit) const
+{
+	MetaRef ref;
+	AcquireMeta(kRangeFilterMeta, &ref);
+	const RangeFilterBlockReader* range_filter =
+		reinterpret_cast<const RangeFilterBlockReader*>(ref.object);
+	const bool may_match = (range_filter == NULL || range_filter->RangeMayMatch(start, limit));
+	ReleaseMeta(ref);
+	return may_match;
 }
 
 Table::~Table() {
@@ -133,10 +325,919 @@ static void DeleteCachedBlock(const Slice& key, void* value) {
 	delete block;
 }
 
+// A data block in the block cache of a table with a compressed tier
+// (Options::compressed_block_cache).  When the block cache evicts it, the
+// block moves to the tier compressed.  A block that is erased or replaced
+// by a copy under the same key is deleted; the copy is still resident.
+struct TieredBlock : public Block {
+	Cache* compressed_cache;
+
+	TieredBlock(const BlockContents& contents, Cache* cache)
+		: Block(contents),
+		  compressed_cache(cache) {
+	}
+};
+
+static void DeleteCompressedBlock(const Slice& key, void* value) {
+	delete reinterpret_cast<std::string*>(value);
+}
+
+// Evictor of a TieredBlock in the block cache.
+static void DemoteCachedBlock(const Slice& key, void* value) {
+	TieredBlock* block = static_cast<TieredBlock*>(reinterpret_cast<Block*>(value));
+	std::string* compressed = new std::string;
+	Cache::Handle* handle = NULL;
+	if (port::Snappy_Compress(block->data(), block->size(), compressed)) {
+		handle = block->compressed_cache->Insert(key, compressed, compressed->size(),
+			&DeleteCompressedBlock, Cache::kLowPriority, Cache::kDataBlock);
+	}
+	if (handle != NULL) {
+		block->compressed_cache->Release(handle);
+	} else {
+		delete compressed;
+	}
+	delete block;
+}
+
+// Look the block with the given cache key up in a compressed tier.  On a
+// hit, uncompress it into *contents and return true.
+static bool ReadCompressedBlock(Cache* compressed_cache, const Slice& key, BlockContents* contents)
+{
+	Cache::Handle* handle = compressed_cache->Lookup(key, Cache::kDataBlock);
+	if (handle == NULL) {
+		return false;
+	}
+	const std::string* compressed = reinterpret_cast<std::string*>(compressed_cache->Value(handle));
+	size_t n;
+	char* buf = NULL;
+	bool ok = port::Snappy_GetUncompressedLength(compressed->data(), compressed->size(), &n);
+	if (ok) {
+		buf = new char[n];
+		ok = port::Snappy_Uncompress(compressed->data(), compressed->size(), buf);
+	}
+	compressed_cache->Release(handle);
+	if (!ok) {
+		delete[] buf;
+		return false;
+	}
+	contents->data = Slice(buf, n);
+	contents->heap_allocated = true;
+	contents->cachable = true;
+	return true;
+}
+
+// Create a data block, one that can move to "compressed_cache" if that is
+// non-NULL.
+static Block* NewDataBlock(const BlockContents& contents, Cache* compressed_cache)
+{
+	if (compressed_cache != NULL) {
+		return new TieredBlock(contents, compressed_cache);
+	}
+	return new Block(contents);
+}
+
+// Insert a block made by NewDataBlock() into the block cache.
+static Cache::Handle* InsertDataBlock(Cache* block_cache, Cache* compressed_cache,
+	const Slice& key, Block* block)
+{
+	return block_cache->Insert(key, block, block->size(), &DeleteCachedBlock,
+		Cache::kLowPriority, Cache::kDataBlock,
+		(compressed_cache != NULL ? &DemoteCachedBlock : NULL));
+}
+
+static void DeleteCachedFilter(const Slice& key, void* value) {
+	delete reinterpret_cast<TableFilter*>(value);
+}
+
+static void DeleteCachedRangeFilter(const Slice& key, void* value) {
+	delete reinterpret_cast<RangeFilterBlockReader*>(value);
+}
+
 static void ReleaseBlock(void* arg, void* h) {
 	Cache* cache = reinterpret_cast<Cache*>(arg);
 	Cache::Handle* handle = reinterpret_cast<Cache::Handle*>(h);
 	cache->Release(handle);
 }
 
+static void EncodeBlockCacheKey(uint64_t cache_id, const BlockHandle& handle, char* buf)
+{
+	EncodeFixed64(buf, cache_id);
+	EncodeFixed64(buf + 8, handle.offset());
+}
+
+void Table::CacheMeta()
+{
+	Cache* block_cache = rep_->options.block_cache;
+	char cache_key_buffer[16];
+	Slice key(cache_key_buffer, sizeof(cache_key_buffer));
+	if (rep_->index_block != NULL) {
+		EncodeBlockCacheKey(rep_->cache_id, rep_->index_handle, cache_key_buffer);
+		Cache::Handle* handle = block_cache->Insert(key, rep_->index_block,
+			rep_->index_block->size(), &DeleteCachedBlock, Cache::kHighPriority,
+			Cache::kIndexBlock);
+		if (handle != NULL) {
+			block_cache->Release(handle);
+			rep_->index_block = NULL;
+		}
+	}
+	if (rep_->filter != NULL) {
+		EncodeBlockCacheKey(rep_->cache_id, rep_->filter_handle, cache_key_buffer);
+		Cache::Handle* handle = block_cache->Insert(key, rep_->filter,
+			static_cast<size_t>(rep_->filter_handle.size()), &DeleteCachedFilter,
+			Cache::kHighPriority, Cache::kFilterBlock);
+		if (handle != NULL) {
+			block_cache->Release(handle);
+			rep_->filter = NULL;
+		}
+	}
+	if (rep_->range_filter != NULL) {
+		EncodeBlockCacheKey(rep_->cache_id, rep_->range_filter_handle, cache_key_buffer);
+		Cache::Handle* handle = block_cache->Insert(key, rep_->range_filter,
+			static_cast<size_t>(rep_->range_filter_handle.size()), &DeleteCachedRangeFilter,
+			Cache::kHighPriority, Cache::kFilterBlock);
+		if (handle != NULL) {
+			block_cache->Release(handle);
+			rep_->range_filter = NULL;
+		}
+	}
+}
+
+Status Table::AcquireMeta(MetaKind kind, MetaRef* ref) const
+{
+	ref->object = NULL;
+	ref->handle = NULL;
+	ref->deleter = NULL;
+
+	BlockHandle handle;
+	switch (kind) {
+	case kIndexMeta:
+		ref->object = rep_->index_block;
+		handle = rep_->index_handle;
+		break;
+	case kFilterMeta:
+		if (!rep_->has_filter) return Status::OK();
+		ref->object = rep_->filter;
+		handle = rep_->filter_handle;
+		break;
+	case kRangeFilterMeta:
+		if (!rep_->has_range_filter) return Status::OK();
+		ref->object = rep_->range_filter;
+		handle = rep_->range_filter_handle;
+		break;
+	}
+	if (ref->object != NULL || !rep_->cache_meta) {
+		return Status::OK();
+	}
+
+	Cache* block_cache = rep_->options.block_cache;
+	char cache_key_buffer[16];
+	EncodeBlockCacheKey(rep_->cache_id, handle, cache_key_buffer);
+	Slice key(cache_key_buffer, sizeof(cache_key_buffer));
+	const Cache::EntryRole role = (kind == kIndexMeta ? Cache::kIndexBlock : Cache::kFilterBlock);
+	ref->handle = block_cache->Lookup(key, role);
+	if (ref->handle != NULL) {
+		ref->object = block_cache->Value(ref->handle);
+		return Status::OK();
+	}
+
+	// Evicted: read it back.  A filter that cannot be read is treated as
+	// missing, like when the table was opened.
+	ReadOptions opt;
+	if (rep_->options.paranoid_checks) {
+		opt.verify_checksums = true;
+	}
+	BlockContents contents;
+	Status s = FetchBlock(opt, handle, &contents);
+	if (!s.ok()) {
+		return (kind == kIndexMeta ? s : Status::OK());
+	}
+	size_t charge = contents.data.size();
+	switch (kind) {
+	case kIndexMeta:
+		{
+			Block* block = new Block(contents);
+			charge = block->size();
+			ref->object = block;
+			ref->deleter = &DeleteCachedBlock;
+			break;
+		}
+	case kFilterMeta:
+		ref->object = new TableFilter(rep_->options.filter_policy, contents,
+			rep_->whole_table_filter);
+		ref->deleter = &DeleteCachedFilter;
+		break;
+	case kRangeFilterMeta:
+		ref->object = new RangeFilterBlockReader(contents);
+		ref->deleter = &DeleteCachedRangeFilter;
+		break;
+	}
+	ref->handle = block_cache->Insert(key, ref->object, charge, ref->deleter,
+		Cache::kHighPriority, role);
+	if (ref->handle != NULL) {
+		ref->deleter = NULL;
+	}
+	return Status::OK();
+}
+
+void Table::ReleaseMeta(const MetaRef& ref) const
+{
+	if (ref.handle != NULL) {
+		rep_->options.block_cache->Release(ref.handle);
+	} else if (ref.deleter != NULL) {
+		(*ref.deleter)(Slice(), ref.object);
+	}
+}
+
+Iterator* Table::NewIndexIterator() const
+{
+	MetaRef ref;
+	Status s = AcquireMeta(kIndexMeta, &ref);
+	if (!s.ok()) {
+		return NewErrorIterator(s);
+	}
+	Iterator* iter = reinterpret_cast<Block*>(ref.object)->NewIterator(rep_->options.comparator);
+	if (ref.handle != NULL) {
+		iter->RegisterCleanup(&ReleaseBlock, rep_->options.block_cache, ref.handle);
+	} else if (ref.deleter != NULL) {
+		iter->RegisterCleanup(&DeleteBlock, ref.object, NULL);
+	}
+	return iter;
+}
+
+// Key of the block at "handle" in Options::persistent_cache.
+static std::string PersistentCacheKey(const std::string& prefix, const BlockHandle& handle)
+{
+	std::string key = prefix;
+	PutVarint64(&key, handle.offset());
+	return key;
+}
+
+Status Table::FetchBlock(const ReadOptions& options, const BlockHandle& handle,
+	BlockContents* contents) const
+{
+	if (ReadPersistentBlock(handle, contents)) {
+		return Status::OK();
+	}
+	Status s = ReadBlock(rep_->file, options, handle, contents);
+	if (s.ok() && options.fill_cache) {
+		FillPersistentCache(handle, *contents);
+	}
+	return s;
+}
+
+// A block in the persistent cache is its uncompressed contents followed
+// by their length and their masked crc32c, as fixed32s.
+static const size_t kPersistentTrailerSize = 8;
+
+bool Table::ReadPersistentBlock(const BlockHandle& handle, BlockContents* contents) const
+{
+	if (rep_->persistent_key_prefix.empty()) {
+		return false;
+	}
+	std::string data;
+	Status s = rep_->options.persistent_cache->Lookup(
+		PersistentCacheKey(rep_->persistent_key_prefix, handle), &data);
+	if (!s.ok() || data.size() < kPersistentTrailerSize) {
+		return false;
+	}
+	const size_t n = data.size() - kPersistentTrailerSize;
+	if (DecodeFixed32(&data[n]) != n ||
+		crc32c::Unmask(DecodeFixed32(&data[n + 4])) != crc32c::Value(data.data(), n)) {
+		return false;
+	}
+	char* buf = new char[n];
+	memcpy(buf, data.data(), n);
+	contents->data = Slice(buf, n);
+	contents->heap_allocated = true;
+	contents->cachable = true;
+	return true;
+}
+
+void Table::FillPersistentCache(const BlockHandle& handle, const BlockContents& contents) const
+{
+	if (!rep_->persistent_key_prefix.empty()) {
+		std::string data(contents.data.data(), contents.data.size());
+		PutFixed32(&data, static_cast<uint32_t>(contents.data.size()));
+		PutFixed32(&data, crc32c::Mask(crc32c::Value(contents.data.data(),
+			contents.data.size())));
+		// Errors only mean the block is not cached
+		rep_->options.persistent_cache->Insert(
+			PersistentCacheKey(rep_->persistent_key_prefix, handle), data);
+	}
+}
+
+// Convert an index iterator value (i.e., an encoded BlockHandle)
+// into an iterator over the contents of the corresponding block.
+Iterator* Table::BlockReader(void* arg, const ReadOptions& options, const Slice& index_value)
+{
+	Table* table = reinterpret_cast<Table*>(arg);
+	Cache* block_cache = table->rep_->options.block_cache;
+	Block* block = NULL;
+	Cache::Handle* cache_handle = NULL;
+
+	BlockHandle handle;
+	Slice input = index_value;
+	Status s = handle.DecodeFrom(&input);
+	// We intentionally allow extra stuff in index_value so that we
+	// can add more features in the future.
+
+	if (s.ok()) {
+		BlockContents contents;
+		if (block_cache != NULL) {
+			char cache_key_buffer[16];
+			EncodeBlockCacheKey(table->rep_->cache_id, handle, cache_key_buffer);
+			Slice key(cache_key_buffer, sizeof(cache_key_buffer));
+			cache_handle = block_cache->Lookup(key, Cache::kDataBlock);
+			if (cache_handle != NULL) {
+				block = reinterpret_cast<Block*>(block_cache->Value(cache_handle));
+			} else {
+				Cache* compressed_cache = table->rep_->options.compressed_block_cache;
+				const bool from_tier = (compressed_cache != NULL &&
+					ReadCompressedBlock(compressed_cache, key, &contents));
+				if (!from_tier) {
+					s = table->FetchBlock(options, handle, &contents);
+				}
+				if (s.ok()) {
+					block = NewDataBlock(contents, compressed_cache);
+					if (contents.cachable && options.fill_cache) {
+						cache_handle = InsertDataBlock(block_cache, compressed_cache, key, block);
+						if (cache_handle != NULL && from_tier) {
+							// Moved back up
+							compressed_cache->Erase(key);
+						}
+					}
+				}
+			}
+		} else {
+			s = table->FetchBlock(options, handle, &contents);
+			if (s.ok()) {
+				block = new Block(contents);
+			}
+		}
+	}
+
+	Iterator* iter;
+	if (block != NULL) {
+		iter = block->NewIterator(table->rep_->options.comparator);
+		if (cache_handle == NULL) {
+			iter->RegisterCleanup(&DeleteBlock, block, NULL);
+		} else {
+			iter->RegisterCleanup(&ReleaseBlock, block_cache, cache_handle);
+		}
+	} else {
+		iter = NewErrorIterator(s);
+	}
+	return iter;
+}
+
+// Iterator for ReadOptions::prefix_seek.  A Seek() to a target in the
+// domain of the prefix extractor consults the filters before any data
+// block is read: the whole-table filter for the table, or the filter of
+// each block as the iteration reaches it.  Keys that share a prefix are
+// adjacent, so once a block past the target has no key with the prefix
+// the remaining blocks cannot have any either.
+class Table::PrefixIterator : public Iterator {
+public:
+	PrefixIterator(const Table* table, const ReadOptions& options)
+		: table_(table),
+		  in_prefix_(false),
+		  rejected_(false),
+		  first_block_(false) {
+		table->AcquireMeta(kFilterMeta, &filter_);
+		iter_ = NewTwoLevelIterator(table->NewIndexIterator(),
+			&Table::PrefixBlockReader, this, options);
+	}
+
+	virtual ~PrefixIterator() {
+		delete iter_;
+		table_->ReleaseMeta(filter_);
+	}
+
+	virtual bool Valid() const {
+		return !rejected_ && iter_->Valid() &&
+			(!in_prefix_ || iter_->key().starts_with(prefix_));
+	}
+
+	virtual void Seek(const Slice& target) {
+		const SliceTransform* extractor = table_->rep_->options.prefix_extractor;
+		in_prefix_ = extractor->InDomain(target);
+		rejected_ = false;
+		if (in_prefix_) {
+			Slice prefix = extractor->Transform(target);
+			prefix_.assign(prefix.data(), prefix.size());
+			const TableFilter* filter = reinterpret_cast<const TableFilter*>(filter_.object);
+			if (table_->rep_->prefix_filtered && filter != NULL && filter->whole_table != NULL &&
+				!filter->whole_table->KeyMayMatch(prefix)) {
+				rejected_ = true;
+				return;
+			}
+		}
+		first_block_ = true;
+		iter_->Seek(target);
+	}
+
+	virtual void SeekToFirst() {
+		in_prefix_ = false;
+		rejected_ = false;
+		iter_->SeekToFirst();
+	}
+
+	virtual void SeekToLast() {
+		in_prefix_ = false;
+		rejected_ = false;
+		iter_->SeekToLast();
+	}
+
+	virtual void Next() {
+		assert(Valid());
+		iter_->Next();
+	}
+
+	virtual void Prev() {
+		assert(Valid());
+		iter_->Prev();
+	}
+
+	virtual Slice key() const {
+		assert(Valid());
+		return iter_->key();
+	}
+
+	virtual Slice value() const {
+		assert(Valid());
+		return iter_->value();
+	}
+
+	virtual Status status() const {
+		return iter_->status();
+	}
+
+private:
+	friend class Table;
+
+	const Table* table_;
+	MetaRef filter_;     // Pinned for the iterator's lifetime
+	Iterator* iter_;
+	std::string prefix_;
+	bool in_prefix_;     // Last Seek() target had a prefix
+	bool rejected_;      // The whole-table filter ruled the prefix out
+	bool first_block_;   // No block has been read since the last Seek()
+};
+
+Iterator* Table::PrefixBlockReader(void* arg, const ReadOptions& options, const Slice& index_value)
+{
+	PrefixIterator* iter = reinterpret_cast<PrefixIterator*>(arg);
+	const TableFilter* filter = reinterpret_cast<const TableFilter*>(iter->filter_.object);
+	if (iter->in_prefix_ && iter->table_->rep_->prefix_filtered &&
+		filter != NULL && filter->per_block != NULL) {
+		bool first_block = iter->first_block_;
+		iter->first_block_ = false;
+		BlockHandle handle;
+		Slice input = index_value;
+		if (handle.DecodeFrom(&input).ok() &&
+			!filter->per_block->KeyMayMatch(handle.offset(), iter->prefix_)) {
+			// The block a Seek() lands on may hold only keys before the
+			// target, so the keys with the prefix can still start in the
+			// next block.  Any later block ends the prefix.
+			return first_block ? NewEmptyIterator() : NULL;
+		}
+	}
+	return BlockReader(const_cast<Table*>(iter->table_), options, index_value);
+}
+
+// Wraps the iterator of a table with separated values and yields the
+// values the stored ones represent.
+class Table::BlobValueIterator : public Iterator {
+public:
+	BlobValueIterator(const Table* table, const ReadOptions& options, Iterator* iter)
+		: table_(table),
+		  options_(options),
+		  iter_(iter) {
+	}
+
+	virtual ~BlobValueIterator() {
+		delete iter_;
+	}
+
+	virtual bool Valid() const { return iter_->Valid(); }
+	virtual void Seek(const Slice& target) { iter_->Seek(target); }
+	virtual void SeekToFirst() { iter_->SeekToFirst(); }
+	virtual void SeekToLast() { iter_->SeekToLast(); }
+	virtual void Next() { iter_->Next(); }
+	virtual void Prev() { iter_->Prev(); }
+	virtual Slice key() const { return iter_->key(); }
+
+	virtual Slice value() const {
+		Slice value;
+		Status s = table_->ResolveValue(options_, iter_->value(), &blob_, &value);
+		if (!s.ok()) {
+			if (status_.ok()) status_ = s;
+			return Slice();
+		}
+		return value;
+	}
+
+	virtual Status status() const {
+		Status s = iter_->status();
+		return s.ok() ? status_ : s;
+	}
+
+private:
+	const Table* table_;
+	const ReadOptions options_;
+	Iterator* iter_;
+	mutable std::string blob_;   // Value read from a blob file
+	mutable Status status_;      // First error resolving a value
+};
+
+Iterator* Table::NewIterator(const ReadOptions& options) const
+{
+	Iterator* iter;
+	if (options.prefix_seek && rep_->options.prefix_extractor != NULL) {
+		iter = new PrefixIterator(this, options);
+	} else {
+		iter = NewTwoLevelIterator(NewIndexIterator(),
+			&Table::BlockReader, const_cast<Table*>(this), options);
+	}
+	if (rep_->properties.separated_values) {
+		iter = new BlobValueIterator(this, options, iter);
+	}
+	return iter;
+}
+
+Status Table::InternalGet(const ReadOptions& options, const Slice& k, void* arg,
+	void (*saver)(void*, const Slice&, const Slice&))
+{
+	MetaRef filter_ref;
+	AcquireMeta(kFilterMeta, &filter_ref);
+	const TableFilter* filter = reinterpret_cast<const TableFilter*>(filter_ref.object);
+	if (filter != NULL && filter->whole_table != NULL && !filter->whole_table->KeyMayMatch(k)) {
+		// Not found, and the index was never touched
+		ReleaseMeta(filter_ref);
+		return Status::OK();
+	}
+
+	Status s;
+	Iterator* iiter = NewIndexIterator();
+	iiter->Seek(k);
+	if (iiter->Valid()) {
+		Slice handle_value = iiter->value();
+		BlockHandle handle;
+		if (filter != NULL && filter->per_block != NULL &&
+			handle.DecodeFrom(&handle_value).ok() &&
+			!filter->per_block->KeyMayMatch(handle.offset(), k)) {
+			// Not found
+		} else {
+			Iterator* block_iter = BlockReader(this, options, iiter->value());
+			block_iter->Seek(k);
+			if (block_iter->Valid()) {
+				std::string blob;
+				Slice value;
+				s = ResolveValue(options, block_iter->value(), &blob, &value);
+				if (s.ok()) {
+					(*saver)(arg, block_iter->key(), value);
+				}
+			}
+			if (s.ok()) {
+				s = block_iter->status();
+			}
+			delete block_iter;
+		}
+	}
+	if (s.ok()) {
+		s = iiter->status();
+	}
+	delete iiter;
+	ReleaseMeta(filter_ref);
+	return s;
+}
+
+namespace {
+
+// Orders positions in a key array by the table comparator.
+struct KeyIndexOrder {
+	const Comparator* comparator;
+	const Slice* keys;
+
+	bool operator()(int a, int b) const {
+		return comparator->Compare(keys[a], keys[b]) < 0;
+	}
+};
+
+// The keys of a MultiGet() batch that fall into one data block.
+struct BlockRequest {
+	BlockHandle handle;
+	size_t first;                 // [first, limit) is the range of the
+	size_t limit;                 // batch's surviving keys in this block
+	BlockContents contents;
+	Block* block;
+	Cache::Handle* cache_handle;
+};
+
+}  // namespace
+
+// Upper bound on the size of one coalesced read of adjacent blocks.
+static const size_t kMaxCoalescedReadSize = 256 * 1024;
+
+Status Table::MultiGet(const ReadOptions& options, const Slice* keys, int n, void* arg,
+	void (*handle_result)(void* arg, int index, const Slice& k, const Slice& v))
+{
+	const Comparator* comparator = rep_->options.comparator;
+
+	std::vector<int> order(n);
+	for (int i = 0; i < n; i++) {
+		order[i] = i;
+	}
+	KeyIndexOrder key_order;
+	key_order.comparator = comparator;
+	key_order.keys = keys;
+	std::sort(order.begin(), order.end(), key_order);
+
+	std::vector<Slice> sorted_keys(n);
+	for (int i = 0; i < n; i++) {
+		sorted_keys[i] = keys[order[i]];
+	}
+	MetaRef filter_ref;
+	AcquireMeta(kFilterMeta, &filter_ref);
+	const TableFilter* filter = reinterpret_cast<const TableFilter*>(filter_ref.object);
+	bool* may_match = new bool[n > 0 ? n : 1];
+	if (filter != NULL && filter->whole_table != NULL && n > 0) {
+		filter->whole_table->KeysMayMatch(&sorted_keys[0], n, may_match);
+	} else {
+		std::fill(may_match, may_match + n, true);
+	}
+
+	// Map every key that may be present to its data block.  The keys are
+	// sorted, so keys sharing a block are adjacent and the index only has
+	// to be searched again once a key moves past the current block.
+	Status s;
+	std::vector<int> candidates;          // Positions in sorted_keys
+	std::vector<BlockHandle> handles;     // Block of each candidate
+	Iterator* iiter = NewIndexIterator();
+	for (int i = 0; i < n; i++) {
+		if (!may_match[i]) {
+			continue;
+		}
+		const Slice& k = sorted_keys[i];
+		if (!iiter->Valid() || comparator->Compare(iiter->key(), k) < 0) {
+			iiter->Seek(k);
+			if (!iiter->Valid()) {
+				// This key and all larger ones are past the last block
+				break;
+			}
+		}
+
+		Slice handle_value = iiter->value();
+		BlockHandle handle;
+		s = handle.DecodeFrom(&handle_value);
+		if (!s.ok()) {
+			break;
+		}
+		candidates.push_back(i);
+		handles.push_back(handle);
+	}
+	if (s.ok()) {
+		s = iiter->status();
+	}
+	delete iiter;
+
+	// Probe the block filters of all candidates at once, then group the
+	// survivors by block.
+	const int num_candidates = static_cast<int>(candidates.size());
+	if (filter != NULL && filter->per_block != NULL && num_candidates > 0) {
+		std::vector<uint64_t> offsets(num_candidates);
+		std::vector<Slice> candidate_keys(num_candidates);
+		for (int i = 0; i < num_candidates; i++) {
+			offsets[i] = handles[i].offset();
+			candidate_keys[i] = sorted_keys[candidates[i]];
+		}
+		filter->per_block->KeysMayMatch(&offsets[0], &candidate_keys[0], num_candidates, may_match);
+	} else {
+		std::fill(may_match, may_match + num_candidates, true);
+	}
+
+	std::vector<int> survivors;
+	std::vector<BlockRequest> requests;
+	for (int i = 0; s.ok() && i < num_candidates; i++) {
+		if (!may_match[i]) {
+			continue;
+		}
+		if (requests.empty() || requests.back().handle.offset() != handles[i].offset()) {
+			BlockRequest r;
+			r.handle = handles[i];
+			r.first = survivors.size();
+			r.block = NULL;
+			r.cache_handle = NULL;
+			requests.push_back(r);
+		}
+		survivors.push_back(order[candidates[i]]);
+		requests.back().limit = survivors.size();
+	}
+	delete[] may_match;
+	ReleaseMeta(filter_ref);
+
+	Cache* block_cache = rep_->options.block_cache;
+	char cache_key_buffer[16];
+	if (s.ok() && block_cache != NULL) {
+		for (size_t i = 0; i < requests.size(); i++) {
+			EncodeBlockCacheKey(rep_->cache_id, requests[i].handle, cache_key_buffer);
+			requests[i].cache_handle = block_cache->Lookup(
+				Slice(cache_key_buffer, sizeof(cache_key_buffer)), Cache::kDataBlock);
+			if (requests[i].cache_handle != NULL) {
+				requests[i].block = reinterpret_cast<Block*>(
+					block_cache->Value(requests[i].cache_handle));
+			}
+		}
+	}
+
+	// Blocks in the compressed tier move back up to the block cache
+	Cache* compressed_cache = (block_cache != NULL ? rep_->options.compressed_block_cache : NULL);
+	if (s.ok() && compressed_cache != NULL) {
+		for (size_t i = 0; i < requests.size(); i++) {
+			BlockRequest* r = &requests[i];
+			if (r->block != NULL) {
+				continue;
+			}
+			EncodeBlockCacheKey(rep_->cache_id, r->handle, cache_key_buffer);
+			Slice key(cache_key_buffer, sizeof(cache_key_buffer));
+			if (!ReadCompressedBlock(compressed_cache, key, &r->contents)) {
+				continue;
+			}
+			r->block = NewDataBlock(r->contents, compressed_cache);
+			if (options.fill_cache) {
+				r->cache_handle = InsertDataBlock(block_cache, compressed_cache, key, r->block);
+				if (r->cache_handle != NULL) {
+					compressed_cache->Erase(key);
+				}
+			}
+		}
+	}
+
+	// Then the persistent cache
+	if (s.ok() && !rep_->persistent_key_prefix.empty()) {
+		for (size_t i = 0; i < requests.size(); i++) {
+			BlockRequest* r = &requests[i];
+			if (r->block != NULL || !ReadPersistentBlock(r->handle, &r->contents)) {
+				continue;
+			}
+			r->block = NewDataBlock(r->contents, compressed_cache);
+			if (block_cache != NULL && options.fill_cache) {
+				EncodeBlockCacheKey(rep_->cache_id, r->handle, cache_key_buffer);
+				r->cache_handle = InsertDataBlock(block_cache, compressed_cache,
+					Slice(cache_key_buffer, sizeof(cache_key_buffer)), r->block);
+			}
+		}
+	}
+
+	// Read the blocks that missed the caches.  Runs of physically adjacent
+	// blocks are fetched with one read and then split up, unless the file
+	// hands out stable pointers, in which case every block is used in place.
+	const bool coalesce = !rep_->file->ReturnsStablePointers();
+	size_t i = 0;
+	while (s.ok() && i < requests.size()) {
+		if (requests[i].block != NULL) {
+			i++;
+			continue;
+		}
+
+		const uint64_t run_start = requests[i].handle.offset();
+		uint64_t run_end = run_start + requests[i].handle.size() + kBlockTrailerSize;
+		size_t j = i + 1;
+		while (coalesce &&
+			j < requests.size() &&
+			requests[j].block == NULL &&
+			requests[j].handle.offset() == run_end &&
+			run_end + requests[j].handle.size() + kBlockTrailerSize - run_start <= kMaxCoalescedReadSize) {
+			run_end += requests[j].handle.size() + kBlockTrailerSize;
+			j++;
+		}
+
+		if (j == i + 1) {
+			s = ReadBlock(rep_->file, options, requests[i].handle, &requests[i].contents);
+			if (s.ok()) {
+				requests[i].block = NewDataBlock(requests[i].contents, compressed_cache);
+			}
+		} else {
+			const size_t run_size = static_cast<size_t>(run_end - run_start);
+			char* buf = new char[run_size];
+			Slice raw;
+			s = rep_->file->Read(run_start, run_size, &raw, buf);
+			if (s.ok() && raw.size() != run_size) {
+				s = Status::Corruption("truncated block read");
+			}
+			for (size_t k = i; s.ok() && k < j; k++) {
+				const BlockHandle& handle = requests[k].handle;
+				Slice block_raw(raw.data() + (handle.offset() - run_start),
+					static_cast<size_t>(handle.size()) + kBlockTrailerSize);
+				s = DecodeBlock(options, handle, block_raw, &requests[k].contents);
+				if (s.ok()) {
+					requests[k].block = NewDataBlock(requests[k].contents, compressed_cache);
+				}
+			}
+			delete[] buf;
+		}
+
+		for (size_t k = i; k < j; k++) {
+			BlockRequest* r = &requests[k];
+			if (r->block != NULL && options.fill_cache) {
+				FillPersistentCache(r->handle, r->contents);
+			}
+			if (r->block != NULL && block_cache != NULL &&
+				r->contents.cachable && options.fill_cache) {
+				EncodeBlockCacheKey(rep_->cache_id, r->handle, cache_key_buffer);
+				r->cache_handle = InsertDataBlock(block_cache, compressed_cache,
+					Slice(cache_key_buffer, sizeof(cache_key_buffer)), r->block);
+			}
+		}
+		i = j;
+	}
+
+	for (i = 0; i < requests.size(); i++) {
+		BlockRequest* r = &requests[i];
+		if (r->block == NULL) {
+			continue;
+		}
+		if (s.ok()) {
+			Iterator* block_iter = r->block->NewIterator(comparator);
+			std::string blob;
+			Slice value;
+			for (size_t k = r->first; s.ok() && k < r->limit; k++) {
+				block_iter->Seek(keys[survivors[k]]);
+				if (block_iter->Valid()) {
+					s = ResolveValue(options, block_iter->value(), &blob, &value);
+					if (s.ok()) {
+						(*handle_result)(arg, survivors[k], block_iter->key(), value);
+					}
+				}
+			}
+			if (s.ok()) {
+				s = block_iter->status();
+			}
+			delete block_iter;
+		}
+		if (r->cache_handle != NULL) {
+			block_cache->Release(r->cache_handle);
+		} else {
+			delete r->block;
+		}
+	}
+	return s;
+}
+
+Status Table::ResolveValue(const ReadOptions& options, const Slice& stored,
+	std::string* blob, Slice* value) const
+{
+	if (!rep_->properties.separated_values) {
+		*value = stored;
+		return Status::OK();
+	}
+	if (!stored.empty() && stored[0] == static_cast<char>(kInlineValue)) {
+		*value = Slice(stored.data() + 1, stored.size() - 1);
+		return Status::OK();
+	}
+
+	Slice input = stored;
+	uint64_t file_number;
+	BlockHandle handle;
+	Status s = DecodeBlobReference(&input, &file_number, &handle);
+	if (!s.ok()) return s;
+	BlobFileSet* blob_files = rep_->options.blob_files;
+	BlobFileReader* reader = (blob_files != NULL ? blob_files->Find(file_number) : NULL);
+	if (reader == NULL) {
+		return Status::Corruption("value refers to an unknown blob file");
+	}
+	s = reader->Get(options, handle, blob);
+	if (s.ok()) {
+		*value = *blob;
+	}
+	return s;
+}
+
+uint64_t Table::ApproximateOffsetOf(const Slice& key) const
+{
+	Iterator* index_iter = NewIndexIterator();
+	index_iter->Seek(key);
+	uint64_t result;
+	if (index_iter->Valid()) {
+		BlockHandle handle;
+		Slice input = index_iter->value();
+		Status s = handle.DecodeFrom(&input);
+		if (s.ok()) {
+			result = handle.offset();
+		} else {
+			// Strange: we can't decode the block handle in the index block.
+			// We'll just return the offset of the metaindex block, which is
+			// close to the whole file size for this case.
+			result = rep_->metaindex_handle.offset();
+		}
+	} else {
+		// key is past the last key in the file.  Approximate the offset
+		// by returning the offset of the metaindex block (which is
+		// right near the end of the file).
+		result = rep_->metaindex_handle.offset();
+	}
+	delete index_iter;
+	return result;
+}
+
 }
\ No newline at end of file
@@ -1,9 +1,20 @@
 #include <assert.h>
+#include <string.h>
 #include "include/leveldb/table_builder.h"
+#include "include/leveldb/blob_file.h"
+#include "include/leveldb/comparator.h"
 #include "include/leveldb/env.h"
+#include "include/leveldb/filter_policy.h"
+#include "include/leveldb/slice_transform.h"
+#include "include/leveldb/table_properties.h"
+#include "db/dbformat.h"
+#include "port/port.h"
+#include "table/blob_file_format.h"
 #include "table/block_builder.h"
 #include "table/filter_block.h"
 #include "table/format.h"
+#include "table/properties_block.h"
+#include "table/range_filter_block.h"
 #include "util/coding.h"
 #include "util/crc32c.h"
 
@@ -23,12 +34,18 @@ struct TableBuilder::Rep
 	uint64_t num_entries;        //ǰdata blockĸʼ0  
 	bool closed;                 //Finish() or Abandon()ʼfalse
 	FilterBlockBuilder* filter_block; //filterݿٶλkeyǷblock  
+	FullFilterBlockBuilder* full_filter_block; //sstableһfilter
+	RangeFilterBlockBuilder* range_filter_block; //ΧNULLʾ
 	bool pending_index_entry;         //data_blockǷǷindexblock
 	BlockHandle pending_handle;  // Handle to add to index block
+	TableProperties props;       //ͳϢFinishʱдproperties block
+	bool internal_keys;          //keyǷΪinternal keyͳɾ
+	BlobFileBuilder* blob_file;  //valueдblobļNULLʾ
+	std::string tagged_value;    //tagblobúvalue
 
 	std::string compressed_output;
 
-	Rep(const Options& opt, WritableFile* f)
+	Rep(const Options& opt, WritableFile* f, BlobFileBuilder* b)
 		: options(opt),
 		index_block_options(opt),
 		file(f),
@@ -37,15 +54,33 @@ struct TableBuilder::Rep
 		index_block(&index_block_options),
 		num_entries(0),
 		closed(false),
-		filter_block(opt.filter_policy == NULL ? NULL
-		: new FilterBlockBuilder(opt.filter_policy)),
-		pending_index_entry(false) {
+		filter_block(opt.filter_policy == NULL || opt.whole_table_filter ? NULL
+		: new FilterBlockBuilder(opt.filter_policy, opt.prefix_extractor)),
+		full_filter_block(opt.filter_policy == NULL || !opt.whole_table_filter ? NULL
+		: new FullFilterBlockBuilder(opt.filter_policy, opt.prefix_extractor)),
+		range_filter_block(opt.range_filter ? new RangeFilterBlockBuilder : NULL),
+		pending_index_entry(false),
+		internal_keys(strcmp(opt.comparator->Name(), "leveldb.InternalKeyComparator") == 0),
+		blob_file(b) {
 			index_block_options.block_restart_interval = 1;
+			props.separated_values = (b != NULL);
+			if (opt.filter_policy != NULL && opt.prefix_extractor != NULL) {
+				props.prefix_extractor_name = opt.prefix_extractor->Name();
+			}
 	}
 };
 
 TableBuilder::TableBuilder(const Options& options, WritableFile* file)
-	: rep_( new Rep(options, file))
+	: rep_( new Rep(options, file, NULL))
+{
+	if (rep_->filter_block != NULL)
+	{
+		rep_->filter_block->StartBlock(0);
+	}
+}
+
+TableBuilder::TableBuilder(const Options& options, WritableFile* file, BlobFileBuilder* blob_file)
+	: rep_( new Rep(options, file, blob_file))
 {
 	if (rep_->filter_block != NULL)
 	{
@@ -57,6 +92,8 @@ TableBuilder::~TableBuilder()
 {
 	assert(rep_->closed);
 	delete rep_->filter_block;
+	delete rep_->full_filter_block;
+	delete rep_->range_filter_block;
 	delete rep_;
 }
 
@@ -67,6 +104,15 @@ Status TableBuilder::ChangeOptions(const Options& options) {
 	if (options.comparator != rep_->options.comparator) {
 		return Status::InvalidArgument("changing comparator while building table");
 	}
+	if (options.whole_table_filter != rep_->options.whole_table_filter) {
+		return Status::InvalidArgument("changing whole_table_filter while building table");
+	}
+	if (options.prefix_extractor != rep_->options.prefix_extractor) {
+		return Status::InvalidArgument("changing prefix_extractor while building table");
+	}
+	if (options.range_filter != rep_->options.range_filter) {
+		return Status::InvalidArgument("changing range_filter while building table");
+	}
 
 	// Note that any live BlockBuilders point to rep_->options and therefore
 	// will automatically pick up the updated options.
@@ -100,10 +146,52 @@ void TableBuilder::Add(const Slice& key, const Slice& value)
 	{
 		r->filter_block->AddKey(key);
 	}
+	if (r->full_filter_block != NULL)
+	{
+		r->full_filter_block->AddKey(key);
+	}
+	if (r->range_filter_block != NULL)
+	{
+		r->range_filter_block->AddKey(r->internal_keys ? ExtractUserKey(key) : key);
+	}
+
+	if (r->num_entries == 0)
+	{
+		r->props.smallest_key.assign(key.data(), key.size());
+	}
+	if (r->internal_keys && key.size() >= 8 && ExtractValueType(key) == kTypeDeletion)
+	{
+		r->props.num_deletions++;
+	}
+	r->props.raw_key_size += key.size();
+	r->props.raw_value_size += value.size();
 
 	r->last_key.assign(key.data(), key.size());
 	r->num_entries++;
-	r->data_block.Add(key, value);
+	if (r->blob_file == NULL)
+	{
+		r->data_block.Add(key, value);
+	}
+	else
+	{
+		//valueдblobļtableֻ
+		r->tagged_value.clear();
+		if (r->options.min_blob_size > 0 && value.size() >= r->options.min_blob_size)
+		{
+			BlockHandle blob_handle;
+			r->status = r->blob_file->Add(value, &blob_handle);
+			if (!ok()) return;
+			EncodeBlobReference(r->blob_file->file_number(), blob_handle, &r->tagged_value);
+			r->props.num_blob_references++;
+			r->props.blob_size += value.size();
+		}
+		else
+		{
+			r->tagged_value.push_back(static_cast<char>(kInlineValue));
+			r->tagged_value.append(value.data(), value.size());
+		}
+		r->data_block.Add(key, r->tagged_value);
+	}
 
 	const size_t estimated_block_size = r->data_block.CurrentSizeEstimate();
 	if (estimated_block_size >= r->options.block_size)
@@ -122,8 +210,9 @@ void TableBuilder::Flush()
 	WriteBlock(&r->data_block, &r->pending_handle);
 	if (ok())
 	{
+		r->props.num_data_blocks++;
+		r->props.data_size = r->offset;
 		r->pending_index_entry = true;
-		r->status = r->file->Flush();
 	}
 
 	if (r->filter_block != NULL)
@@ -148,7 +237,6 @@ void TableBuilder::WriteBlock(BlockBuilder* block, BlockHandle* handle)
 
 	case kSnappyCompression: 
 		{
-			/*
 			std::string* compressed = &r->compressed_output;
 			if (port::Snappy_Compress(raw.data(), raw.size(), compressed) &&
 				compressed->size() < raw.size() - (raw.size() / 8u)) {
@@ -158,13 +246,13 @@ void TableBuilder::WriteBlock(BlockBuilder* block, BlockHandle* handle)
 				// store uncompressed form
 				block_contents = raw;
 				type = kNoCompression;
-			}*/
-			block_contents = raw;
+			}
 			break;
 		}
 	}
 
 	WriteRawBlock(block_contents, type, handle);
+	r->compressed_output.clear();
 	block->Reset();
 }
 
@@ -199,12 +287,47 @@ Status TableBuilder::Finish()
 	Flush();
 	assert(!r->closed);
 	r->closed = true;
+	r->props.num_entries = r->num_entries;
+	r->props.largest_key = r->last_key;
 
 	//write filter block
 	BlockHandle filter_block_handle, metaindex_block_handle, index_block_handle;
+	BlockHandle properties_block_handle;
 	if (ok() && r->filter_block != NULL)
 	{
 		WriteRawBlock(r->filter_block->Finish(), kNoCompression, &filter_block_handle);
+		r->props.filter_size = filter_block_handle.size();
+	}
+	if (ok() && r->full_filter_block != NULL)
+	{
+		WriteRawBlock(r->full_filter_block->Finish(), kNoCompression, &filter_block_handle);
+		r->props.filter_size = filter_block_handle.size();
+	}
+	BlockHandle range_filter_block_handle;
+	if (ok() && r->range_filter_block != NULL)
+	{
+		WriteRawBlock(r->range_filter_block->Finish(), kNoCompression, &range_filter_block_handle);
+		r->props.range_filter_size = range_filter_block_handle.size();
+	}
+
+	//the index block is written last, so shorten its final key now to
+	//know the size of the index block that goes into the properties
+	if (ok() && r->pending_index_entry)
+	{
+		r->options.comparator->FindShortSuccessor(&r->last_key);
+		std::string handle_encoding;
+		r->pending_handle.EncodeTo(&handle_encoding);
+		r->index_block.Add(r->last_key, Slice(handle_encoding));
+		r->pending_index_entry = false;
+	}
+
+	//write properties block
+	if (ok())
+	{
+		r->props.index_size = r->index_block.CurrentSizeEstimate();
+		BlockBuilder properties_block(&r->options);
+		AddPropertiesToBlock(r->props, &properties_block);
+		WriteBlock(&properties_block, &properties_block_handle);
 	}
 
 	if (ok())
@@ -219,23 +342,47 @@ Status TableBuilder::Finish()
 			filter_block_handle.EncodeTo(&handle_encoding);
 			meta_index_block.Add(key, handle_encoding);
 		}
+		if (r->full_filter_block != NULL)
+		{
+			std::string key = "fullfilter.";
+			key.append(r->options.filter_policy->Name());
+			std::string handle_encoding;
+			filter_block_handle.EncodeTo(&handle_encoding);
+			meta_index_block.Add(key, handle_encoding);
+		}
+		std::string handle_encoding;
+		properties_block_handle.EncodeTo(&handle_encoding);
+		meta_index_block.Add(kPropertiesBlockName, handle_encoding);
+		if (r->range_filter_block != NULL)
+		{
+			handle_encoding.clear();
+			range_filter_block_handle.EncodeTo(&handle_encoding);
+			meta_index_block.Add(kRangeFilterBlockName, handle_encoding);
+		}
 		WriteBlock(&meta_index_block, &metaindex_block_handle);
 	}
 
 	if (ok())
 	{
 		//write index block
-		if (r->pending_index_entry)
-		{
-			r->options.comparator->FindShortestSeparator(&r->last_key);
-			std::string handle_encoding;
-			r->pending_handle.EncodeTo(&handle_encoding);
-			r->index_block.Add(r->last_key, Slice(handle_encoding));
-			r->pending_index_entry = false;
-		}
 		WriteBlock(&r->index_block, &index_block_handle);
 	}
 
+	if (ok())
+	{
+		//write footer
+		Footer footer;
+		footer.set_metaindex_handle(metaindex_block_handle);
+		footer.set_index_handle(index_block_handle);
+		std::string footer_encoding;
+		footer.EncodeTo(&footer_encoding);
+		r->status = r->file->Append(footer_encoding);
+		if (r->status.ok())
+		{
+			r->offset += footer_encoding.size();
+		}
+	}
+	return r->status;
 }
 
 void TableBuilder::Abandon() {
@@ -0,0 +1,69 @@
+#include <assert.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "include/leveldb/env.h"
+#include "include/leveldb/filter_policy.h"
+#include "include/leveldb/slice.h"
+#include "util/coding.h"
+
+using namespace leveldb;
+
+static std::string FuseKey(int i)
+{
+	char buffer[8];
+	EncodeFixed32(buffer, i);
+	EncodeFixed32(buffer + 4, i * 0x9e3779b9u);
+	return std::string(buffer, 8);
+}
+
+// Build filters over sets of "set_size" keys and report the space per key
+// and the false positive rate.
+static void MeasureFilter(const char* label, const FilterPolicy* policy,
+	int set_size, int num_sets)
+{
+	const int kProbesPerSet = 1000000 / num_sets;
+	Env* env = Env::Default();
+	size_t filter_bytes = 0;
+	int false_positives = 0;
+	uint64_t build_micros = 0;
+	for (int set = 0; set < num_sets; set++) {
+		std::vector<std::string> key_storage;
+		for (int i = 0; i < set_size; i++) {
+			key_storage.push_back(FuseKey(set * set_size + i));
+		}
+		std::vector<Slice> keys(key_storage.begin(), key_storage.end());
+		std::string filter;
+		const uint64_t start = env->NowMicros();
+		policy->CreateFilter(&keys[0], set_size, &filter);
+		build_micros += env->NowMicros() - start;
+		filter_bytes += filter.size();
+
+		for (int i = 0; i < set_size; i++) {
+			assert(policy->KeyMayMatch(keys[i], filter));
+		}
+		for (int i = 0; i < kProbesPerSet; i++) {
+			false_positives += policy->KeyMayMatch(FuseKey(-1 - i), filter);
+		}
+	}
+	const double total_keys = double(set_size) * num_sets;
+	std::cout << label << ", " << set_size << " keys/filter: "
+		<< filter_bytes * 8.0 / total_keys << " bits/key, "
+		<< 100.0 * false_positives / (double(kProbesPerSet) * num_sets) << "% false positives, "
+		<< total_keys / build_micros << " M keys/s build" << std::endl;
+}
+
+// Space and accuracy of the binary fuse filter next to a 10 bits per key
+// bloom filter, for one large filter and for many filters of the size a
+// table builds per 2KB of data.
+void BinaryFuseFilterTest()
+{
+	const FilterPolicy* bloom = NewBloomFilterPolicy(10);
+	const FilterPolicy* fuse = NewBinaryFuseFilterPolicy(7);
+	MeasureFilter("bloom 10 bits/key ", bloom, 1000000, 1);
+	MeasureFilter("binary fuse 7 bits", fuse, 1000000, 1);
+	MeasureFilter("bloom 10 bits/key ", bloom, 100, 1000);
+	MeasureFilter("binary fuse 7 bits", fuse, 100, 1000);
+	delete bloom;
+	delete fuse;
+}
@@ -0,0 +1,104 @@
+#include <assert.h>
+#include <stdio.h>
+#include <iostream>
+#include <vector>
+#include "include/leveldb/blob_file.h"
+#include "include/leveldb/options.h"
+#include "include/leveldb/table.h"
+#include "include/leveldb/table_builder.h"
+#include "test/testutil.h"
+#include "util/random.h"
+
+using namespace leveldb;
+
+static std::string MakeBlobKey(int i)
+{
+	char buf[32];
+	snprintf(buf, sizeof(buf), "key%08d", i);
+	return std::string(buf);
+}
+
+// Every 4th value is small, the others are 8-64KB.
+static std::string MakeBlobValue(int i)
+{
+	size_t size = (i % 4 == 0 ? 100 : 8 * 1024 + (i * 7919) % (56 * 1024));
+	return std::string(size, static_cast<char>('a' + i % 26));
+}
+
+struct BlobGetState {
+	int found;
+	int mismatches;
+};
+
+static void CheckBlobGetResult(void* arg, int index, const Slice& k, const Slice& v)
+{
+	BlobGetState* state = reinterpret_cast<BlobGetState*>(arg);
+	state->found++;
+	if (v != Slice(MakeBlobValue(index))) {
+		state->mismatches++;
+	}
+}
+
+// Compares the size of a table holding large values inline with one whose
+// large values live in a blob file.  The table is what every compaction
+// rewrites, the blob file is written once.
+void BlobFileTest()
+{
+	const int kNumEntries = 2000;
+
+	Options options;
+	options.compression = kNoCompression;
+	options.min_blob_size = 4096;
+
+	test::StringSink inline_sink;
+	TableBuilder inline_builder(options, &inline_sink);
+	test::StringSink table_sink;
+	test::StringSink blob_sink;
+	BlobFileBuilder blob_builder(options, &blob_sink, 7);
+	TableBuilder builder(options, &table_sink, &blob_builder);
+	for (int i = 0; i < kNumEntries; i++) {
+		inline_builder.Add(MakeBlobKey(i), MakeBlobValue(i));
+		builder.Add(MakeBlobKey(i), MakeBlobValue(i));
+	}
+	Status s = inline_builder.Finish();
+	assert(s.ok());
+	s = builder.Finish();
+	assert(s.ok());
+	s = blob_builder.Finish();
+	assert(s.ok());
+
+	test::StringSource blob_source(blob_sink.contents());
+	BlobFileReader* blob_reader = NULL;
+	s = BlobFileReader::Open(options, &blob_source, 7, blob_source.Size(), &blob_reader);
+	assert(s.ok());
+	BlobFileSet blob_files;
+	blob_files.Add(blob_reader);
+	options.blob_files = &blob_files;
+
+	test::StringSource table_source(table_sink.contents());
+	Table* table = NULL;
+	s = Table::Open(options, &table_source, table_source.Size(), &table);
+	assert(s.ok());
+	assert(table->properties().separated_values);
+	assert(table->properties().num_blob_references == blob_reader->NumBlobs());
+
+	std::vector<std::string> keys;
+	for (int i = 0; i < kNumEntries; i++) {
+		keys.push_back(MakeBlobKey(i));
+	}
+	std::vector<Slice> key_slices(keys.begin(), keys.end());
+	BlobGetState state;
+	state.found = 0;
+	state.mismatches = 0;
+	s = table->MultiGet(ReadOptions(), &key_slices[0], kNumEntries, &state, CheckBlobGetResult);
+	assert(s.ok());
+	assert(state.found == kNumEntries);
+	assert(state.mismatches == 0);
+
+	std::cout << "inline values:    table " << inline_sink.contents().size() << " bytes" << std::endl;
+	std::cout << "separated values: table " << table_sink.contents().size() << " bytes, blob file "
+		<< blob_sink.contents().size() << " bytes, "
+		<< table->properties().num_blob_references << " blobs" << std::endl;
+
+	delete table;
+}
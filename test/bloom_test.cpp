@@ -0,0 +1,83 @@
+#include <assert.h>
+#include <stdio.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "include/leveldb/env.h"
+#include "include/leveldb/filter_policy.h"
+#include "include/leveldb/slice.h"
+#include "util/coding.h"
+
+using namespace leveldb;
+
+static Slice BloomKey(int i, char* buffer)
+{
+	EncodeFixed32(buffer, i);
+	EncodeFixed32(buffer + 4, i * 0x9e3779b9u);
+	return Slice(buffer, 8);
+}
+
+// Build rate, probe latency (one at a time and batched) and false
+// positive rate of the bloom filter policy at a few sizes.
+void BloomFilterTest()
+{
+	const int kNumKeys = 1000000;
+	const int kNumProbes = 1000000;
+	const int kBitsPerKey[] = { 6, 10, 16 };
+	Env* env = Env::Default();
+
+	std::vector<std::string> key_storage(kNumKeys);
+	std::vector<Slice> keys(kNumKeys);
+	char buffer[8];
+	for (int i = 0; i < kNumKeys; i++) {
+		key_storage[i] = BloomKey(i, buffer).ToString();
+		keys[i] = key_storage[i];
+	}
+
+	for (size_t b = 0; b < sizeof(kBitsPerKey) / sizeof(kBitsPerKey[0]); b++) {
+		const FilterPolicy* policy = NewBloomFilterPolicy(kBitsPerKey[b]);
+		std::string filter;
+		uint64_t start = env->NowMicros();
+		policy->CreateFilter(&keys[0], kNumKeys, &filter);
+		const double build_micros = double(env->NowMicros() - start);
+
+		start = env->NowMicros();
+		int found = 0;
+		for (int i = 0; i < kNumProbes; i++) {
+			found += policy->KeyMayMatch(keys[i % kNumKeys], filter);
+		}
+		const double hit_micros = double(env->NowMicros() - start);
+		assert(found == kNumProbes);
+
+		// The same probes in batches, which overlap their cache misses
+		const int kBatch = 64;
+		std::vector<Slice> filters(kBatch, Slice(filter));
+		bool results[kBatch];
+		start = env->NowMicros();
+		found = 0;
+		for (int i = 0; i < kNumProbes; i += kBatch) {
+			policy->KeysMayMatch(&keys[i % kNumKeys], &filters[0], kBatch, results);
+			for (int j = 0; j < kBatch; j++) {
+				found += results[j];
+			}
+		}
+		const double batch_micros = double(env->NowMicros() - start);
+		assert(found == kNumProbes);
+
+		start = env->NowMicros();
+		int false_positives = 0;
+		for (int i = 0; i < kNumProbes; i++) {
+			false_positives += policy->KeyMayMatch(BloomKey(kNumKeys + i, buffer), filter);
+		}
+		const double miss_micros = double(env->NowMicros() - start);
+
+		std::cout << kBitsPerKey[b] << " bits/key: "
+			<< kNumKeys / build_micros << " M keys/s build, "
+			<< hit_micros * 1000 / kNumProbes << " ns/hit, "
+			<< batch_micros * 1000 / kNumProbes << " ns/hit batched, "
+			<< miss_micros * 1000 / kNumProbes << " ns/miss, "
+			<< 100.0 * false_positives / kNumProbes << "% false positives, "
+			<< filter.size() * 8.0 / kNumKeys << " bits/key used" << std::endl;
+		delete policy;
+	}
+}
@@ -0,0 +1,149 @@
+#include <assert.h>
+#include <stdio.h>
+#include <iostream>
+#include "include/leveldb/cache.h"
+#include "include/leveldb/filter_policy.h"
+#include "include/leveldb/options.h"
+#include "include/leveldb/table.h"
+#include "include/leveldb/table_builder.h"
+#include "test/testutil.h"
+
+using namespace leveldb;
+
+static void ScanTable(Table* table)
+{
+	Iterator* iter = table->NewIterator(ReadOptions());
+	for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+	}
+	assert(iter->status().ok());
+	delete iter;
+}
+
+// High-priority entries against a flood of low-priority ones, inserts
+// under a strict capacity limit, and the index and filter blocks of a
+// table kept in the block cache while scans pass through it.
+void CachePriorityTest()
+{
+	// Without a high-priority pool priorities make no difference; with
+	// one, the high-priority entries survive the scan-like flood
+	const double kRatios[] = { 0.0, 0.5 };
+	for (int r = 0; r < 2; r++) {
+		Cache* cache = NewLRUCache(1600, kRatios[r]);
+		for (int i = 0; i < 100; i++) {
+			cache->Release(cache->Insert(test::EncodeCacheKey(i), NULL, 1,
+				&test::CountingCacheDeleter, Cache::kHighPriority));
+		}
+		for (int i = 1000; i < 100000; i++) {
+			cache->Release(cache->Insert(test::EncodeCacheKey(i), NULL, 1,
+				&test::CountingCacheDeleter));
+		}
+		int survivors = 0;
+		for (int i = 0; i < 100; i++) {
+			survivors += (test::CacheLookup(cache, i) != -1);
+		}
+		assert(survivors == (kRatios[r] > 0 ? 100 : 0));
+		assert(cache->TotalCharge() <= 1600);
+		delete cache;
+	}
+
+	// A strict limit refuses entries once pinned ones fill a shard, and
+	// leaves the refused values to the caller
+	for (int strict = 0; strict < 2; strict++) {
+		Cache* caches[] = { NewLRUCache(160, 0.0, strict != 0),
+			NewClockCache(160, 1, strict != 0) };
+		for (int c = 0; c < 2; c++) {
+			Cache* cache = caches[c];
+			Cache::Handle* handles[400];
+			int refused = 0;
+			const uint64_t deleted_before = test::DeletedCacheEntries()->Load();
+			for (int i = 0; i < 400; i++) {
+				handles[i] = cache->Insert(test::EncodeCacheKey(i), NULL, 1,
+					&test::CountingCacheDeleter);
+				refused += (handles[i] == NULL);
+			}
+			if (strict) {
+				assert(refused > 0);
+				assert(cache->TotalCharge() <= 160);
+			} else {
+				assert(refused == 0);
+			}
+			assert(test::DeletedCacheEntries()->Load() == deleted_before);
+			for (int i = 0; i < 400; i++) {
+				if (handles[i] != NULL) {
+					cache->Release(handles[i]);
+				}
+			}
+			delete cache;
+		}
+	}
+
+	Options options;
+	options.compression = kNoCompression;
+	options.filter_policy = NewBloomFilterPolicy(10);
+	options.whole_table_filter = true;
+	std::string value(100, 'v');
+	test::StringSink sink;
+	TableBuilder builder(options, &sink);
+	for (int i = 0; i < 5000; i++) {
+		char key[16];
+		snprintf(key, sizeof(key), "key%06d", 2 * i);
+		builder.Add(key, value);
+	}
+	Status s = builder.Finish();
+	assert(s.ok());
+
+	// A scan streams twice the cache capacity through it.  The lookup of
+	// an absent key after it needs the index and the filter: with a
+	// high-priority pool both are still cached.
+	const char* labels[] = { "no high-priority pool: ", "high-priority pool:    " };
+	const double kTableRatios[] = { 0.0, 0.75 };
+	for (int r = 0; r < 2; r++) {
+		Cache* cache = NewLRUCache(256 * 1024, kTableRatios[r]);
+		options.block_cache = cache;
+		options.cache_index_and_filter_blocks = true;
+		test::StringSource source(sink.contents());
+		Table* table = NULL;
+		s = Table::Open(options, &source, source.Size(), &table);
+		assert(s.ok());
+		assert(cache->TotalCharge() > 0);
+
+		ScanTable(table);
+		source.ResetCounters();
+		Slice absent("key000001");
+		int found = 0;
+		s = table->MultiGet(ReadOptions(), &absent, 1, &found, &test::CountFound);
+		assert(s.ok() && found == 0);
+		const uint64_t reads = source.reads();
+		if (kTableRatios[r] > 0) {
+			assert(reads == 0);
+		} else {
+			assert(reads > 0);
+		}
+
+		// Evicted or not, the blocks serve lookups
+		Slice present("key000002");
+		s = table->MultiGet(ReadOptions(), &present, 1, &found, &test::CountFound);
+		assert(s.ok() && found == 1);
+		std::cout << labels[r] << reads << " reads for a filtered lookup after a scan" << std::endl;
+		delete table;
+		delete cache;
+	}
+
+	// A table keeps the blocks a full strict cache turns away
+	Cache* cache = NewLRUCache(16, 0.0, true);
+	options.block_cache = cache;
+	test::StringSource source(sink.contents());
+	Table* table = NULL;
+	s = Table::Open(options, &source, source.Size(), &table);
+	assert(s.ok());
+	assert(cache->TotalCharge() == 0);
+	ScanTable(table);
+	source.ResetCounters();
+	Slice absent("key000001");
+	int found = 0;
+	s = table->MultiGet(ReadOptions(), &absent, 1, &found, &test::CountFound);
+	assert(s.ok() && found == 0 && source.reads() == 0);
+	delete table;
+	delete cache;
+	delete options.filter_policy;
+}
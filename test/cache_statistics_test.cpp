@@ -0,0 +1,111 @@
+#include <assert.h>
+#include <stdio.h>
+#include <iostream>
+#include "include/leveldb/cache.h"
+#include "include/leveldb/filter_policy.h"
+#include "include/leveldb/options.h"
+#include "include/leveldb/table.h"
+#include "include/leveldb/table_builder.h"
+#include "test/testutil.h"
+#include "util/random.h"
+
+using namespace leveldb;
+
+// Counters of every cache implementation by entry role, then the
+// statistics of a block cache that serves a table's data, index and
+// filter blocks.
+void CacheStatisticsTest()
+{
+	Cache* caches[] = { NewLRUCache(1000), NewTinyLFUCache(1000, 10), NewClockCache(1000, 10) };
+	for (int c = 0; c < 3; c++) {
+		Cache* cache = caches[c];
+		Cache::Statistics stats;
+		cache->GetStatistics(&stats);
+		for (int r = 0; r < Cache::kNumEntryRoles; r++) {
+			assert(stats.lookups[r] == 0 && stats.bytes[r] == 0);
+		}
+
+		// 100 data blocks that fit, then 1000 that push them out
+		for (int i = 0; i < 1100; i++) {
+			Cache::Handle* h = cache->Lookup(test::EncodeCacheKey(i), Cache::kDataBlock);
+			assert(h == NULL);
+			cache->Release(cache->Insert(test::EncodeCacheKey(i), NULL, 10,
+				&test::NoopCacheDeleter, Cache::kLowPriority, Cache::kDataBlock));
+		}
+		Cache::Handle* h = cache->Insert(test::EncodeCacheKey(5000), NULL, 30,
+			&test::NoopCacheDeleter, Cache::kHighPriority, Cache::kFilterBlock);
+		assert(cache->Lookup(test::EncodeCacheKey(5000), Cache::kFilterBlock) == h);
+		cache->Release(h);
+		cache->Release(h);
+		assert(cache->Lookup(test::EncodeCacheKey(6000)) == NULL);
+
+		cache->GetStatistics(&stats);
+		assert(stats.lookups[Cache::kDataBlock] == 1100 && stats.hits[Cache::kDataBlock] == 0);
+		assert(stats.inserts[Cache::kDataBlock] == 1100);
+		assert(stats.evictions[Cache::kDataBlock] >= 1100 - 100);
+		assert(stats.lookups[Cache::kFilterBlock] == 1 && stats.hits[Cache::kFilterBlock] == 1);
+		assert(stats.inserts[Cache::kFilterBlock] == 1 && stats.bytes[Cache::kFilterBlock] == 30);
+		assert(stats.lookups[Cache::kOtherEntry] == 1 && stats.hits[Cache::kOtherEntry] == 0);
+		assert(stats.lookups[Cache::kIndexBlock] == 0);
+		assert(stats.bytes[Cache::kDataBlock] + stats.bytes[Cache::kFilterBlock] ==
+			cache->TotalCharge());
+
+		// Erasing is no eviction
+		const uint64_t evictions = stats.evictions[Cache::kFilterBlock];
+		cache->Erase(test::EncodeCacheKey(5000));
+		cache->GetStatistics(&stats);
+		assert(stats.bytes[Cache::kFilterBlock] == 0 &&
+			stats.evictions[Cache::kFilterBlock] == evictions);
+		delete cache;
+	}
+
+	// A block cache too small for a table's data blocks, with the index
+	// and filter blocks in it
+	Options options;
+	options.compression = kNoCompression;
+	options.filter_policy = NewBloomFilterPolicy(10);
+	test::StringSink sink;
+	TableBuilder builder(options, &sink);
+	const int kNumKeys = 20000;
+	for (int i = 0; i < kNumKeys; i++) {
+		char key[16];
+		snprintf(key, sizeof(key), "key%06d", 2 * i);
+		builder.Add(key, std::string(100, 'v'));
+	}
+	Status s = builder.Finish();
+	assert(s.ok());
+
+	Cache* cache = NewLRUCache(sink.contents().size() / 4, 0.5);
+	options.block_cache = cache;
+	options.cache_index_and_filter_blocks = true;
+	test::StringSource source(sink.contents());
+	Table* table = NULL;
+	s = Table::Open(options, &source, source.Size(), &table);
+	assert(s.ok());
+	Random rnd(301);
+	for (int i = 0; i < 20000; i++) {
+		char key[16];
+		snprintf(key, sizeof(key), "key%06d", static_cast<int>(rnd.Uniform(2 * kNumKeys)));
+		Slice k(key);
+		int found = 0;
+		s = table->MultiGet(ReadOptions(), &k, 1, &found, &test::CountFound);
+		assert(s.ok());
+	}
+	Cache::Statistics stats;
+	cache->GetStatistics(&stats);
+	const char* names[] = { "data:   ", "index:  ", "filter: ", "other:  " };
+	for (int r = 0; r < Cache::kNumEntryRoles; r++) {
+		std::cout << names[r] << stats.lookups[r] << " lookups, " << stats.hits[r] << " hits, "
+			<< stats.inserts[r] << " inserts, " << stats.evictions[r] << " evictions, "
+			<< stats.bytes[r] << " bytes" << std::endl;
+	}
+	// Data blocks thrash, the high-priority index and filter mostly stay
+	assert(stats.evictions[Cache::kDataBlock] > 0);
+	assert(stats.lookups[Cache::kFilterBlock] == 20000);
+	assert(stats.hits[Cache::kIndexBlock] * 10 > stats.lookups[Cache::kIndexBlock] * 9);
+	assert(stats.hits[Cache::kFilterBlock] * 10 > stats.lookups[Cache::kFilterBlock] * 9);
+	assert(stats.hits[Cache::kDataBlock] * 2 < stats.lookups[Cache::kDataBlock]);
+	delete table;
+	delete cache;
+	delete options.filter_policy;
+}
@@ -0,0 +1,66 @@
+#include <assert.h>
+#include <stdio.h>
+#include <iostream>
+#include "include/leveldb/cache.h"
+#include "test/testutil.h"
+#include "util/random.h"
+
+using namespace leveldb;
+
+// Looks up random keys, inserting the ones that miss, as a reader thread
+// using a block cache does.
+static void CacheBenchThread(test::CacheThreadState* state)
+{
+	Random rnd(state->seed);
+	for (int i = 0; i < state->num_ops; i++) {
+		test::CacheAccess(state->cache, rnd.Uniform(state->num_keys));
+	}
+}
+
+// Behaviour of the LRU cache, then lookup/insert throughput of a shared
+// cache against the number of threads using it.
+void CacheTest()
+{
+	const int kCacheSize = 1000;
+	Cache* cache = NewLRUCache(kCacheSize);
+	test::DeletedCacheEntries()->Store(0);
+
+	assert(test::CacheLookup(cache, 100) == -1);
+	test::CacheInsert(cache, 100, 101);
+	assert(test::CacheLookup(cache, 100) == 101);
+	test::CacheInsert(cache, 100, 102);
+	assert(test::CacheLookup(cache, 100) == 102);
+	assert(test::DeletedCacheEntries()->Load() == 1);
+	cache->Erase(test::EncodeCacheKey(100));
+	assert(test::CacheLookup(cache, 100) == -1);
+	assert(test::DeletedCacheEntries()->Load() == 2);
+
+	// A pinned entry survives the eviction of everything else
+	Cache::Handle* pinned = cache->Insert(test::EncodeCacheKey(7), test::EncodeCacheValue(8), 1,
+		&test::CountingCacheDeleter);
+	for (int i = 1000; i < 1000 + 10 * kCacheSize; i++) {
+		test::CacheInsert(cache, i, i);
+	}
+	assert(test::DecodeCacheValue(cache->Value(pinned)) == 8);
+	assert(test::CacheLookup(cache, 7) == 8);
+	assert(test::CacheLookup(cache, 1000) == -1);
+	assert(test::CacheLookup(cache, 1000 + 10 * kCacheSize - 1) == 1000 + 10 * kCacheSize - 1);
+	cache->Release(pinned);
+	// The capacity is split evenly over 16 shards, rounding up
+	assert(cache->TotalCharge() <= kCacheSize + 16);
+	cache->Prune();
+	assert(cache->TotalCharge() == 0);
+	delete cache;
+
+	const int kOpsPerThread = 1000000;
+	const int kNumKeys = 100000;
+	const int kThreads[] = { 1, 2, 4, 8 };
+	for (size_t t = 0; t < sizeof(kThreads) / sizeof(kThreads[0]); t++) {
+		cache = NewLRUCache(kNumKeys / 2);
+		const double micros = double(test::RunCacheThreads(cache, kThreads[t], kOpsPerThread,
+			kNumKeys, &CacheBenchThread));
+		std::cout << kThreads[t] << " threads: "
+			<< kThreads[t] * kOpsPerThread / micros << " M ops/s" << std::endl;
+		delete cache;
+	}
+}
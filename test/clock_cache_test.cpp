@@ -0,0 +1,129 @@
+#include <assert.h>
+#include <stdio.h>
+#include <iostream>
+#include "include/leveldb/cache.h"
+#include "test/testutil.h"
+#include "util/random.h"
+
+using namespace leveldb;
+
+// Looks up random keys that are all cached.
+static void ClockBenchThread(test::CacheThreadState* state)
+{
+	Random rnd(state->seed);
+	for (int i = 0; i < state->num_ops; i++) {
+		Cache::Handle* handle = state->cache->Lookup(
+			test::EncodeCacheKey(rnd.Uniform(state->num_keys)));
+		assert(handle != NULL);
+		state->cache->Release(handle);
+	}
+}
+
+// Inserts random keys that other threads insert too.
+static void ClockRacingInsertThread(test::CacheThreadState* state)
+{
+	Random rnd(state->seed);
+	for (int i = 0; i < state->num_ops; i++) {
+		test::CacheInsert(state->cache, rnd.Uniform(state->num_keys), i);
+	}
+}
+
+// Hit-path throughput of "cache" for "threads" concurrent readers.
+static double ClockBenchHits(Cache* cache, int threads, int num_keys, int ops_per_thread)
+{
+	for (int k = 0; k < num_keys; k++) {
+		cache->Release(cache->Insert(test::EncodeCacheKey(k), NULL, 1, &test::NoopCacheDeleter));
+	}
+	return double(threads) * ops_per_thread /
+		test::RunCacheThreads(cache, threads, ops_per_thread, num_keys, &ClockBenchThread);
+}
+
+// Behaviour of the CLOCK cache, also under racing inserts of a key, then its hit throughput against the LRU
+// cache with many reader threads.
+void ClockCacheTest()
+{
+	const int kCacheSize = 1000;
+	Cache* cache = NewClockCache(kCacheSize, 1);
+	test::DeletedCacheEntries()->Store(0);
+
+	assert(test::CacheLookup(cache, 100) == -1);
+	test::CacheInsert(cache, 100, 101);
+	assert(test::CacheLookup(cache, 100) == 101);
+	test::CacheInsert(cache, 100, 102);
+	assert(test::CacheLookup(cache, 100) == 102);
+	assert(test::DeletedCacheEntries()->Load() == 1);
+	cache->Erase(test::EncodeCacheKey(100));
+	assert(test::CacheLookup(cache, 100) == -1);
+	assert(test::DeletedCacheEntries()->Load() == 2);
+
+	// An erased entry stays valid until its handle is released
+	Cache::Handle* h = cache->Insert(test::EncodeCacheKey(5), NULL, 1, &test::CountingCacheDeleter);
+	cache->Erase(test::EncodeCacheKey(5));
+	assert(test::DeletedCacheEntries()->Load() == 2);
+	assert(test::CacheLookup(cache, 5) == -1);
+	cache->Release(h);
+	assert(test::DeletedCacheEntries()->Load() == 3);
+
+	// A pinned entry survives the eviction of everything else
+	Cache::Handle* pinned = cache->Insert(test::EncodeCacheKey(7),
+		test::EncodeCacheValue(8), 1, &test::CountingCacheDeleter);
+	for (int i = 1000; i < 1000 + 10 * kCacheSize; i++) {
+		test::CacheInsert(cache, i, i);
+	}
+	assert(test::DecodeCacheValue(cache->Value(pinned)) == 8);
+	assert(test::CacheLookup(cache, 7) == 8);
+	assert(test::CacheLookup(cache, 1000) == -1);
+	assert(test::CacheLookup(cache, 1000 + 10 * kCacheSize - 1) == 1000 + 10 * kCacheSize - 1);
+	cache->Release(pinned);
+	assert(cache->TotalCharge() <= kCacheSize);
+
+	// Entries hit since the last sweep get a second chance
+	test::CacheInsert(cache, 1, 1);
+	for (int i = 20000; i < 20000 + kCacheSize / 2; i++) {
+		test::CacheInsert(cache, i, i);
+		assert(test::CacheLookup(cache, 1) == 1);
+	}
+	cache->Prune();
+	assert(cache->TotalCharge() == 0);
+	delete cache;
+	assert(test::DeletedCacheEntries()->Load() == 3 + 1 + 10 * kCacheSize + 1 + kCacheSize / 2);
+
+	// More entries than the table was sized for are handed out uncached
+	cache = NewClockCache(kCacheSize, kCacheSize);
+	Cache::Handle* handles[64];
+	for (int i = 0; i < 64; i++) {
+		handles[i] = cache->Insert(test::EncodeCacheKey(i), NULL, 1, &test::CountingCacheDeleter);
+	}
+	assert(cache->TotalCharge() < 64);
+	for (int i = 0; i < 64; i++) {
+		cache->Release(handles[i]);
+	}
+	delete cache;
+
+	// Threads that insert the same keys at once leave one entry per key,
+	// which one Erase() removes
+	cache = NewClockCache(kCacheSize, 1);
+	const int kRacingKeys = 16;
+	test::DeletedCacheEntries()->Store(0);
+	test::RunCacheThreads(cache, 8, 20000, kRacingKeys, &ClockRacingInsertThread);
+	for (int k = 0; k < kRacingKeys; k++) {
+		cache->Erase(test::EncodeCacheKey(k));
+		assert(test::CacheLookup(cache, k) == -1);
+	}
+	assert(cache->TotalCharge() == 0);
+	assert(test::DeletedCacheEntries()->Load() == 8 * 20000);
+	delete cache;
+
+	const int kThreads = 32;
+	const int kOpsPerThread = 200000;
+	const int kNumKeys = 100000;
+	// Room for every key, also in the fullest LRU shard
+	cache = NewLRUCache(2 * kNumKeys);
+	std::cout << "lru:   " << ClockBenchHits(cache, kThreads, kNumKeys, kOpsPerThread)
+		<< " M hits/s" << std::endl;
+	delete cache;
+	cache = NewClockCache(2 * kNumKeys, 1);
+	std::cout << "clock: " << ClockBenchHits(cache, kThreads, kNumKeys, kOpsPerThread)
+		<< " M hits/s" << std::endl;
+	delete cache;
+}
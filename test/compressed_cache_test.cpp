@@ -0,0 +1,168 @@
+#include <assert.h>
+#include <stdio.h>
+#include <iostream>
+#include "include/leveldb/cache.h"
+#include "include/leveldb/options.h"
+#include "include/leveldb/table.h"
+#include "include/leveldb/table_builder.h"
+#include "port/port.h"
+#include "test/testutil.h"
+#include "util/random.h"
+
+using namespace leveldb;
+
+static std::string CompressedCacheRoundTrip(const std::string& input)
+{
+	std::string compressed;
+	bool ok = port::Snappy_Compress(input.data(), input.size(), &compressed);
+	assert(ok);
+	size_t n;
+	ok = port::Snappy_GetUncompressedLength(compressed.data(), compressed.size(), &n);
+	assert(ok && n == input.size());
+	std::string output(n, '\0');
+	ok = port::Snappy_Uncompress(compressed.data(), compressed.size(), &output[0]);
+	assert(ok && output == input);
+	return compressed;
+}
+
+// A value of random words from a small vocabulary, which compresses
+// about as well as typical text.
+static std::string CompressibleValue(Random* rnd, int len)
+{
+	static const char* kWords[] = { "alpha ", "beta ", "gamma ", "delta ", "epsilon ",
+		"zeta ", "eta ", "theta " };
+	std::string result;
+	while (result.size() < static_cast<size_t>(len)) {
+		result.append(kWords[rnd->Uniform(8)]);
+	}
+	result.resize(len);
+	return result;
+}
+
+static int demoted_entries = 0;
+
+static void CountDemoted(const Slice& key, void* value)
+{
+	demoted_entries++;
+}
+
+// Round trips through the block codec, which entries a cache demotes,
+// then point lookups over a working set several times the block cache,
+// with and without a compressed tier behind it.
+void CompressedCacheTest()
+{
+	Random rnd(301);
+	std::string input;
+	CompressedCacheRoundTrip(input);
+	for (int len = 1; len < 100000; len = len * 3 + 1) {
+		input.clear();
+		for (int i = 0; i < len; i++) {
+			input.push_back(static_cast<char>(rnd.Uniform(256)));
+		}
+		CompressedCacheRoundTrip(input);
+		std::string repetitive = CompressibleValue(&rnd, len);
+		std::string compressed = CompressedCacheRoundTrip(repetitive);
+		assert(len < 300 || compressed.size() < repetitive.size() / 2);
+	}
+	// Runs longer than a fragment, and corrupt input
+	input.assign(300000, 'a');
+	std::string compressed = CompressedCacheRoundTrip(input);
+	assert(compressed.size() < input.size() / 20);
+	std::string output(input.size(), '\0');
+	assert(!port::Snappy_Uncompress(compressed.data(), compressed.size() / 2, &output[0]));
+	compressed[compressed.size() / 2] ^= 0x55;
+	port::Snappy_Uncompress(compressed.data(), compressed.size(), &output[0]);
+
+	// Only entries evicted for room go to the evictor; replaced, erased
+	// and remaining entries go to the deleter
+	Cache* caches[] = { NewLRUCache(1600), NewTinyLFUCache(1600, 10), NewClockCache(1600, 10) };
+	for (int c = 0; c < 3; c++) {
+		Cache* cache = caches[c];
+		demoted_entries = 0;
+		test::DeletedCacheEntries()->Store(0);
+		cache->Release(cache->Insert("a", NULL, 10, &test::CountingCacheDeleter,
+			Cache::kLowPriority, Cache::kDataBlock, &CountDemoted));
+		Cache::Handle* h = cache->Insert("a", NULL, 10, &test::CountingCacheDeleter,
+			Cache::kLowPriority, Cache::kDataBlock, &CountDemoted);
+		assert(test::DeletedCacheEntries()->Load() == 1 && demoted_entries == 0);
+		cache->Release(h);
+		cache->Erase("a");
+		assert(test::DeletedCacheEntries()->Load() == 2 && demoted_entries == 0);
+		for (int i = 0; i < 500; i++) {
+			char key[16];
+			snprintf(key, sizeof(key), "%d", i);
+			cache->Release(cache->Insert(key, NULL, 10, &test::CountingCacheDeleter,
+				Cache::kLowPriority, Cache::kDataBlock, &CountDemoted));
+		}
+		assert(test::DeletedCacheEntries()->Load() == 2 && demoted_entries >= 300);
+		delete cache;
+		assert(test::DeletedCacheEntries()->Load() + demoted_entries == 502);
+	}
+
+	Options options;
+	options.compression = kNoCompression;
+	test::StringSink sink;
+	TableBuilder builder(options, &sink);
+	const int kNumKeys = 20000;
+	for (int i = 0; i < kNumKeys; i++) {
+		char key[16];
+		snprintf(key, sizeof(key), "key%06d", i);
+		builder.Add(key, CompressibleValue(&rnd, 100));
+	}
+	Status s = builder.Finish();
+	assert(s.ok());
+
+	// A primary cache of about a fifth of the table, and a tier with room
+	// for a good part of the rest once compressed
+	const size_t kBlockCacheSize = sink.contents().size() / 5;
+	const char* labels[] = { "block cache only:       ", "with compressed tier:   " };
+	uint64_t reads[2];
+	for (int tiered = 0; tiered < 2; tiered++) {
+		Cache* block_cache = NewLRUCache(kBlockCacheSize);
+		Cache* compressed_cache = (tiered ? NewLRUCache(kBlockCacheSize) : NULL);
+		options.block_cache = block_cache;
+		options.compressed_block_cache = compressed_cache;
+		test::StringSource source(sink.contents());
+		Table* table = NULL;
+		s = Table::Open(options, &source, source.Size(), &table);
+		assert(s.ok());
+
+		// Warm the caches with a scan, then look keys up at random
+		Iterator* iter = table->NewIterator(ReadOptions());
+		int count = 0;
+		for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+			count++;
+		}
+		assert(iter->status().ok() && count == kNumKeys);
+		source.ResetCounters();
+		Random lookups(17);
+		for (int i = 0; i < 20000; i++) {
+			char key[16];
+			snprintf(key, sizeof(key), "key%06d", static_cast<int>(lookups.Uniform(kNumKeys)));
+			if (i % 2 == 0) {
+				iter->Seek(key);
+				assert(iter->Valid() && iter->key() == Slice(key));
+			} else {
+				Slice k(key);
+				int found = 0;
+				s = table->MultiGet(ReadOptions(), &k, 1, &found, &test::CountFound);
+				assert(s.ok() && found == 1);
+			}
+		}
+		reads[tiered] = source.reads();
+		delete iter;
+		std::cout << labels[tiered] << reads[tiered] << " reads for 20000 lookups";
+		if (tiered) {
+			std::cout << ", tier holds " << compressed_cache->TotalCharge() << " bytes";
+		}
+		std::cout << std::endl;
+		delete table;
+		delete block_cache;
+		if (tiered) {
+			// The blocks block_cache evicted were demoted
+			assert(compressed_cache->TotalCharge() > 0);
+			delete compressed_cache;
+		}
+	}
+	assert(reads[1] * 2 < reads[0]);
+}
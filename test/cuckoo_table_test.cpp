@@ -0,0 +1,86 @@
+#include <assert.h>
+#include <stdio.h>
+#include <time.h>
+#include <iostream>
+#include <vector>
+#include "include/leveldb/cuckoo_table.h"
+#include "include/leveldb/cuckoo_table_builder.h"
+#include "include/leveldb/options.h"
+#include "test/testutil.h"
+#include "util/random.h"
+
+using namespace leveldb;
+
+static std::string MakeCuckooKey(int i)
+{
+	char buf[32];
+	snprintf(buf, sizeof(buf), "key%08d", i);
+	return std::string(buf);
+}
+
+struct CuckooGetState {
+	Slice key;
+	int found;
+};
+
+static void SaveCuckooGetResult(void* arg, const Slice& k, const Slice& v)
+{
+	CuckooGetState* state = reinterpret_cast<CuckooGetState*>(arg);
+	if (k == state->key) {
+		state->found++;
+	}
+}
+
+// Counts the file reads of lookups for keys that are present (the even
+// keys) and absent (the odd keys).
+void CuckooTableTest()
+{
+	const int kNumEntries = 100000;
+	const int kNumLookups = 200000;
+
+	Options options;
+	test::StringSink sink;
+	CuckooTableBuilder builder(options, &sink);
+	std::string value(100, 'v');
+	for (int i = 0; i < 2 * kNumEntries; i += 2) {
+		builder.Add(MakeCuckooKey(i), value);
+	}
+	Status s = builder.Finish();
+	assert(s.ok());
+
+	test::StringSource source(sink.contents());
+	CuckooTable* table = NULL;
+	s = CuckooTable::Open(options, &source, source.Size(), &table);
+	assert(s.ok());
+	assert(table->NumEntries() == kNumEntries);
+
+	Random rnd(301);
+	ReadOptions read_options;
+	for (int present = 1; present >= 0; present--) {
+		CuckooGetState state;
+		state.found = 0;
+		uint64_t max_reads = 0;
+		source.ResetCounters();
+		clock_t start = clock();
+		for (int i = 0; i < kNumLookups; i++) {
+			std::string key = MakeCuckooKey(2 * rnd.Uniform(kNumEntries) + (present ? 0 : 1));
+			state.key = key;
+			const uint64_t reads_before = source.reads();
+			s = table->Get(read_options, key, &state, SaveCuckooGetResult);
+			assert(s.ok());
+			if (source.reads() - reads_before > max_reads) {
+				max_reads = source.reads() - reads_before;
+			}
+		}
+		double secs = double(clock() - start) / CLOCKS_PER_SEC;
+		assert(state.found == (present ? kNumLookups : 0));
+		assert(max_reads <= 2);
+		std::cout << (present ? "present keys: " : "absent keys:  ")
+			<< double(source.reads()) / kNumLookups << " reads/get, at most "
+			<< max_reads << ", " << kNumLookups / secs << " gets/s" << std::endl;
+	}
+	std::cout << "file size " << sink.contents().size() << " bytes for "
+		<< kNumEntries << " entries" << std::endl;
+
+	delete table;
+}
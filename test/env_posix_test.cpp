@@ -0,0 +1,271 @@
+#include <assert.h>
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+#include <iostream>
+#include <vector>
+#include "db/filename.h"
+#include "db/table_cache.h"
+#include "include/leveldb/env.h"
+#include "include/leveldb/iterator.h"
+#include "include/leveldb/options.h"
+#include "include/leveldb/table_builder.h"
+#include "port/port.h"
+#include "util/mutexlock.h"
+#include "util/random.h"
+
+using namespace leveldb;
+
+// Records the access pattern hints given to the files it opens.
+class HintRecordingEnv : public EnvWrapper {
+public:
+	explicit HintRecordingEnv(Env* target) : EnvWrapper(target) { }
+
+	virtual Status NewRandomAccessFile(const std::string& f, const RandomAccessFileOptions& o,
+		RandomAccessFile** r) {
+		RandomAccessFile* file;
+		Status s = target()->NewRandomAccessFile(f, o, &file);
+		*r = s.ok() ? new HintedFile(this, file) : NULL;
+		return s;
+	}
+
+	std::vector<RandomAccessFile::AccessPattern> hints;
+
+private:
+	class HintedFile : public RandomAccessFile {
+	public:
+		HintedFile(HintRecordingEnv* env, RandomAccessFile* file) : env_(env), file_(file) { }
+		virtual ~HintedFile() { delete file_; }
+		virtual Status Read(uint64_t offset, size_t n, Slice* result, char* scratch) const {
+			return file_->Read(offset, n, result, scratch);
+		}
+		virtual bool ReturnsStablePointers() const { return file_->ReturnsStablePointers(); }
+		virtual void Hint(AccessPattern pattern) {
+			env_->hints.push_back(pattern);
+			file_->Hint(pattern);
+		}
+
+	private:
+		HintRecordingEnv* env_;
+		RandomAccessFile* file_;
+	};
+};
+
+struct ScanThreadState {
+	TableCache* cache;
+	uint64_t file_size;
+	int num_scans;
+	port::Mutex* mu;
+	port::CondVar* cv;
+	int* running;
+};
+
+// Starts and ends short scans of table file 1.
+static void ScanThread(void* arg)
+{
+	ScanThreadState* state = reinterpret_cast<ScanThreadState*>(arg);
+	ReadOptions scan_options;
+	scan_options.sequential_scan = true;
+	for (int i = 0; i < state->num_scans; i++) {
+		Iterator* iter = state->cache->NewIterator(scan_options, 1, state->file_size);
+		iter->SeekToFirst();
+		assert(iter->Valid());
+		delete iter;
+	}
+	MutexLock l(state->mu);
+	(*state->running)--;
+	state->cv->SignalAll();
+}
+
+static void SaveEnvTestValue(void* arg, const Slice& k, const Slice& v)
+{
+	reinterpret_cast<std::string*>(arg)->assign(v.data(), v.size());
+}
+
+// Sequential, memory-mapped and pread() reads of the same file, the
+// access pattern hints a TableCache gives for point lookups and scans,
+// also from concurrent scans, and lookups and scans through mapped and pread() table files.
+void EnvPosixTest()
+{
+	Env* env = Env::Default();
+	const std::string fname = "./env_posix_test.dat";
+	const size_t kFileSize = 1024 * 1024 + 123;
+	std::string contents;
+	Random rnd(301);
+	for (size_t i = 0; i < kFileSize; i++) {
+		contents.push_back(static_cast<char>(rnd.Uniform(256)));
+	}
+	WritableFile* wfile;
+	Status s = env->NewWritableFile(fname, &wfile);
+	assert(s.ok());
+	s = wfile->Append(contents);
+	assert(s.ok());
+	s = wfile->Close();
+	assert(s.ok());
+	delete wfile;
+
+	// Reading through, skipping every other chunk
+	SequentialFile* sfile;
+	s = env->NewSequentialFile(fname, &sfile);
+	assert(s.ok());
+	std::vector<char> scratch(10000);
+	size_t pos = 0;
+	for (int i = 0; pos < kFileSize; i++) {
+		Slice result;
+		s = sfile->Read(scratch.size(), &result, &scratch[0]);
+		assert(s.ok());
+		assert(result.size() == std::min(scratch.size(), kFileSize - pos));
+		assert(memcmp(result.data(), contents.data() + pos, result.size()) == 0);
+		pos += result.size();
+		if (i % 2 == 0 && pos < kFileSize) {
+			s = sfile->Skip(3000);
+			assert(s.ok());
+			pos += 3000;
+		}
+	}
+	Slice result;
+	s = sfile->Read(scratch.size(), &result, &scratch[0]);
+	assert(s.ok() && result.empty());
+	delete sfile;
+	assert(!env->NewSequentialFile("./env_posix_test.missing", &sfile).ok() && sfile == NULL);
+
+	// The same reads from a mapping and with pread()
+	RandomAccessFile* files[2];
+	RandomAccessFileOptions file_options;
+	s = env->NewRandomAccessFile(fname, file_options, &files[0]);
+	assert(s.ok() && files[0]->ReturnsStablePointers());
+	file_options.use_mmap_reads = false;
+	s = env->NewRandomAccessFile(fname, file_options, &files[1]);
+	assert(s.ok() && !files[1]->ReturnsStablePointers());
+	char ids[2][64];
+	assert(files[0]->GetUniqueId(ids[0], 64) == files[1]->GetUniqueId(ids[1], 64));
+	assert(memcmp(ids[0], ids[1], files[0]->GetUniqueId(ids[0], 64)) == 0);
+	for (int f = 0; f < 2; f++) {
+		const RandomAccessFile::AccessPattern patterns[] = { RandomAccessFile::kRandom,
+			RandomAccessFile::kSequential, RandomAccessFile::kWillNeed,
+			RandomAccessFile::kDontNeed, RandomAccessFile::kNormal };
+		for (int p = 0; p < 5; p++) {
+			files[f]->Hint(patterns[p]);
+			for (int i = 0; i < 100; i++) {
+				const uint64_t offset = rnd.Uniform(kFileSize - scratch.size());
+				const size_t n = 1 + rnd.Uniform(scratch.size());
+				s = files[f]->Read(offset, n, &result, &scratch[0]);
+				assert(s.ok() && result.size() == n);
+				assert(memcmp(result.data(), contents.data() + offset, n) == 0);
+			}
+		}
+	}
+	// Reading past the end: a mapping refuses, pread() comes up short
+	assert(!files[0]->Read(kFileSize - 10, 20, &result, &scratch[0]).ok());
+	s = files[1]->Read(kFileSize - 10, 20, &result, &scratch[0]);
+	assert(s.ok() && result.size() == 10);
+	delete files[0];
+	delete files[1];
+	env->RemoveFile(fname);
+	assert(!env->NewRandomAccessFile(fname, file_options, &files[0]).ok() && files[0] == NULL);
+
+	// Table files hinted random on open, sequential while scans run
+	Options options;
+	options.compression = kNoCompression;
+	const int kNumKeys = 50000;
+	WritableFile* table_file;
+	s = env->NewWritableFile(TableFileName(".", 1), &table_file);
+	assert(s.ok());
+	TableBuilder builder(options, table_file);
+	for (int i = 0; i < kNumKeys; i++) {
+		char key[16];
+		snprintf(key, sizeof(key), "key%06d", i);
+		builder.Add(key, std::string(100, 'v'));
+	}
+	s = builder.Finish();
+	assert(s.ok());
+	const uint64_t file_size = builder.FileSize();
+	s = table_file->Close();
+	assert(s.ok());
+	delete table_file;
+
+	HintRecordingEnv hint_env(env);
+	TableCache* cache = new TableCache(".", options, &hint_env, 10);
+	std::string value;
+	s = cache->Get(ReadOptions(), 1, file_size, "key000007", &value, &SaveEnvTestValue);
+	assert(s.ok() && value == std::string(100, 'v'));
+	assert(hint_env.hints.size() == 1 && hint_env.hints[0] == RandomAccessFile::kRandom);
+	ReadOptions scan_options;
+	scan_options.sequential_scan = true;
+	Iterator* scan1 = cache->NewIterator(scan_options, 1, file_size);
+	Iterator* scan2 = cache->NewIterator(scan_options, 1, file_size);
+	Iterator* lookup = cache->NewIterator(ReadOptions(), 1, file_size);
+	assert(hint_env.hints.size() == 2 && hint_env.hints[1] == RandomAccessFile::kSequential);
+	delete lookup;
+	delete scan1;
+	assert(hint_env.hints.size() == 2);
+	delete scan2;
+	assert(hint_env.hints.size() == 3 && hint_env.hints[2] == RandomAccessFile::kRandom);
+
+	// Scans that start as others end, from several threads, still leave
+	// the hints alternating and the file on random access at the end
+	port::Mutex mu;
+	port::CondVar cv(&mu);
+	const int kThreads = 4;
+	int running = kThreads;
+	ScanThreadState states[kThreads];
+	for (int i = 0; i < kThreads; i++) {
+		states[i].cache = cache;
+		states[i].file_size = file_size;
+		states[i].num_scans = 2000;
+		states[i].mu = &mu;
+		states[i].cv = &cv;
+		states[i].running = &running;
+		env->StartThread(&ScanThread, &states[i]);
+	}
+	mu.Lock();
+	while (running > 0) {
+		cv.Wait();
+	}
+	mu.Unlock();
+	assert(hint_env.hints.size() % 2 == 1);
+	for (size_t i = 3; i < hint_env.hints.size(); i++) {
+		assert(hint_env.hints[i] == (i % 2 == 1 ? RandomAccessFile::kSequential :
+			RandomAccessFile::kRandom));
+	}
+	delete cache;
+
+	options.advise_random_on_open = false;
+	hint_env.hints.clear();
+	cache = new TableCache(".", options, &hint_env, 10);
+	scan1 = cache->NewIterator(scan_options, 1, file_size);
+	delete scan1;
+	assert(hint_env.hints.size() == 3 && hint_env.hints[0] == RandomAccessFile::kNormal &&
+		hint_env.hints[2] == RandomAccessFile::kNormal);
+	delete cache;
+
+	// Point lookups and a scan through mapped and pread() table files
+	for (int mmap = 1; mmap >= 0; mmap--) {
+		options.use_mmap_reads = (mmap != 0);
+		options.advise_random_on_open = true;
+		cache = new TableCache(".", options, env, 10);
+		const int kLookups = 100000;
+		uint64_t start = env->NowMicros();
+		for (int i = 0; i < kLookups; i++) {
+			char key[16];
+			snprintf(key, sizeof(key), "key%06d", static_cast<int>(rnd.Uniform(kNumKeys)));
+			s = cache->Get(ReadOptions(), 1, file_size, key, &value, &SaveEnvTestValue);
+			assert(s.ok());
+		}
+		const uint64_t lookup_micros = env->NowMicros() - start;
+		start = env->NowMicros();
+		Iterator* iter = cache->NewIterator(scan_options, 1, file_size);
+		int count = 0;
+		for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+			count++;
+		}
+		assert(iter->status().ok() && count == kNumKeys);
+		delete iter;
+		const uint64_t scan_micros = env->NowMicros() - start + 1;
+		std::cout << (mmap ? "mmap:  " : "pread: ") << kLookups * 1e6 / lookup_micros
+			<< " lookups/s, scan " << file_size / static_cast<double>(scan_micros)
+			<< " MB/s" << std::endl;
+		delete cache;
+	}
+	env->RemoveFile(TableFileName(".", 1));
+}
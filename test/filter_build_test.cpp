@@ -0,0 +1,80 @@
+#include <assert.h>
+#include <stdio.h>
+#include <iostream>
+#include <string>
+#include "include/leveldb/env.h"
+#include "include/leveldb/filter_policy.h"
+#include "include/leveldb/options.h"
+#include "include/leveldb/table_builder.h"
+#include "test/testutil.h"
+
+using namespace leveldb;
+
+// Forwards to another policy but hides its support for key hashes, so
+// that table builders buffer the key bytes.
+class KeyBytesPolicy : public FilterPolicy {
+public:
+	explicit KeyBytesPolicy(const FilterPolicy* policy) : policy_(policy) { }
+
+	virtual const char* Name() const {
+		return policy_->Name();
+	}
+	virtual void CreateFilter(const Slice* keys, int n, std::string* dst) const {
+		policy_->CreateFilter(keys, n, dst);
+	}
+	virtual bool KeyMayMatch(const Slice& key, const Slice& filter) const {
+		return policy_->KeyMayMatch(key, filter);
+	}
+
+private:
+	const FilterPolicy* policy_;
+};
+
+static std::string MakeLongKey(int i)
+{
+	char buf[32];
+	snprintf(buf, sizeof(buf), "%016d", i);
+	return std::string(100, 'k') + buf;
+}
+
+// Time to build a table of long keys with filters made from buffered key
+// bytes and from key hashes.  Both must produce the same table.
+void FilterBuildTest()
+{
+	const int kNumKeys = 500000;
+	Env* env = Env::Default();
+	const FilterPolicy* policies[2];
+	policies[0] = NewBloomFilterPolicy(10);
+	policies[1] = NewBinaryFuseFilterPolicy(8);
+
+	for (int p = 0; p < 2; p++) {
+		KeyBytesPolicy key_bytes(policies[p]);
+		for (int whole_table = 0; whole_table < 2; whole_table++) {
+			std::string contents[2];
+			double micros[2];
+			for (int hashed = 0; hashed < 2; hashed++) {
+				Options options;
+				options.compression = kNoCompression;
+				options.filter_policy = (hashed ? policies[p] : &key_bytes);
+				options.whole_table_filter = (whole_table != 0);
+				test::StringSink sink;
+				uint64_t start = env->NowMicros();
+				TableBuilder builder(options, &sink);
+				for (int i = 0; i < kNumKeys; i++) {
+					builder.Add(MakeLongKey(i), "v");
+				}
+				Status s = builder.Finish();
+				assert(s.ok());
+				micros[hashed] = double(env->NowMicros() - start);
+				contents[hashed] = sink.contents();
+			}
+			assert(contents[0] == contents[1]);
+
+			std::cout << policies[p]->Name() << (whole_table ? " whole-table: " : " per-block:   ")
+				<< kNumKeys / micros[0] << " M keys/s from key bytes, "
+				<< kNumKeys / micros[1] << " M keys/s from hashes" << std::endl;
+		}
+	}
+	delete policies[0];
+	delete policies[1];
+}
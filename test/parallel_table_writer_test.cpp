@@ -0,0 +1,73 @@
+#include <assert.h>
+#include <stdio.h>
+#include <iostream>
+#include <string>
+#include "include/leveldb/env.h"
+#include "include/leveldb/options.h"
+#include "include/leveldb/parallel_table_writer.h"
+
+using namespace leveldb;
+
+namespace {
+
+// A WritableFile that drops everything written to it.
+class NullWritableFile : public WritableFile {
+public:
+	virtual Status Append(const Slice& data) { return Status::OK(); }
+	virtual Status Close() { return Status::OK(); }
+	virtual Status Flush() { return Status::OK(); }
+	virtual Status Sync() { return Status::OK(); }
+};
+
+// Keeps the benchmark away from the disk, so that it measures how table
+// building scales with threads.
+class NullFileEnv : public EnvWrapper {
+public:
+	explicit NullFileEnv(Env* base) : EnvWrapper(base) { }
+	virtual Status NewWritableFile(const std::string& fname, WritableFile** result) {
+		*result = new NullWritableFile;
+		return Status::OK();
+	}
+	virtual Status NewWritableFile(const std::string& fname,
+		const WritableFileOptions& options, WritableFile** result) {
+		return NewWritableFile(fname, result);
+	}
+};
+
+}  // namespace
+
+void ParallelTableWriterTest()
+{
+	const int kNumEntries = 2000000;
+	const size_t kTargetFileSize = 8 * 1024 * 1024;
+
+	NullFileEnv env(Env::Default());
+	Options options;
+	options.compression = kNoCompression;
+	std::string value(100, 'v');
+
+	for (int threads = 1; threads <= 8; threads *= 2) {
+		ParallelTableWriter writer(options, &env, "/tmp/bulk", kTargetFileSize, threads);
+		const uint64_t start = env.NowMicros();
+		char key[32];
+		for (int i = 0; i < kNumEntries; i++) {
+			snprintf(key, sizeof(key), "key%012d", i);
+			writer.Add(key, value);
+		}
+		Status s = writer.Finish();
+		assert(s.ok());
+		const double secs = (env.NowMicros() - start) * 1e-6;
+
+		uint64_t entries = 0;
+		uint64_t bytes = 0;
+		const std::vector<ParallelTableFile>& files = writer.files();
+		for (size_t i = 0; i < files.size(); i++) {
+			entries += files[i].num_entries;
+			bytes += files[i].file_size;
+			assert(i == 0 || files[i - 1].largest_key < files[i].smallest_key);
+		}
+		assert(entries == kNumEntries);
+		std::cout << threads << " threads: " << files.size() << " files, "
+			<< bytes / secs / 1e9 << " GB/s" << std::endl;
+	}
+}
@@ -0,0 +1,172 @@
+#include <assert.h>
+#include <stdio.h>
+#include <iostream>
+#include <vector>
+#include "include/leveldb/env.h"
+#include "include/leveldb/options.h"
+#include "include/leveldb/persistent_cache.h"
+#include "include/leveldb/table.h"
+#include "include/leveldb/table_builder.h"
+#include "test/testutil.h"
+#include "util/random.h"
+
+using namespace leveldb;
+
+static void RemovePersistentCacheFiles(Env* env, const std::string& dir)
+{
+	std::vector<std::string> children;
+	Status s = env->GetChildren(dir, &children);
+	assert(s.ok());
+	for (size_t i = 0; i < children.size(); i++) {
+		const std::string& name = children[i];
+		if (name.size() > 7 && name.compare(name.size() - 7, 7, ".pcache") == 0) {
+			env->RemoveFile(dir + "/" + name);
+		}
+	}
+}
+
+static std::string PersistentCacheValue(int k)
+{
+	return std::string(1000, static_cast<char>('a' + k % 26));
+}
+
+// Runs "n" random point lookups against "table" and returns the number
+// of reads they made of its file.
+static uint64_t PersistentCacheLookups(Table* table, test::StringSource* source,
+	int num_keys, int n)
+{
+	source->ResetCounters();
+	Random rnd(17);
+	for (int i = 0; i < n; i++) {
+		char key[16];
+		snprintf(key, sizeof(key), "key%06d", static_cast<int>(rnd.Uniform(num_keys)));
+		Slice k(key);
+		int found = 0;
+		Status s = table->MultiGet(ReadOptions(), &k, 1, &found, &test::CountFound);
+		assert(s.ok() && found == 1);
+	}
+	return source->reads();
+}
+
+// Entries dropped with the oldest file once the capacity is reached, the
+// index recovered by a new process, and the reads a table saves after a
+// restart when its blocks are in the persistent cache.
+void PersistentCacheTest()
+{
+	Env* env = Env::Default();
+	const std::string dir = ".";
+	RemovePersistentCacheFiles(env, dir);
+
+	PersistentCacheOptions cache_options;
+	cache_options.path = dir;
+	PersistentCache* cache = NULL;
+	Status s = NewPersistentCache(cache_options, &cache);
+	assert(s.IsInvalidArgument() && cache == NULL);
+	cache_options.env = env;
+	cache_options.capacity = 64 * 1024;
+	cache_options.file_size = 16 * 1024;
+	s = NewPersistentCache(cache_options, &cache);
+	assert(s.ok());
+	const int kNumEntries = 200;
+	for (int i = 0; i < kNumEntries; i++) {
+		s = cache->Insert(test::EncodeCacheKey(i), PersistentCacheValue(i));
+		assert(s.ok());
+	}
+	assert(cache->Size() <= cache_options.capacity);
+	std::vector<bool> present(kNumEntries);
+	int num_present = 0;
+	for (int i = 0; i < kNumEntries; i++) {
+		std::string data;
+		s = cache->Lookup(test::EncodeCacheKey(i), &data);
+		present[i] = s.ok();
+		if (s.ok()) {
+			assert(data == PersistentCacheValue(i));
+			num_present++;
+		} else {
+			assert(s.IsNotFound());
+		}
+	}
+	// The newest entries survive, the oldest are gone
+	assert(present[kNumEntries - 1] && !present[0]);
+	assert(num_present > 30);
+	std::string too_large(cache_options.file_size, 'x');
+	assert(!cache->Insert("large", too_large).ok());
+	delete cache;
+
+	// Room for the new file to write costs the oldest one on reopening
+	s = NewPersistentCache(cache_options, &cache);
+	assert(s.ok());
+	int num_recovered = 0;
+	for (int i = 0; i < kNumEntries; i++) {
+		std::string data;
+		s = cache->Lookup(test::EncodeCacheKey(i), &data);
+		assert(!s.ok() || (present[i] && data == PersistentCacheValue(i)));
+		num_recovered += s.ok();
+	}
+	assert(num_recovered > num_present / 2);
+	std::string data;
+	assert(cache->Lookup(test::EncodeCacheKey(kNumEntries - 1), &data).ok());
+	delete cache;
+	RemovePersistentCacheFiles(env, dir);
+
+	// A table on "remote" storage, read by one process and then by the
+	// next one, with a block cache and a persistent cache.  The default
+	// options compress the blocks; the cache holds them uncompressed.
+	Options options;
+	assert(options.compression == kSnappyCompression);
+	const CompressionType compressions[] = { kSnappyCompression, kNoCompression };
+	const int kNumKeys = 20000;
+	test::StringSink sinks[2];
+	for (int c = 0; c < 2; c++) {
+		options.compression = compressions[c];
+		options.block_cache = NULL;
+		options.persistent_cache = NULL;
+		TableBuilder builder(options, &sinks[c]);
+		for (int i = 0; i < kNumKeys; i++) {
+			char key[16];
+			snprintf(key, sizeof(key), "key%06d", i);
+			builder.Add(key, std::string(100, 'v'));
+		}
+		s = builder.Finish();
+		assert(s.ok());
+
+		cache_options.capacity = 8 * kNumKeys * 100;
+		cache_options.file_size = 256 * 1024;
+		uint64_t reads[2];
+		for (int run = 0; run < 2; run++) {
+			s = NewPersistentCache(cache_options, &cache);
+			assert(s.ok());
+			Cache* block_cache = NewLRUCache(64 * 1024);
+			options.block_cache = block_cache;
+			options.persistent_cache = cache;
+			test::StringSource source(sinks[c].contents());
+			source.SetUniqueId(c == 0 ? "table-1" : "table-2");
+			Table* table = NULL;
+			s = Table::Open(options, &source, source.Size(), &table);
+			assert(s.ok());
+			reads[run] = PersistentCacheLookups(table, &source, kNumKeys, 20000);
+			std::cout << (c == 0 ? "snappy, " : "none,   ")
+				<< (run == 0 ? "first process: " : "after restart: ") << reads[run]
+				<< " file reads for 20000 lookups, persistent cache holds "
+				<< cache->Size() << " bytes" << std::endl;
+			delete table;
+			delete block_cache;
+			delete cache;
+		}
+		assert(reads[1] == 0 && reads[0] > 0);
+	}
+
+	// Files without a unique id are not persistently cached
+	s = NewPersistentCache(cache_options, &cache);
+	assert(s.ok());
+	options.block_cache = NULL;
+	options.persistent_cache = cache;
+	test::StringSource source(sinks[0].contents());
+	Table* table = NULL;
+	s = Table::Open(options, &source, source.Size(), &table);
+	assert(s.ok());
+	assert(PersistentCacheLookups(table, &source, kNumKeys, 100) == 100);
+	delete table;
+	delete cache;
+	RemovePersistentCacheFiles(env, dir);
+}
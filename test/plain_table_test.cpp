@@ -0,0 +1,120 @@
+#include <assert.h>
+#include <stdio.h>
+#include <time.h>
+#include <iostream>
+#include <vector>
+#include "include/leveldb/options.h"
+#include "include/leveldb/plain_table.h"
+#include "include/leveldb/plain_table_builder.h"
+#include "include/leveldb/table.h"
+#include "include/leveldb/table_builder.h"
+#include "test/testutil.h"
+#include "util/random.h"
+
+using namespace leveldb;
+
+static std::string MakePlainKey(int i)
+{
+	char buf[32];
+	snprintf(buf, sizeof(buf), "key%08d", i);
+	return std::string(buf);
+}
+
+struct PlainGetState {
+	Slice key;
+	int found;
+};
+
+static void SavePlainGetResult(void* arg, const Slice& k, const Slice& v)
+{
+	PlainGetState* state = reinterpret_cast<PlainGetState*>(arg);
+	if (k == state->key) {
+		state->found++;
+	}
+}
+
+static void SaveBlockGetResult(void* arg, int index, const Slice& k, const Slice& v)
+{
+	SavePlainGetResult(arg, k, v);
+}
+
+// Point lookups against the same memory-mapped data stored as a plain
+// table and as a block-based table.
+void PlainTableTest()
+{
+	const int kNumEntries = 200000;
+	const int kNumLookups = 1000000;
+
+	Options options;
+	options.compression = kNoCompression;
+	std::string value(100, 'v');
+
+	test::StringSink plain_sink;
+	PlainTableBuilder plain_builder(options, &plain_sink);
+	test::StringSink block_sink;
+	TableBuilder block_builder(options, &block_sink);
+	for (int i = 0; i < kNumEntries; i++) {
+		plain_builder.Add(MakePlainKey(i), value);
+		block_builder.Add(MakePlainKey(i), value);
+	}
+	Status s = plain_builder.Finish();
+	assert(s.ok());
+	s = block_builder.Finish();
+	assert(s.ok());
+
+	test::StringSource plain_source(plain_sink.contents(), true);
+	test::StringSource block_source(block_sink.contents(), true);
+	PlainTable* plain = NULL;
+	s = PlainTable::Open(options, &plain_source, plain_source.Size(), &plain);
+	assert(s.ok());
+	Table* block = NULL;
+	s = Table::Open(options, &block_source, block_source.Size(), &block);
+	assert(s.ok());
+
+	std::vector<std::string> keys;
+	Random rnd(301);
+	for (int i = 0; i < kNumLookups; i++) {
+		keys.push_back(MakePlainKey(rnd.Uniform(kNumEntries)));
+	}
+
+	ReadOptions read_options;
+	PlainGetState plain_state;
+	plain_state.found = 0;
+	clock_t start = clock();
+	for (int i = 0; i < kNumLookups; i++) {
+		plain_state.key = keys[i];
+		plain->Get(read_options, keys[i], &plain_state, SavePlainGetResult);
+	}
+	double plain_secs = double(clock() - start) / CLOCKS_PER_SEC;
+
+	PlainGetState block_state;
+	block_state.found = 0;
+	start = clock();
+	for (int i = 0; i < kNumLookups; i++) {
+		Slice key(keys[i]);
+		block_state.key = key;
+		block->MultiGet(read_options, &key, 1, &block_state, SaveBlockGetResult);
+	}
+	double block_secs = double(clock() - start) / CLOCKS_PER_SEC;
+
+	assert(plain_state.found == kNumLookups);
+	assert(block_state.found == kNumLookups);
+
+	Iterator* iter = plain->NewIterator(read_options);
+	int count = 0;
+	for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+		count++;
+	}
+	assert(count == kNumEntries);
+	iter->Seek(MakePlainKey(kNumEntries / 2));
+	assert(iter->Valid() && iter->key() == Slice(MakePlainKey(kNumEntries / 2)));
+	delete iter;
+
+	std::cout << "plain table: " << plain_sink.contents().size() << " bytes, "
+		<< kNumLookups / plain_secs << " gets/s" << std::endl;
+	std::cout << "block table: " << block_sink.contents().size() << " bytes, "
+		<< kNumLookups / block_secs << " gets/s" << std::endl;
+
+	delete plain;
+	delete block;
+}
@@ -0,0 +1,125 @@
+#include <assert.h>
+#include <stdio.h>
+#include <iostream>
+#include "include/leveldb/filter_policy.h"
+#include "include/leveldb/options.h"
+#include "include/leveldb/slice_transform.h"
+#include "include/leveldb/table.h"
+#include "include/leveldb/table_builder.h"
+#include "test/testutil.h"
+
+using namespace leveldb;
+
+static const int kNumTenants = 20;
+static const int kNumEntities = 400;   // Only even entities are stored
+static const int kNumTimestamps = 10;
+
+static std::string MakeEntityPrefix(int tenant, int entity)
+{
+	char buf[32];
+	snprintf(buf, sizeof(buf), "t%03d|e%05d|", tenant, entity);
+	return std::string(buf);
+}
+
+static std::string MakeEventKey(int tenant, int entity, int ts)
+{
+	char buf[16];
+	snprintf(buf, sizeof(buf), "%04d", ts);
+	return MakeEntityPrefix(tenant, entity) + buf;
+}
+
+// Scan every entity prefix, stored or not, and return the number of keys
+// found.  *reads is set to the number of file reads the scans issued.
+static int ScanEntities(Table* table, test::StringSource* source,
+	const ReadOptions& read_options, bool present, uint64_t* reads)
+{
+	int found = 0;
+	source->ResetCounters();
+	Iterator* iter = table->NewIterator(read_options);
+	for (int t = 0; t < kNumTenants; t++) {
+		for (int e = (present ? 0 : 1); e < kNumEntities; e += 2) {
+			std::string prefix = MakeEntityPrefix(t, e);
+			int n = 0;
+			for (iter->Seek(prefix); iter->Valid() && iter->key().starts_with(prefix); iter->Next()) {
+				assert(iter->key() == Slice(MakeEventKey(t, e, n)));
+				n++;
+			}
+			assert(iter->status().ok());
+			assert(n == (present ? kNumTimestamps : 0));
+			found += n;
+		}
+	}
+	delete iter;
+	*reads = source->reads();
+	return found;
+}
+
+// Prefix scans over "tenant|entity|timestamp" keys with and without
+// prefix filtering.  Once the entity prefixes are in the filter, scans
+// for entities that have no events rarely read a data block.
+void PrefixSeekTest()
+{
+	const FilterPolicy* policy = NewBloomFilterPolicy(10);
+	const SliceTransform* extractor = NewDelimitedPrefixTransform('|', 2);
+	assert(extractor->InDomain("t001|e00002|0003"));
+	assert(extractor->Transform("t001|e00002|0003") == Slice("t001|e00002|"));
+	assert(!extractor->InDomain("t001|e00002"));
+
+	const char* labels[] = { "no prefix filter   ", "per-block filter   ", "whole-table filter " };
+	for (int mode = 0; mode < 3; mode++) {
+		Options options;
+		options.compression = kNoCompression;
+		options.filter_policy = policy;
+		options.prefix_extractor = (mode == 0 ? NULL : extractor);
+		options.whole_table_filter = (mode == 2);
+		std::string value(50, 'v');
+
+		test::StringSink sink;
+		TableBuilder builder(options, &sink);
+		for (int t = 0; t < kNumTenants; t++) {
+			for (int e = 0; e < kNumEntities; e += 2) {
+				for (int ts = 0; ts < kNumTimestamps; ts++) {
+					builder.Add(MakeEventKey(t, e, ts), value);
+				}
+			}
+		}
+		Status s = builder.Finish();
+		assert(s.ok());
+
+		test::StringSource source(sink.contents());
+		Table* table = NULL;
+		s = Table::Open(options, &source, source.Size(), &table);
+		assert(s.ok());
+		assert(table->properties().prefix_extractor_name ==
+			(mode == 0 ? std::string() : std::string(extractor->Name())));
+
+		ReadOptions read_options;
+		read_options.prefix_seek = true;
+		uint64_t present_reads, absent_reads;
+		int found = ScanEntities(table, &source, read_options, true, &present_reads);
+		assert(found == kNumTenants * (kNumEntities / 2) * kNumTimestamps);
+		ScanEntities(table, &source, read_options, false, &absent_reads);
+		if (mode != 0) {
+			// Only filter false positives read a block
+			assert(absent_reads * 4 < present_reads);
+		}
+
+		// A prefix seek stops at the end of the prefix, a plain one does not
+		Iterator* iter = table->NewIterator(read_options);
+		iter->Seek(MakeEntityPrefix(3, 4));
+		for (int ts = 0; ts < kNumTimestamps; ts++) {
+			assert(iter->Valid());
+			iter->Next();
+		}
+		assert(iter->Valid() == (mode == 0));
+		delete iter;
+
+		std::cout << labels[mode] << sink.contents().size() << " bytes, "
+			<< present_reads << " reads for stored entities, "
+			<< absent_reads << " reads for absent entities" << std::endl;
+		delete table;
+	}
+
+	delete extractor;
+	delete policy;
+}
@@ -0,0 +1,104 @@
+#include <assert.h>
+#include <stdio.h>
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "include/leveldb/env.h"
+#include "include/leveldb/options.h"
+#include "include/leveldb/table.h"
+#include "include/leveldb/table_builder.h"
+#include "test/testutil.h"
+#include "util/random.h"
+
+using namespace leveldb;
+
+static std::string MakeRangeKey(uint32_t v)
+{
+	char buf[32];
+	snprintf(buf, sizeof(buf), "user%08x", v);
+	return std::string(buf);
+}
+
+// Short range queries [v, v + width) on a table of random keys, answered
+// by the range filter and by seeking an iterator, which reads a block.
+void RangeFilterTest()
+{
+	const int kNumKeys = 100000;
+	const int kNumQueries = 100000;
+	const uint32_t kWidths[] = { 16, 4096 };
+	Env* env = Env::Default();
+
+	Random rnd(301);
+	std::vector<uint32_t> values;
+	for (int i = 0; i < kNumKeys; i++) {
+		values.push_back(rnd.Next());
+	}
+	std::sort(values.begin(), values.end());
+	values.erase(std::unique(values.begin(), values.end()), values.end());
+
+	Options options;
+	options.compression = kNoCompression;
+	options.range_filter = true;
+	test::StringSink sink;
+	TableBuilder builder(options, &sink);
+	for (size_t i = 0; i < values.size(); i++) {
+		builder.Add(MakeRangeKey(values[i]), "v");
+	}
+	Status s = builder.Finish();
+	assert(s.ok());
+
+	test::StringSource source(sink.contents());
+	Table* table = NULL;
+	s = Table::Open(options, &source, source.Size(), &table);
+	assert(s.ok());
+	const TableProperties& props = table->properties();
+	assert(props.range_filter_size > 0);
+	std::cout << "range filter: " << props.range_filter_size << " bytes, "
+		<< props.range_filter_size * 8.0 / props.num_entries << " bits/key, keys "
+		<< props.raw_key_size << " bytes" << std::endl;
+
+	for (size_t w = 0; w < sizeof(kWidths) / sizeof(kWidths[0]); w++) {
+		std::vector<std::string> starts, limits;
+		std::vector<bool> nonempty;
+		for (int i = 0; i < kNumQueries; i++) {
+			uint32_t v = rnd.Next();
+			starts.push_back(MakeRangeKey(v));
+			limits.push_back(MakeRangeKey(v + kWidths[w]));
+			std::vector<uint32_t>::iterator it = std::lower_bound(values.begin(), values.end(), v);
+			nonempty.push_back(it != values.end() && *it < v + kWidths[w]);
+		}
+
+		uint64_t start = env->NowMicros();
+		int empty = 0, false_positives = 0;
+		for (int i = 0; i < kNumQueries; i++) {
+			bool may_match = table->RangeMayMatch(starts[i], limits[i]);
+			if (nonempty[i]) {
+				assert(may_match);
+			} else {
+				empty++;
+				false_positives += may_match;
+			}
+		}
+		const double filter_micros = double(env->NowMicros() - start);
+
+		ReadOptions read_options;
+		Iterator* iter = table->NewIterator(read_options);
+		source.ResetCounters();
+		start = env->NowMicros();
+		for (int i = 0; i < kNumQueries; i++) {
+			iter->Seek(starts[i]);
+			bool found = iter->Valid() && iter->key().compare(limits[i]) < 0;
+			assert(found == nonempty[i]);
+		}
+		const double seek_micros = double(env->NowMicros() - start);
+		delete iter;
+
+		std::cout << "width " << kWidths[w] << ": "
+			<< filter_micros * 1000 / kNumQueries << " ns/query filtered, "
+			<< seek_micros * 1000 / kNumQueries << " ns/query by seek ("
+			<< source.reads() << " reads), "
+			<< 100.0 * false_positives / empty << "% false positives" << std::endl;
+	}
+	delete table;
+}
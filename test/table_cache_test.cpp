@@ -0,0 +1,189 @@
+#include <assert.h>
+#include <stdio.h>
+#include <iostream>
+#include "db/filename.h"
+#include "db/table_cache.h"
+#include "include/leveldb/env.h"
+#include "include/leveldb/options.h"
+#include "include/leveldb/table.h"
+#include "include/leveldb/table_builder.h"
+
+using namespace leveldb;
+
+// Counts the table files opened and still open.
+class CountingFileEnv : public EnvWrapper {
+public:
+	explicit CountingFileEnv(Env* target) : EnvWrapper(target), opened(0), open(0) { }
+
+	virtual Status NewRandomAccessFile(const std::string& f, const RandomAccessFileOptions& o,
+		RandomAccessFile** r) {
+		RandomAccessFile* file;
+		Status s = target()->NewRandomAccessFile(f, o, &file);
+		if (s.ok()) {
+			opened++;
+			open++;
+			*r = new CountedFile(this, file);
+		} else {
+			*r = NULL;
+		}
+		return s;
+	}
+
+	int opened;
+	int open;
+
+private:
+	class CountedFile : public RandomAccessFile {
+	public:
+		CountedFile(CountingFileEnv* env, RandomAccessFile* file) : env_(env), file_(file) { }
+		virtual ~CountedFile() {
+			env_->open--;
+			delete file_;
+		}
+		virtual Status Read(uint64_t offset, size_t n, Slice* result, char* scratch) const {
+			return file_->Read(offset, n, result, scratch);
+		}
+		virtual bool ReturnsStablePointers() const { return file_->ReturnsStablePointers(); }
+		virtual void Hint(AccessPattern pattern) { file_->Hint(pattern); }
+
+	private:
+		CountingFileEnv* env_;
+		RandomAccessFile* file_;
+	};
+};
+
+static void SaveTableCacheValue(void* arg, const Slice& k, const Slice& v)
+{
+	reinterpret_cast<std::string*>(arg)->assign(v.data(), v.size());
+}
+
+static std::string TableCacheKey(uint64_t file_number, int i)
+{
+	char buf[32];
+	snprintf(buf, sizeof(buf), "t%03d-key%05d", static_cast<int>(file_number), i);
+	return buf;
+}
+
+// Tables opened once and then served from the cache, the number of open
+// files kept below the limit, and reads through the cache against opening
+// the table for every read.
+void TableCacheTest()
+{
+	CountingFileEnv env(Env::Default());
+	const std::string dbname = ".";
+	Options options;
+	options.compression = kNoCompression;
+	const int kNumTables = 64;
+	const int kKeysPerTable = 1000;
+	uint64_t file_sizes[kNumTables + 1];
+	for (uint64_t number = 1; number <= kNumTables; number++) {
+		WritableFile* file;
+		Status s = env.NewWritableFile(TableFileName(dbname, number), &file);
+		assert(s.ok());
+		TableBuilder builder(options, file);
+		for (int i = 0; i < kKeysPerTable; i++) {
+			builder.Add(TableCacheKey(number, i), std::string(100, 'v'));
+		}
+		s = builder.Finish();
+		assert(s.ok());
+		file_sizes[number] = builder.FileSize();
+		s = file->Close();
+		assert(s.ok());
+		delete file;
+	}
+
+	// Every table is opened once, however often it is read
+	TableCache* cache = new TableCache(dbname, options, &env, 1000);
+	for (int round = 0; round < 3; round++) {
+		for (uint64_t number = 1; number <= kNumTables; number++) {
+			std::string value;
+			Status s = cache->Get(ReadOptions(), number, file_sizes[number],
+				TableCacheKey(number, 7), &value, &SaveTableCacheValue);
+			assert(s.ok() && value == std::string(100, 'v'));
+		}
+	}
+	assert(env.opened == kNumTables && env.open == kNumTables);
+
+	Table* table;
+	Iterator* iter = cache->NewIterator(ReadOptions(), 1, file_sizes[1], &table);
+	int count = 0;
+	for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+		count++;
+	}
+	assert(iter->status().ok() && count == kKeysPerTable && table != NULL);
+	// Evicting a table in use closes it once the iterator is gone
+	cache->Evict(1);
+	assert(env.open == kNumTables);
+	delete iter;
+	assert(env.open == kNumTables - 1);
+	std::string value;
+	Status s = cache->Get(ReadOptions(), 1, file_sizes[1], TableCacheKey(1, 0), &value,
+		&SaveTableCacheValue);
+	assert(s.ok() && env.opened == kNumTables + 1);
+
+	// Missing files are errors, and are not cached
+	iter = cache->NewIterator(ReadOptions(), kNumTables + 1, 1000, &table);
+	assert(!iter->status().ok() && table == NULL);
+	delete iter;
+	delete cache;
+	assert(env.open == 0);
+
+	// A limit of 10 open tables, which keeps the 10 most recently read
+	const int kMaxOpen = 10;
+	cache = new TableCache(dbname, options, &env, kMaxOpen);
+	int max_open = 0;
+	for (uint64_t number = 1; number <= kNumTables; number++) {
+		s = cache->Get(ReadOptions(), number, file_sizes[number], TableCacheKey(number, 0),
+			&value, &SaveTableCacheValue);
+		assert(s.ok());
+		if (env.open > max_open) {
+			max_open = env.open;
+		}
+	}
+	assert(max_open == kMaxOpen && env.open == kMaxOpen);
+	const int opened = env.opened;
+	for (uint64_t number = kNumTables - kMaxOpen + 1; number <= kNumTables; number++) {
+		s = cache->Get(ReadOptions(), number, file_sizes[number], TableCacheKey(number, 1),
+			&value, &SaveTableCacheValue);
+		assert(s.ok());
+	}
+	assert(env.opened == opened);
+
+	// Reads through the cache against opening the table for each read
+	const int kReads = 20000;
+	delete cache;
+	cache = new TableCache(dbname, options, &env, 1000);
+	uint64_t start = env.NowMicros();
+	for (int i = 0; i < kReads; i++) {
+		const uint64_t number = 1 + i % kNumTables;
+		s = cache->Get(ReadOptions(), number, file_sizes[number],
+			TableCacheKey(number, (i * 7) % kKeysPerTable), &value, &SaveTableCacheValue);
+		assert(s.ok());
+	}
+	const uint64_t cached_micros = env.NowMicros() - start;
+	delete cache;
+
+	start = env.NowMicros();
+	for (int i = 0; i < kReads; i++) {
+		const uint64_t number = 1 + i % kNumTables;
+		RandomAccessFile* file;
+		s = env.NewRandomAccessFile(TableFileName(dbname, number), RandomAccessFileOptions(),
+			&file);
+		assert(s.ok());
+		s = Table::Open(options, file, file_sizes[number], &table);
+		assert(s.ok());
+		iter = table->NewIterator(ReadOptions());
+		iter->Seek(TableCacheKey(number, (i * 7) % kKeysPerTable));
+		assert(iter->Valid());
+		delete iter;
+		delete table;
+		delete file;
+	}
+	const uint64_t uncached_micros = env.NowMicros() - start;
+	std::cout << "table cache:      " << kReads * 1e6 / cached_micros << " reads/s" << std::endl;
+	std::cout << "open every read:  " << kReads * 1e6 / uncached_micros << " reads/s" << std::endl;
+
+	for (uint64_t number = 1; number <= kNumTables; number++) {
+		env.RemoveFile(TableFileName(dbname, number));
+	}
+}
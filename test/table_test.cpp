@@ -0,0 +1,278 @@
+#include <assert.h>
+#include <stdio.h>
+#include <time.h>
+#include <iostream>
+#include <vector>
+#include "include/leveldb/filter_policy.h"
+#include "include/leveldb/options.h"
+#include "include/leveldb/table.h"
+#include "include/leveldb/table_builder.h"
+#include "test/testutil.h"
+#include "util/coding.h"
+#include "util/random.h"
+
+using namespace leveldb;
+
+static std::string MakeKey(int i)
+{
+	char buf[32];
+	snprintf(buf, sizeof(buf), "key%08d", i);
+	return std::string(buf);
+}
+
+struct MultiGetState {
+	const Slice* keys;
+	int found;
+	int checksum;
+};
+
+static void SaveMultiGetResult(void* arg, int index, const Slice& k, const Slice& v)
+{
+	MultiGetState* state = reinterpret_cast<MultiGetState*>(arg);
+	if (k == state->keys[index]) {
+		state->found++;
+		state->checksum += static_cast<unsigned char>(v[0]);
+	}
+}
+
+void TableMultiGetTest()
+{
+	const int kNumEntries = 100000;
+	const int kBatchSize = 1000;
+	const int kRounds = 20;
+
+	Options options;
+	options.compression = kNoCompression;
+
+	test::StringSink sink;
+	TableBuilder builder(options, &sink);
+	std::string value(100, 'v');
+	for (int i = 0; i < kNumEntries; i += 2) {
+		value[0] = static_cast<char>('a' + i % 26);
+		builder.Add(MakeKey(i), value);
+	}
+	Status s = builder.Finish();
+	assert(s.ok());
+
+	test::StringSource source(sink.contents());
+	Table* table = NULL;
+	s = Table::Open(options, &source, source.Size(), &table);
+	assert(s.ok());
+
+	// A batch of clustered keys, half of which are absent, the way a
+	// handler resolving a range of related ids would issue them.
+	Random rnd(301);
+	std::vector<std::string> batch;
+	int base = rnd.Uniform(kNumEntries - kBatchSize);
+	for (int i = 0; i < kBatchSize; i++) {
+		batch.push_back(MakeKey(base + rnd.Uniform(kBatchSize)));
+	}
+	std::vector<Slice> slices(batch.begin(), batch.end());
+
+	ReadOptions ropts;
+	MultiGetState single = { NULL, 0, 0 };
+	source.ResetCounters();
+	clock_t start = clock();
+	for (int r = 0; r < kRounds; r++) {
+		for (int i = 0; i < kBatchSize; i++) {
+			single.keys = &slices[i];
+			s = table->MultiGet(ropts, &slices[i], 1, &single, &SaveMultiGetResult);
+			assert(s.ok());
+		}
+	}
+	double single_secs = double(clock() - start) / CLOCKS_PER_SEC;
+	uint64_t single_reads = source.reads();
+
+	MultiGetState batched = { &slices[0], 0, 0 };
+	source.ResetCounters();
+	start = clock();
+	for (int r = 0; r < kRounds; r++) {
+		s = table->MultiGet(ropts, &slices[0], kBatchSize, &batched, &SaveMultiGetResult);
+		assert(s.ok());
+	}
+	double batched_secs = double(clock() - start) / CLOCKS_PER_SEC;
+	uint64_t batched_reads = source.reads();
+
+	assert(single.found == batched.found);
+	assert(single.checksum == batched.checksum);
+
+	std::cout << "one key at a time: " << single_reads / kRounds << " reads, "
+		<< (kBatchSize * kRounds) / single_secs << " keys/s" << std::endl;
+	std::cout << "MultiGet:          " << batched_reads / kRounds << " reads, "
+		<< (kBatchSize * kRounds) / batched_secs << " keys/s" << std::endl;
+	std::cout << "found " << batched.found / kRounds << " of " << kBatchSize << std::endl;
+
+	delete table;
+}
+
+namespace {
+
+// An exact "filter" that simply stores every key.  Good enough to give
+// tables a filter block without depending on a real filter policy.
+class KeyListPolicy : public FilterPolicy {
+public:
+	virtual const char* Name() const { return "test.KeyListPolicy"; }
+
+	virtual void CreateFilter(const Slice* keys, int n, std::string* dst) const {
+		for (int i = 0; i < n; i++) {
+			PutLengthPrefixedSlice(dst, keys[i]);
+		}
+	}
+
+	virtual bool KeyMayMatch(const Slice& key, const Slice& filter) const {
+		Slice input = filter;
+		Slice k;
+		while (GetLengthPrefixedSlice(&input, &k)) {
+			if (k == key) {
+				return true;
+			}
+		}
+		return false;
+	}
+};
+
+}  // namespace
+
+static void OpenTables(const Options& options, test::StringSource* source, int n)
+{
+	for (int i = 0; i < n; i++) {
+		Table* table = NULL;
+		Status s = Table::Open(options, source, source->Size(), &table);
+		assert(s.ok());
+		delete table;
+	}
+}
+
+void TableOpenTest()
+{
+	const int kNumOpens = 2000;
+	// Typical round trip of a read on a network-attached volume
+	const double kReadLatencyMicros = 500;
+
+	KeyListPolicy policy;
+	Options options;
+	options.compression = kNoCompression;
+	options.filter_policy = &policy;
+
+	test::StringSink sink;
+	TableBuilder builder(options, &sink);
+	std::string value(100, 'v');
+	for (int i = 0; i < 2000; i++) {
+		builder.Add(MakeKey(i), value);
+	}
+	Status s = builder.Finish();
+	assert(s.ok());
+	test::StringSource source(sink.contents());
+
+	options.tail_prefetch_size = 0;
+	source.ResetCounters();
+	clock_t start = clock();
+	OpenTables(options, &source, kNumOpens);
+	double separate_secs = double(clock() - start) / CLOCKS_PER_SEC;
+	uint64_t separate_reads = source.reads();
+
+	options.tail_prefetch_size = 64 * 1024;
+	source.ResetCounters();
+	start = clock();
+	OpenTables(options, &source, kNumOpens);
+	double prefetch_secs = double(clock() - start) / CLOCKS_PER_SEC;
+	uint64_t prefetch_reads = source.reads();
+
+	double separate_micros = separate_secs * 1e6 / kNumOpens;
+	double prefetch_micros = prefetch_secs * 1e6 / kNumOpens;
+	std::cout << "separate reads: " << double(separate_reads) / kNumOpens << " reads/open, "
+		<< separate_micros << " us/open in memory, "
+		<< separate_micros + kReadLatencyMicros * separate_reads / kNumOpens
+		<< " us/open at " << kReadLatencyMicros << " us/read" << std::endl;
+	std::cout << "tail prefetch:  " << double(prefetch_reads) / kNumOpens << " reads/open, "
+		<< prefetch_micros << " us/open in memory, "
+		<< prefetch_micros + kReadLatencyMicros * prefetch_reads / kNumOpens
+		<< " us/open at " << kReadLatencyMicros << " us/read" << std::endl;
+}
+
+// Builds a table with "options" from "num_entries" values made by
+// (*value)(i), then reads every entry back by iteration, with MultiGet(),
+// through a block cache and from a memory-mapped source.
+static std::string CheckTableRoundTrip(const Options& options, int num_entries,
+	std::string (*value)(int))
+{
+	test::StringSink sink;
+	TableBuilder builder(options, &sink);
+	for (int i = 0; i < num_entries; i++) {
+		builder.Add(MakeKey(i), (*value)(i));
+	}
+	Status s = builder.Finish();
+	assert(s.ok());
+
+	for (int mmap = 0; mmap < 2; mmap++) {
+		test::StringSource source(sink.contents(), mmap != 0);
+		Table* table = NULL;
+		s = Table::Open(options, &source, source.Size(), &table);
+		assert(s.ok());
+		Iterator* iter = table->NewIterator(ReadOptions());
+		int i = 0;
+		for (iter->SeekToFirst(); iter->Valid(); iter->Next(), i++) {
+			assert(iter->key() == MakeKey(i) && iter->value() == (*value)(i));
+		}
+		assert(iter->status().ok() && i == num_entries);
+		delete iter;
+
+		std::vector<std::string> key_strings;
+		for (i = 0; i < num_entries; i += 7) {
+			key_strings.push_back(MakeKey(i));
+		}
+		std::vector<Slice> keys(key_strings.begin(), key_strings.end());
+		MultiGetState state;
+		state.keys = &keys[0];
+		state.found = 0;
+		state.checksum = 0;
+		s = table->MultiGet(ReadOptions(), &keys[0], static_cast<int>(keys.size()), &state,
+			&SaveMultiGetResult);
+		assert(s.ok() && state.found == static_cast<int>(keys.size()));
+		delete table;
+	}
+	return sink.contents();
+}
+
+static std::string CompressibleValue(int i)
+{
+	return std::string(100, static_cast<char>('a' + i % 26));
+}
+
+static std::string IncompressibleValue(int i)
+{
+	Random rnd(i + 1);
+	std::string result;
+	for (int k = 0; k < 100; k++) {
+		result.push_back(static_cast<char>(rnd.Uniform(256)));
+	}
+	return result;
+}
+
+// Tables written and read with the default options, which compress
+// blocks with Snappy, against uncompressed tables.
+void TableCompressionTest()
+{
+	const int kNumEntries = 20000;
+	Options options;
+	assert(options.compression == kSnappyCompression);
+	Cache* cache = NewLRUCache(1024 * 1024);
+	const std::string compressed = CheckTableRoundTrip(options, kNumEntries, &CompressibleValue);
+	options.block_cache = cache;
+	CheckTableRoundTrip(options, kNumEntries, &CompressibleValue);
+	options.block_cache = NULL;
+
+	// Blocks that do not shrink are stored as they are
+	const std::string incompressible = CheckTableRoundTrip(options, kNumEntries,
+		&IncompressibleValue);
+
+	options.compression = kNoCompression;
+	const std::string uncompressed = CheckTableRoundTrip(options, kNumEntries,
+		&CompressibleValue);
+	assert(compressed.size() * 4 < uncompressed.size());
+	const size_t raw_size = CheckTableRoundTrip(options, kNumEntries, &IncompressibleValue).size();
+	assert(incompressible.size() <= raw_size && incompressible.size() * 10 > raw_size * 9);
+	std::cout << "snappy: " << compressed.size() << " bytes, uncompressed: "
+		<< uncompressed.size() << " bytes" << std::endl;
+	delete cache;
+}
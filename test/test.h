@@ -6,4 +6,48 @@ extern void SkipListTest();
 
 extern void MemTableTest();
 
+extern void TableMultiGetTest();
+
+extern void TableOpenTest();
+
+extern void TableCompressionTest();
+
+extern void PlainTableTest();
+
+extern void CuckooTableTest();
+
+extern void BlobFileTest();
+
+extern void ParallelTableWriterTest();
+
+extern void BufferedWritableFileTest();
+
+extern void BloomFilterTest();
+
+extern void BinaryFuseFilterTest();
+
+extern void PrefixSeekTest();
+
+extern void RangeFilterTest();
+
+extern void FilterBuildTest();
+
+extern void CacheTest();
+
+extern void ClockCacheTest();
+
+extern void CachePriorityTest();
+
+extern void TinyLFUTest();
+
+extern void CompressedCacheTest();
+
+extern void PersistentCacheTest();
+
+extern void TableCacheTest();
+
+extern void CacheStatisticsTest();
+
+extern void EnvPosixTest();
+
 #endif
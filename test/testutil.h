@@ -0,0 +1,211 @@
+#ifndef STORAGE_LEVELDB_TEST_TESTUTIL_H_
+#define STORAGE_LEVELDB_TEST_TESTUTIL_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "include/leveldb/cache.h"
+#include "include/leveldb/env.h"
+#include "include/leveldb/slice.h"
+#include "include/leveldb/status.h"
+#include "port/port.h"
+#include "util/coding.h"
+#include "util/mutexlock.h"
+
+namespace leveldb {
+namespace test {
+
+// A WritableFile that appends everything to an in-memory string.
+class StringSink : public WritableFile {
+public:
+	virtual Status Append(const Slice& data) {
+		contents_.append(data.data(), data.size());
+		return Status::OK();
+	}
+	virtual Status Close() { return Status::OK(); }
+	virtual Status Flush() { return Status::OK(); }
+	virtual Status Sync() { return Status::OK(); }
+
+	const std::string& contents() const { return contents_; }
+
+private:
+	std::string contents_;
+};
+
+// A RandomAccessFile over an in-memory string that counts the reads
+// issued against it.  With "stable_pointers" it behaves like a
+// memory-mapped file and returns pointers into the string.
+class StringSource : public RandomAccessFile {
+public:
+	explicit StringSource(const Slice& contents, bool stable_pointers = false)
+		: contents_(contents.data(), contents.size()),
+		  stable_pointers_(stable_pointers),
+		  reads_(0),
+		  bytes_read_(0) {
+	}
+
+	uint64_t Size() const { return contents_.size(); }
+
+	virtual Status Read(uint64_t offset, size_t n, Slice* result,
+		char* scratch) const {
+		reads_++;
+		if (offset > contents_.size()) {
+			return Status::InvalidArgument("invalid Read offset");
+		}
+		if (offset + n > contents_.size()) {
+			n = contents_.size() - static_cast<size_t>(offset);
+		}
+		bytes_read_ += n;
+		if (stable_pointers_) {
+			*result = Slice(contents_.data() + offset, n);
+		} else {
+			memcpy(scratch, &contents_[static_cast<size_t>(offset)], n);
+			*result = Slice(scratch, n);
+		}
+		return Status::OK();
+	}
+
+	virtual bool ReturnsStablePointers() const { return stable_pointers_; }
+
+	// Have GetUniqueId() return "id", as for the file the contents stand for.
+	void SetUniqueId(const std::string& id) { unique_id_ = id; }
+
+	virtual size_t GetUniqueId(char* id, size_t max_size) const {
+		if (unique_id_.size() > max_size) {
+			return 0;
+		}
+		memcpy(id, unique_id_.data(), unique_id_.size());
+		return unique_id_.size();
+	}
+
+	uint64_t reads() const { return reads_; }
+	uint64_t bytes_read() const { return bytes_read_; }
+	void ResetCounters() { reads_ = 0; bytes_read_ = 0; }
+
+private:
+	std::string contents_;
+	const bool stable_pointers_;
+	std::string unique_id_;
+	mutable uint64_t reads_;
+	mutable uint64_t bytes_read_;
+};
+
+// Helpers for the tests of Cache implementations.  Keys are fixed32
+// encodings of ints, and values are ints carried in the value pointer.
+
+// Number of entries handed to CountingCacheDeleter(), from any thread.
+inline port::AtomicUint64* DeletedCacheEntries() {
+	static port::AtomicUint64 deleted;
+	return &deleted;
+}
+
+inline void CountingCacheDeleter(const Slice& key, void* value) {
+	DeletedCacheEntries()->FetchAdd(1);
+}
+
+inline void NoopCacheDeleter(const Slice& key, void* value) {
+}
+
+inline std::string EncodeCacheKey(int k) {
+	std::string result;
+	PutFixed32(&result, k);
+	return result;
+}
+
+inline void* EncodeCacheValue(int v) {
+	return reinterpret_cast<void*>(static_cast<uintptr_t>(v));
+}
+
+inline int DecodeCacheValue(void* v) {
+	return static_cast<int>(reinterpret_cast<uintptr_t>(v));
+}
+
+// Insert "value" under "key" and release the handle.  The entry goes to
+// CountingCacheDeleter().
+inline void CacheInsert(Cache* cache, int key, int value, int charge = 1) {
+	cache->Release(cache->Insert(EncodeCacheKey(key), EncodeCacheValue(value), charge,
+		&CountingCacheDeleter));
+}
+
+// Returns the value cached for "key", or -1.
+inline int CacheLookup(Cache* cache, int key) {
+	Cache::Handle* handle = cache->Lookup(EncodeCacheKey(key));
+	const int r = (handle == NULL) ? -1 : DecodeCacheValue(cache->Value(handle));
+	if (handle != NULL) {
+		cache->Release(handle);
+	}
+	return r;
+}
+
+// Looks "key" up as a block reader does, inserting it on a miss.
+// Returns whether it was a hit.
+inline bool CacheAccess(Cache* cache, int key) {
+	const std::string k = EncodeCacheKey(key);
+	Cache::Handle* handle = cache->Lookup(k);
+	const bool hit = (handle != NULL);
+	if (!hit) {
+		handle = cache->Insert(k, NULL, 1, &NoopCacheDeleter);
+	}
+	cache->Release(handle);
+	return hit;
+}
+
+// One of the threads that RunCacheThreads() starts.
+struct CacheThreadState {
+	Cache* cache;
+	int num_ops;
+	int num_keys;
+	uint32_t seed;
+	void (*body)(CacheThreadState* state);
+	port::Mutex* mu;
+	port::CondVar* cv;
+	int* running;
+};
+
+inline void CacheThreadMain(void* arg) {
+	CacheThreadState* state = reinterpret_cast<CacheThreadState*>(arg);
+	(*state->body)(state);
+	MutexLock l(state->mu);
+	(*state->running)--;
+	state->cv->SignalAll();
+}
+
+// Run "body" on "cache" in "threads" threads at once, each with its own
+// seed, and return the microseconds until the last one finished.
+inline uint64_t RunCacheThreads(Cache* cache, int threads, int num_ops, int num_keys,
+	void (*body)(CacheThreadState* state)) {
+	Env* env = Env::Default();
+	port::Mutex mu;
+	port::CondVar cv(&mu);
+	int running = threads;
+	std::vector<CacheThreadState> states(threads);
+	const uint64_t start = env->NowMicros();
+	for (int i = 0; i < threads; i++) {
+		states[i].cache = cache;
+		states[i].num_ops = num_ops;
+		states[i].num_keys = num_keys;
+		states[i].seed = 301 + i;
+		states[i].body = body;
+		states[i].mu = &mu;
+		states[i].cv = &cv;
+		states[i].running = &running;
+		env->StartThread(&CacheThreadMain, &states[i]);
+	}
+	mu.Lock();
+	while (running > 0) {
+		cv.Wait();
+	}
+	mu.Unlock();
+	return env->NowMicros() - start;
+}
+
+// Table::MultiGet() callback that counts the keys found in *arg, an int.
+inline void CountFound(void* arg, int index, const Slice& k, const Slice& v) {
+	(*reinterpret_cast<int*>(arg))++;
+}
+
+}  // namespace test
+}  // namespace leveldb
+
+#endif  // STORAGE_LEVELDB_TEST_TESTUTIL_H_
@@ -0,0 +1,82 @@
+#include <assert.h>
+#include <stdio.h>
+#include <iostream>
+#include "include/leveldb/cache.h"
+#include "test/testutil.h"
+#include "util/random.h"
+
+using namespace leveldb;
+
+// Point lookups of skewed popularity, interleaved every
+// "lookups_per_scan" lookups with a scan of never repeated keys when
+// "scan_length" is non-zero.  Returns the hit rate of the point lookups.
+static double RunTinyLFUTrace(Cache* cache, int lookups_per_scan, int scan_length)
+{
+	Random rnd(301);
+	const int kLookups = 200000;
+	int next_scan_key = 1000000;
+	int hits = 0;
+	for (int i = 0; i < kLookups; i++) {
+		hits += test::CacheAccess(cache, rnd.Skewed(14));
+		if (scan_length > 0 && i % lookups_per_scan == lookups_per_scan - 1) {
+			for (int j = 0; j < scan_length; j++) {
+				test::CacheAccess(cache, next_scan_key++);
+			}
+		}
+	}
+	return double(hits) / kLookups;
+}
+
+// Admission by frequency keeps a hot set cached through a flood of keys
+// seen once, then hit rates of LRU and TinyLFU on a point lookup trace
+// with and without scans mixed in.
+void TinyLFUTest()
+{
+	const int kCapacity = 2000;
+	Cache* caches[] = { NewLRUCache(kCapacity), NewTinyLFUCache(kCapacity, 1) };
+	for (int c = 0; c < 2; c++) {
+		Cache* cache = caches[c];
+		assert(!test::CacheAccess(cache, 7));
+		assert(test::CacheAccess(cache, 7));
+		cache->Erase(test::EncodeCacheKey(7));
+		assert(!test::CacheAccess(cache, 7));
+
+		for (int round = 0; round < 5; round++) {
+			for (int k = 0; k < 100; k++) {
+				test::CacheAccess(cache, k);
+			}
+		}
+		for (int k = 10000; k < 15000; k++) {
+			test::CacheAccess(cache, k);
+		}
+		int survivors = 0;
+		for (int k = 0; k < 100; k++) {
+			Cache::Handle* handle = cache->Lookup(test::EncodeCacheKey(k));
+			if (handle != NULL) {
+				survivors++;
+				cache->Release(handle);
+			}
+		}
+		if (c == 0) {
+			assert(survivors == 0);
+		} else {
+			assert(survivors >= 95);
+		}
+		assert(cache->TotalCharge() <= kCapacity + 16);
+		cache->Prune();
+		assert(cache->TotalCharge() == 0);
+		delete cache;
+	}
+
+	const char* labels[] = { "lru:     ", "tinylfu: " };
+	for (int c = 0; c < 2; c++) {
+		Cache* cache = (c == 0 ? NewLRUCache(kCapacity) : NewTinyLFUCache(kCapacity, 1));
+		const double points_only = RunTinyLFUTrace(cache, 0, 0);
+		delete cache;
+		cache = (c == 0 ? NewLRUCache(kCapacity) : NewTinyLFUCache(kCapacity, 1));
+		const double with_scans = RunTinyLFUTrace(cache, 1000, 4000);
+		delete cache;
+		std::cout << labels[c] << 100 * points_only << "% hits on point lookups alone, "
+			<< 100 * with_scans << "% with scans" << std::endl;
+	}
+}
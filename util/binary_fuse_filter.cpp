@@ -0,0 +1,265 @@
+#include "include/leveldb/filter_policy.h"
+
+#include <math.h>
+#include <algorithm>
+#include <vector>
+#include "include/leveldb/slice.h"
+#include "util/coding.h"
+#include "util/hash.h"
+
+namespace leveldb {
+
+namespace {
+
+// A binary fuse filter (Graf & Lemire, "Binary Fuse Filters: Fast and
+// Smaller Than Xor Filters") stores one fingerprint_bits wide slot per
+// ~1.125 keys for large key sets.  A key hashes to three slots in three
+// consecutive segments of the slot array, and the slots are filled so
+// that the xor of a key's three slots equals the key's fingerprint.  The
+// false positive rate is 2^-fingerprint_bits.
+//
+// Encoding:
+//    slots, fingerprint_bits each, packed little-endian, plus 4 bytes of
+//    padding so that any slot can be read with one 32-bit load
+//    fixed64 seed
+//    fixed32 segment_length
+//    fixed32 segment_count_length (number of slots a first position can
+//            fall in; zero for an empty filter)
+//    1 byte  fingerprint_bits
+static const size_t kMetadataSize = 8 + 4 + 4 + 1;
+
+static const int kArity = 3;
+
+static const int kMaxConstructionAttempts = 100;
+
+// The mixing function of MurmurHash3's 64-bit finalizer.
+static uint64_t Mix64(uint64_t h) {
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdull;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ull;
+	h ^= h >> 33;
+	return h;
+}
+
+static uint64_t KeyHash(const Slice& key) {
+	return (static_cast<uint64_t>(Hash(key.data(), key.size(), 0x8d4f2b19)) << 32) |
+		Hash(key.data(), key.size(), 0x1b873593);
+}
+
+// High 64 bits of the 128-bit product a*b.
+static uint64_t MulHi(uint64_t a, uint64_t b) {
+	const uint64_t a_lo = static_cast<uint32_t>(a), a_hi = a >> 32;
+	const uint64_t b_lo = static_cast<uint32_t>(b), b_hi = b >> 32;
+	const uint64_t lo_lo = a_lo * b_lo;
+	const uint64_t hi_lo = a_hi * b_lo;
+	const uint64_t lo_hi = a_lo * b_hi;
+	const uint64_t cross = (lo_lo >> 32) + static_cast<uint32_t>(hi_lo) + lo_hi;
+	return (hi_lo >> 32) + (cross >> 32) + a_hi * b_hi;
+}
+
+struct Layout {
+	uint32_t segment_length;
+	uint32_t segment_count_length;
+	uint32_t array_length;
+
+	// Sizes for n keys, using the parameters recommended by the paper
+	// for three hash functions.
+	explicit Layout(size_t n) {
+		const double size = static_cast<double>(n < 2 ? 2 : n);
+		segment_length = 1u << static_cast<int>(floor(log(size) / log(3.33) + 2.25));
+		if (segment_length > 262144) segment_length = 262144;
+		const double size_factor = std::max(1.125, 0.875 + 0.25 * log(1000000.0) / log(size));
+		const uint32_t capacity = static_cast<uint32_t>(size * size_factor + 0.5);
+		uint32_t segment_count = (capacity + segment_length - 1) / segment_length;
+		segment_count = (segment_count > kArity - 1 ? segment_count - (kArity - 1) : 1);
+		segment_count_length = segment_count * segment_length;
+		array_length = (segment_count + kArity - 1) * segment_length;
+	}
+
+	Layout(uint32_t length, uint32_t count_length)
+		: segment_length(length),
+		  segment_count_length(count_length),
+		  array_length(count_length + (kArity - 1) * length) {
+	}
+
+	void Slots(uint64_t hash, uint32_t slots[kArity]) const {
+		const uint32_t mask = segment_length - 1;
+		slots[0] = static_cast<uint32_t>(MulHi(hash, segment_count_length));
+		slots[1] = (slots[0] + segment_length) ^ (static_cast<uint32_t>(hash >> 18) & mask);
+		slots[2] = (slots[1] + segment_length) ^ (static_cast<uint32_t>(hash) & mask);
+	}
+};
+
+static uint32_t Fingerprint(uint64_t hash, int bits) {
+	return static_cast<uint32_t>(hash ^ (hash >> 32)) & ((1u << bits) - 1);
+}
+
+static uint32_t GetSlot(const char* array, uint32_t i, int bits) {
+	const uint64_t bit = static_cast<uint64_t>(i) * bits;
+	return (DecodeFixed32(array + bit / 8) >> (bit % 8)) & ((1u << bits) - 1);
+}
+
+static void SetSlot(char* array, uint32_t i, int bits, uint32_t value) {
+	const uint64_t bit = static_cast<uint64_t>(i) * bits;
+	uint32_t word = DecodeFixed32(array + bit / 8);
+	word &= ~(((1u << bits) - 1) << (bit % 8));
+	word |= value << (bit % 8);
+	EncodeFixed32(array + bit / 8, word);
+}
+
+class BinaryFuseFilterPolicy : public FilterPolicy {
+private:
+	int fingerprint_bits_;
+
+	// Try to fill the slots for "hashes" mixed with "seed".  Returns false
+	// if the hashes do not peel, in which case another seed is needed.
+	bool Build(const std::vector<uint64_t>& hashes, uint64_t seed,
+		const Layout& layout, char* array) const {
+		const size_t n = hashes.size();
+		std::vector<uint32_t> count(layout.array_length, 0);
+		std::vector<uint64_t> xor_hash(layout.array_length, 0);
+		uint32_t slots[kArity];
+		for (size_t i = 0; i < n; i++) {
+			const uint64_t h = Mix64(hashes[i] + seed);
+			layout.Slots(h, slots);
+			for (int j = 0; j < kArity; j++) {
+				count[slots[j]]++;
+				xor_hash[slots[j]] ^= h;
+			}
+		}
+
+		// Peel: repeatedly take a slot that only one key maps to, which
+		// is that key's slot to set, and remove the key.
+		std::vector<uint32_t> queue;
+		for (uint32_t i = 0; i < layout.array_length; i++) {
+			if (count[i] == 1) queue.push_back(i);
+		}
+		std::vector<std::pair<uint64_t, uint32_t> > order;
+		order.reserve(n);
+		while (!queue.empty()) {
+			const uint32_t slot = queue.back();
+			queue.pop_back();
+			if (count[slot] != 1) continue;
+			const uint64_t h = xor_hash[slot];
+			order.push_back(std::make_pair(h, slot));
+			layout.Slots(h, slots);
+			for (int j = 0; j < kArity; j++) {
+				count[slots[j]]--;
+				xor_hash[slots[j]] ^= h;
+				if (count[slots[j]] == 1) queue.push_back(slots[j]);
+			}
+		}
+		if (order.size() != n) {
+			return false;
+		}
+
+		// Assign in reverse peeling order: each key's own slot is the
+		// only one of its slots that no later key depends on.
+		for (size_t i = order.size(); i-- > 0; ) {
+			const uint64_t h = order[i].first;
+			layout.Slots(h, slots);
+			uint32_t value = Fingerprint(h, fingerprint_bits_);
+			for (int j = 0; j < kArity; j++) {
+				if (slots[j] != order[i].second) {
+					value ^= GetSlot(array, slots[j], fingerprint_bits_);
+				}
+			}
+			SetSlot(array, order[i].second, fingerprint_bits_, value);
+		}
+		return true;
+	}
+
+public:
+	explicit BinaryFuseFilterPolicy(int fingerprint_bits)
+		: fingerprint_bits_(fingerprint_bits < 1 ? 1 :
+			(fingerprint_bits > 16 ? 16 : fingerprint_bits)) {
+	}
+
+	virtual const char* Name() const {
+		return "leveldb.BinaryFuseFilter";
+	}
+
+	virtual void CreateFilter(const Slice* keys, int n, std::string* dst) const {
+		std::vector<uint64_t> hashes(n);
+		for (int i = 0; i < n; i++) {
+			hashes[i] = KeyHash(keys[i]);
+		}
+		CreateFilterFromHashes(n > 0 ? &hashes[0] : NULL, n, dst);
+	}
+
+	virtual bool SupportsKeyHashes() const {
+		return true;
+	}
+
+	virtual uint64_t HashKey(const Slice& key) const {
+		return KeyHash(key);
+	}
+
+	virtual void CreateFilterFromHashes(const uint64_t* key_hashes, int n,
+		std::string* dst) const {
+		// Duplicate keys would never peel
+		std::vector<uint64_t> hashes(key_hashes, key_hashes + n);
+		std::sort(hashes.begin(), hashes.end());
+		hashes.erase(std::unique(hashes.begin(), hashes.end()), hashes.end());
+
+		const size_t init_size = dst->size();
+		uint64_t seed = 0;
+		Layout layout(hashes.size());
+		if (!hashes.empty()) {
+			for (int attempt = 0; ; attempt++) {
+				const size_t array_bytes = (static_cast<uint64_t>(layout.array_length) *
+					fingerprint_bits_ + 7) / 8 + 4;
+				dst->resize(init_size);
+				dst->resize(init_size + array_bytes, 0);
+				seed = Mix64(attempt + 1);
+				if (Build(hashes, seed, layout, &(*dst)[init_size])) {
+					break;
+				}
+				if (attempt >= kMaxConstructionAttempts) {
+					// Give the keys more room
+					layout = Layout(hashes.size() + hashes.size() / 8 + attempt);
+				}
+			}
+		} else {
+			layout.segment_count_length = 0;
+		}
+		PutFixed64(dst, seed);
+		PutFixed32(dst, layout.segment_length);
+		PutFixed32(dst, layout.segment_count_length);
+		dst->push_back(static_cast<char>(fingerprint_bits_));
+	}
+
+	virtual bool KeyMayMatch(const Slice& key, const Slice& filter) const {
+		if (filter.size() < kMetadataSize) return false;
+		const char* meta = filter.data() + filter.size() - kMetadataSize;
+		const uint64_t seed = DecodeFixed64(meta);
+		const uint32_t segment_length = DecodeFixed32(meta + 8);
+		const uint32_t segment_count_length = DecodeFixed32(meta + 12);
+		const int bits = static_cast<unsigned char>(meta[16]);
+		if (segment_count_length == 0) return false;
+		if (bits < 1 || bits > 16) return true;
+
+		const Layout layout(segment_length, segment_count_length);
+		if ((static_cast<uint64_t>(layout.array_length) * bits + 7) / 8 + 4 >
+			filter.size() - kMetadataSize) {
+			return true;
+		}
+		const uint64_t h = Mix64(KeyHash(key) + seed);
+		uint32_t slots[kArity];
+		layout.Slots(h, slots);
+		uint32_t value = Fingerprint(h, bits);
+		for (int j = 0; j < kArity; j++) {
+			value ^= GetSlot(filter.data(), slots[j], bits);
+		}
+		return value == 0;
+	}
+};
+
+}  // namespace
+
+const FilterPolicy* NewBinaryFuseFilterPolicy(int fingerprint_bits) {
+	return new BinaryFuseFilterPolicy(fingerprint_bits);
+}
+
+}  // namespace leveldb
@@ -0,0 +1,211 @@
+// Copyright (c) 2012 The LevelDB Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file. See the AUTHORS file for names of contributors.
+
+#include "include/leveldb/filter_policy.h"
+
+#include <string.h>
+#include <vector>
+#include "include/leveldb/slice.h"
+#include "port/port.h"
+#include "util/hash.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LEVELDB_BLOOM_SSE2 1
+#endif
+
+namespace leveldb {
+
+namespace {
+
+// All probes for a key go to one 64-byte line of the filter, so a lookup
+// reads one contiguous line instead of k scattered bytes.  Lines are
+// counted from the start of the filter, which need not be aligned, so
+// a line usually straddles two cache lines.
+static const size_t kCacheLineSize = 64;
+static const uint32_t kBitsPerLine = kCacheLineSize * 8;
+
+static uint32_t LineHash(const Slice& key) {
+	return Hash(key.data(), key.size(), 0xbc9f1d34);
+}
+
+static uint32_t BitHash(const Slice& key) {
+	return Hash(key.data(), key.size(), 0x2e1c0b75);
+}
+
+// Map a 32-bit hash uniformly onto [0, n) without a division.
+static uint32_t FastRange(uint32_t hash, uint32_t n) {
+	return static_cast<uint32_t>((static_cast<uint64_t>(hash) * n) >> 32);
+}
+
+// Successive probes take the top 9 bits of a multiplicatively stepped
+// hash, which selects one of the 512 bits of the line.
+static const uint32_t kProbeMultiplier = 0x9e3779b9;
+
+class BlockedBloomFilterPolicy : public FilterPolicy {
+private:
+	size_t bits_per_key_;
+	size_t k_;
+
+public:
+	explicit BlockedBloomFilterPolicy(int bits_per_key)
+		: bits_per_key_(bits_per_key) {
+		// A blocked filter loses a little accuracy to the uneven load of
+		// its lines; slightly fewer probes than ln(2) * bits_per_key work
+		// best for it.
+		k_ = static_cast<size_t>(bits_per_key * 0.65);
+		if (k_ < 1) k_ = 1;
+		if (k_ > 30) k_ = 30;
+	}
+
+	virtual const char* Name() const {
+		return "leveldb.BlockedBloomFilter";
+	}
+
+	virtual void CreateFilter(const Slice* keys, int n, std::string* dst) const {
+		std::vector<uint64_t> hashes(n);
+		for (int i = 0; i < n; i++) {
+			hashes[i] = HashKey(keys[i]);
+		}
+		CreateFilterFromHashes(n > 0 ? &hashes[0] : NULL, n, dst);
+	}
+
+	virtual bool SupportsKeyHashes() const {
+		return true;
+	}
+
+	// The line hash in the high half, the bit hash in the low half.
+	virtual uint64_t HashKey(const Slice& key) const {
+		return (static_cast<uint64_t>(LineHash(key)) << 32) | BitHash(key);
+	}
+
+	virtual void CreateFilterFromHashes(const uint64_t* hashes, int n,
+		std::string* dst) const {
+		// Compute bloom filter size (in both bits and bytes)
+		size_t bits = n * bits_per_key_;
+		uint32_t lines = static_cast<uint32_t>((bits + kBitsPerLine - 1) / kBitsPerLine);
+		if (lines < 1) lines = 1;
+
+		const size_t init_size = dst->size();
+		dst->resize(init_size + lines * kCacheLineSize, 0);
+		dst->push_back(static_cast<char>(k_));  // Remember # of probes in filter
+		char* array = &(*dst)[init_size];
+		for (int i = 0; i < n; i++) {
+			char* line = array + FastRange(static_cast<uint32_t>(hashes[i] >> 32), lines) * kCacheLineSize;
+			uint32_t h = static_cast<uint32_t>(hashes[i]);
+			for (size_t j = 0; j < k_; j++) {
+				const uint32_t bitpos = h >> 23;
+				line[bitpos / 8] |= (1 << (bitpos % 8));
+				h *= kProbeMultiplier;
+			}
+		}
+	}
+
+	virtual bool KeyMayMatch(const Slice& key, const Slice& bloom_filter) const {
+		const char* line;
+		size_t k;
+		bool match;
+		if (!FindLine(key, bloom_filter, &line, &k, &match)) {
+			return match;
+		}
+		return LineMayMatch(line, BitHash(key), k);
+	}
+
+	virtual void KeysMayMatch(const Slice* keys, const Slice* filters, int n,
+		bool* results) const {
+		// Locate and prefetch the lines of a group of keys before probing
+		// any of them, so that their cache misses are served in parallel.
+		static const int kGroup = 16;
+		const char* lines[kGroup];
+		uint32_t hashes[kGroup];
+		size_t ks[kGroup];
+		for (int base = 0; base < n; base += kGroup) {
+			const int m = (n - base < kGroup ? n - base : kGroup);
+			for (int i = 0; i < m; i++) {
+				bool match;
+				if (FindLine(keys[base + i], filters[base + i], &lines[i], &ks[i], &match)) {
+					// Both cache lines that an unaligned line may span
+					port::Prefetch(lines[i]);
+					port::Prefetch(lines[i] + kCacheLineSize - 1);
+					hashes[i] = BitHash(keys[base + i]);
+				} else {
+					lines[i] = NULL;
+					results[base + i] = match;
+				}
+			}
+			for (int i = 0; i < m; i++) {
+				if (lines[i] != NULL) {
+					results[base + i] = LineMayMatch(lines[i], hashes[i], ks[i]);
+				}
+			}
+		}
+	}
+
+private:
+	// Set *line to the line of "bloom_filter" that holds the bits of "key"
+	// and *k to the number of probes, and return true.  Returns false with
+	// the answer in *match if the filter decides without a line.
+	static bool FindLine(const Slice& key, const Slice& bloom_filter,
+		const char** line, size_t* k, bool* match) {
+		const size_t len = bloom_filter.size();
+		if (len < kCacheLineSize + 1) {
+			*match = false;
+			return false;
+		}
+
+		const char* array = bloom_filter.data();
+		const uint32_t lines = static_cast<uint32_t>((len - 1) / kCacheLineSize);
+
+		// Use the encoded k so that we can read filters generated by
+		// bloom filters created using different parameters.
+		*k = static_cast<unsigned char>(array[len - 1]);
+		if (*k > 30) {
+			// Reserved for potentially new encodings for short bloom filters.
+			// Consider it a match.
+			*match = true;
+			return false;
+		}
+
+		*line = array + FastRange(LineHash(key), lines) * kCacheLineSize;
+		return true;
+	}
+
+	static bool LineMayMatch(const char* line, uint32_t h, size_t k) {
+#if defined(LEVELDB_BLOOM_SSE2)
+		// Gather the probed bits into a mask of the line one probe at a
+		// time, then check all of them with four 128-bit compares.
+		union {
+			__m128i v[4];
+			char bytes[kCacheLineSize];
+		} mask;
+		memset(&mask, 0, sizeof(mask));
+		for (size_t j = 0; j < k; j++) {
+			const uint32_t bitpos = h >> 23;
+			mask.bytes[bitpos / 8] |= (1 << (bitpos % 8));
+			h *= kProbeMultiplier;
+		}
+		__m128i missing = _mm_setzero_si128();
+		for (int i = 0; i < 4; i++) {
+			const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(line) + i);
+			missing = _mm_or_si128(missing, _mm_andnot_si128(data, mask.v[i]));
+		}
+		return _mm_movemask_epi8(_mm_cmpeq_epi8(missing, _mm_setzero_si128())) == 0xffff;
+#else
+		for (size_t j = 0; j < k; j++) {
+			const uint32_t bitpos = h >> 23;
+			if ((line[bitpos / 8] & (1 << (bitpos % 8))) == 0) return false;
+			h *= kProbeMultiplier;
+		}
+		return true;
+#endif
+	}
+};
+
+}  // namespace
+
+const FilterPolicy* NewBloomFilterPolicy(int bits_per_key) {
+	return new BlockedBloomFilterPolicy(bits_per_key);
+}
+
+}  // namespace leveldb
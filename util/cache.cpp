@@ -0,0 +1,672 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "include/leveldb/cache.h"
+#include "port/port.h"
+#include "util/cache_statistics.h"
+#include "util/frequency_sketch.h"
+#include "util/hash.h"
+#include "util/mutexlock.h"
+
+namespace leveldb {
+
+Cache::~Cache() {
+}
+
+void Cache::GetStatistics(Statistics* stats) const {
+	memset(stats, 0, sizeof(*stats));
+}
+
+namespace {
+
+// LRU cache implementation
+//
+// Cache entries have an "in_cache" boolean indicating whether the cache has a
+// reference on the entry.  The only ways that this can become false without the
+// entry being passed to its "deleter" are via Erase(), via Insert() when
+// an element with a duplicate key is inserted, or on destruction of the cache.
+//
+// The cache keeps two linked lists of items in the cache.  All items in the
+// cache are in one list or the other, and never both.  Items still referenced
+// by clients but erased from the cache are in neither list.  The lists are:
+// - in-use:  contains the items currently referenced by clients, in no
+//   particular order.  (This list is used for invariant checking.  If we
+//   removed the check, elements that would otherwise be on this list could be
+//   left as disconnected singleton lists.)
+// - LRU:  contains the items not currently referenced by clients, in LRU order
+//   The oldest entries form the low-priority pool and the newest ones the
+//   high-priority pool; the pools meet at lru_low_pri_.  Entries of high
+//   priority enter the high-priority pool and entries of low priority the
+//   low-priority one, so that eviction, which starts at the oldest entry,
+//   reaches high-priority entries only after every low-priority one.  When
+//   the high-priority pool grows past its share of the capacity, its
+//   oldest entries move over to the low-priority pool.
+// Elements are moved between these lists by the Ref() and Unref() methods,
+// when they detect an element in the cache acquiring or losing its only
+// external reference.  Entries that lose their last reference are passed
+// to their deleter only once the shard's mutex is released, so that a
+// slow deleter, e.g. one that compresses the value into another tier,
+// holds up no other thread.
+//
+// With admission control (W-TinyLFU) a third list, the window, holds the
+// newest entries not in use, in LRU order, up to 1% of the capacity.  A
+// frequency sketch counts the lookups of every key, cached or not; a
+// reader looks a block up before inserting it, so inserts add nothing.
+// When the window overflows, its oldest entry moves on to the LRU list
+// only if the sketch has seen it more often than the LRU list's oldest
+// entry, which it would displace; otherwise it is evicted itself.  Until
+// the cache is full, entries move on from the window unopposed.  Blocks
+// that a scan reads once pass through the window and leave again without
+// displacing the entries that lookups keep hitting.
+
+// An entry is a variable length heap-allocated structure.  Entries
+// are kept in a circular doubly linked list ordered by access time.
+struct LRUHandle {
+	void* value;
+	void (*deleter)(const Slice&, void* value);
+	void (*evictor)(const Slice&, void* value);  // For evicted entries, if non-NULL
+	LRUHandle* next_hash;
+	LRUHandle* next;
+	LRUHandle* prev;
+	size_t charge;      // TODO(opt): Only allow uint32_t?
+	size_t key_length;
+	bool in_cache;      // Whether entry is in the cache.
+	bool high_priority;     // Inserted with Cache::kHighPriority
+	bool in_high_pri_pool;  // In the high-priority part of the LRU list
+	bool in_window;         // Not yet admitted to the LRU list
+	bool evicted;           // Left the cache to make room
+	Cache::EntryRole role;
+	uint32_t refs;      // References, including cache reference, if present.
+	uint32_t hash;      // Hash of key(); used for fast sharding and comparisons
+	char key_data[1];   // Beginning of key
+
+	Slice key() const {
+		// next_ is only equal to this if the LRU handle is the list head of an
+		// empty list. List heads never have meaningful keys.
+		assert(next != this);
+
+		return Slice(key_data, key_length);
+	}
+};
+
+// We provide our own simple hash table since it removes a whole bunch
+// of porting hacks and is also faster than some of the built-in hash
+// table implementations in some of the compiler/runtime combinations
+// we have tested.  E.g., readrandom speeds up by ~5% over the g++
+// 4.4.3's builtin hashtable.
+class HandleTable {
+public:
+	HandleTable() : length_(0), elems_(0), list_(NULL) { Resize(); }
+	~HandleTable() { delete[] list_; }
+
+	LRUHandle* Lookup(const Slice& key, uint32_t hash) {
+		return *FindPointer(key, hash);
+	}
+
+	LRUHandle* Insert(LRUHandle* h) {
+		LRUHandle** ptr = FindPointer(h->key(), h->hash);
+		LRUHandle* old = *ptr;
+		h->next_hash = (old == NULL ? NULL : old->next_hash);
+		*ptr = h;
+		if (old == NULL) {
+			++elems_;
+			if (elems_ > length_) {
+				// Since each cache entry is fairly large, we aim for a small
+				// average linked list length (<= 1).
+				Resize();
+			}
+		}
+		return old;
+	}
+
+	LRUHandle* Remove(const Slice& key, uint32_t hash) {
+		LRUHandle** ptr = FindPointer(key, hash);
+		LRUHandle* result = *ptr;
+		if (result != NULL) {
+			*ptr = result->next_hash;
+			--elems_;
+		}
+		return result;
+	}
+
+private:
+	// The table consists of an array of buckets where each bucket is
+	// a linked list of cache entries that hash into the bucket.
+	uint32_t length_;
+	uint32_t elems_;
+	LRUHandle** list_;
+
+	// Return a pointer to slot that points to a cache entry that
+	// matches key/hash.  If there is no such cache entry, return a
+	// pointer to the trailing slot in the corresponding linked list.
+	LRUHandle** FindPointer(const Slice& key, uint32_t hash) {
+		LRUHandle** ptr = &list_[hash & (length_ - 1)];
+		while (*ptr != NULL &&
+			((*ptr)->hash != hash || key != (*ptr)->key())) {
+			ptr = &(*ptr)->next_hash;
+		}
+		return ptr;
+	}
+
+	void Resize() {
+		uint32_t new_length = 4;
+		while (new_length < elems_) {
+			new_length *= 2;
+		}
+		LRUHandle** new_list = new LRUHandle*[new_length];
+		memset(new_list, 0, sizeof(new_list[0]) * new_length);
+		uint32_t count = 0;
+		for (uint32_t i = 0; i < length_; i++) {
+			LRUHandle* h = list_[i];
+			while (h != NULL) {
+				LRUHandle* next = h->next_hash;
+				uint32_t hash = h->hash;
+				LRUHandle** ptr = &new_list[hash & (new_length - 1)];
+				h->next_hash = *ptr;
+				*ptr = h;
+				h = next;
+				count++;
+			}
+		}
+		assert(elems_ == count);
+		delete[] list_;
+		list_ = new_list;
+		length_ = new_length;
+	}
+};
+
+// A single shard of sharded cache.
+class LRUCache {
+public:
+	LRUCache();
+	~LRUCache();
+
+	// Separate from constructor so caller can easily make an array of LRUCache
+	void SetCapacity(size_t capacity, double high_pri_pool_ratio, bool strict_capacity_limit) {
+		capacity_ = capacity;
+		high_pri_pool_capacity_ = static_cast<size_t>(capacity * high_pri_pool_ratio);
+		strict_capacity_limit_ = strict_capacity_limit;
+	}
+
+	// Turn on admission control, sizing the frequency sketch for entries
+	// of about the given charge.  Call after SetCapacity().
+	void EnableAdmission(size_t estimated_entry_charge) {
+		if (estimated_entry_charge == 0) {
+			estimated_entry_charge = 1;
+		}
+		sketch_ = new FrequencySketch(capacity_ / estimated_entry_charge);
+		window_capacity_ = capacity_ / 100;
+	}
+
+	// Count the entries that enter and leave the shard in *stats.
+	void SetStatistics(CacheStatisticsCounters* stats) {
+		stats_ = stats;
+	}
+
+	// Like Cache methods, but with an extra "hash" parameter.
+	Cache::Handle* Insert(const Slice& key, uint32_t hash,
+		void* value, size_t charge,
+		void (*deleter)(const Slice& key, void* value),
+		Cache::Priority priority, Cache::EntryRole role,
+		void (*evictor)(const Slice& key, void* value));
+	Cache::Handle* Lookup(const Slice& key, uint32_t hash);
+	void Release(Cache::Handle* handle);
+	void Erase(const Slice& key, uint32_t hash);
+	void Prune();
+	size_t TotalCharge() const {
+		MutexLock l(&mutex_);
+		return usage_;
+	}
+
+private:
+	void LRU_Remove(LRUHandle* e);
+	void LRU_Append(LRUHandle* list, LRUHandle* e);
+	// Put "e" in the pool of its priority in the lru_ list.
+	void LRU_Insert(LRUHandle* e);
+	// Move entries out of the high-priority pool until it fits its share.
+	void MaintainPoolSize();
+	void Ref(LRUHandle* e);
+	void Unref(LRUHandle* e);
+	bool FinishErase(LRUHandle* e, bool evicted = false);
+	// Hand over the entries that Unref() released, to be passed to
+	// FreeEntries() after mutex_ is unlocked.
+	LRUHandle* TakeGarbage() {
+		LRUHandle* garbage = garbage_;
+		garbage_ = NULL;
+		return garbage;
+	}
+	static void FreeEntries(LRUHandle* list);
+	// While the cache is not full, move entries from the window to the
+	// LRU list until the window fits its share.
+	void MaintainWindowSize();
+	// Evict an entry, or move one from the window to the LRU list, to make
+	// room for "charge" more.  Returns false if no entry can be evicted.
+	bool EvictOne(size_t charge);
+
+	// Initialized before use.
+	size_t capacity_;
+	size_t high_pri_pool_capacity_;
+	bool strict_capacity_limit_;
+	size_t window_capacity_;
+	CacheStatisticsCounters* stats_;
+
+	// mutex_ protects the following state.
+	mutable port::Mutex mutex_;
+	size_t usage_;
+	size_t high_pri_pool_usage_;
+	size_t window_usage_;       // Including window entries in use
+	FrequencySketch* sketch_;   // NULL without admission control
+	LRUHandle* garbage_;        // Released entries, linked by next
+
+	// Dummy head of LRU list.
+	// lru.prev is newest entry, lru.next is oldest entry.
+	// Entries have refs==1 and in_cache==true.
+	LRUHandle lru_;
+
+	// Newest entry of the low-priority pool, or &lru_ if it is empty.
+	LRUHandle* lru_low_pri_;
+
+	// Dummy head of the window list.  Entries have refs==1,
+	// in_cache==true and in_window==true.
+	LRUHandle window_;
+
+	// Dummy head of in-use list.
+	// Entries are in use by clients, and have refs >= 2 and in_cache==true.
+	LRUHandle in_use_;
+
+	HandleTable table_;
+};
+
+LRUCache::LRUCache()
+	: capacity_(0),
+	  high_pri_pool_capacity_(0),
+	  strict_capacity_limit_(false),
+	  window_capacity_(0),
+	  stats_(NULL),
+	  usage_(0),
+	  high_pri_pool_usage_(0),
+	  window_usage_(0),
+	  sketch_(NULL),
+	  garbage_(NULL) {
+	// Make empty circular linked lists.
+	lru_.next = &lru_;
+	lru_.prev = &lru_;
+	lru_low_pri_ = &lru_;
+	window_.next = &window_;
+	window_.prev = &window_;
+	in_use_.next = &in_use_;
+	in_use_.prev = &in_use_;
+}
+
+LRUCache::~LRUCache() {
+	assert(in_use_.next == &in_use_);  // Error if caller has an unreleased handle
+	LRUHandle* lists[] = { &lru_, &window_ };
+	for (int i = 0; i < 2; i++) {
+		for (LRUHandle* e = lists[i]->next; e != lists[i]; ) {
+			LRUHandle* next = e->next;
+			assert(e->in_cache);
+			e->in_cache = false;
+			assert(e->refs == 1);  // Invariant of lru_ and window_ lists.
+			Unref(e);
+			e = next;
+		}
+	}
+	FreeEntries(TakeGarbage());
+	delete sketch_;
+}
+
+void LRUCache::Ref(LRUHandle* e) {
+	if (e->refs == 1 && e->in_cache) {  // If on lru_ list, move to in_use_ list.
+		LRU_Remove(e);
+		LRU_Append(&in_use_, e);
+	}
+	e->refs++;
+}
+
+void LRUCache::Unref(LRUHandle* e) {
+	assert(e->refs > 0);
+	e->refs--;
+	if (e->refs == 0) { // Deallocate once the mutex is released.
+		assert(!e->in_cache);
+		e->next = garbage_;
+		garbage_ = e;
+	} else if (e->in_cache && e->refs == 1) {  // No longer in use; move to lru_ list.
+		LRU_Remove(e);
+		if (e->in_window) {
+			LRU_Append(&window_, e);
+			MaintainWindowSize();
+		} else {
+			LRU_Insert(e);
+		}
+	}
+}
+
+void LRUCache::LRU_Remove(LRUHandle* e) {
+	if (lru_low_pri_ == e) {
+		lru_low_pri_ = e->prev;
+	}
+	if (e->in_high_pri_pool) {
+		assert(high_pri_pool_usage_ >= e->charge);
+		high_pri_pool_usage_ -= e->charge;
+		e->in_high_pri_pool = false;
+	}
+	e->next->prev = e->prev;
+	e->prev->next = e->next;
+}
+
+void LRUCache::LRU_Append(LRUHandle* list, LRUHandle* e) {
+	// Make "e" newest entry by inserting just before *list
+	e->next = list;
+	e->prev = list->prev;
+	e->prev->next = e;
+	e->next->prev = e;
+}
+
+void LRUCache::LRU_Insert(LRUHandle* e) {
+	if (e->high_priority && high_pri_pool_capacity_ > 0) {
+		LRU_Append(&lru_, e);
+		e->in_high_pri_pool = true;
+		high_pri_pool_usage_ += e->charge;
+		MaintainPoolSize();
+	} else {
+		// Make "e" the newest entry of the low-priority pool
+		e->next = lru_low_pri_->next;
+		e->prev = lru_low_pri_;
+		e->prev->next = e;
+		e->next->prev = e;
+		lru_low_pri_ = e;
+	}
+}
+
+void LRUCache::MaintainPoolSize() {
+	while (high_pri_pool_usage_ > high_pri_pool_capacity_) {
+		// The oldest high-priority entry follows the low-priority pool
+		lru_low_pri_ = lru_low_pri_->next;
+		assert(lru_low_pri_ != &lru_ && lru_low_pri_->in_high_pri_pool);
+		lru_low_pri_->in_high_pri_pool = false;
+		high_pri_pool_usage_ -= lru_low_pri_->charge;
+	}
+}
+
+Cache::Handle* LRUCache::Lookup(const Slice& key, uint32_t hash) {
+	MutexLock l(&mutex_);
+	if (sketch_ != NULL) {
+		sketch_->Increment(hash);
+	}
+	LRUHandle* e = table_.Lookup(key, hash);
+	if (e != NULL) {
+		Ref(e);
+	}
+	return reinterpret_cast<Cache::Handle*>(e);
+}
+
+void LRUCache::FreeEntries(LRUHandle* list) {
+	while (list != NULL) {
+		LRUHandle* next = list->next;
+		if (list->evicted && list->evictor != NULL) {
+			(*list->evictor)(list->key(), list->value);
+		} else {
+			(*list->deleter)(list->key(), list->value);
+		}
+		free(list);
+		list = next;
+	}
+}
+
+void LRUCache::Release(Cache::Handle* handle) {
+	LRUHandle* garbage;
+	{
+		MutexLock l(&mutex_);
+		Unref(reinterpret_cast<LRUHandle*>(handle));
+		garbage = TakeGarbage();
+	}
+	FreeEntries(garbage);
+}
+
+Cache::Handle* LRUCache::Insert(
+	const Slice& key, uint32_t hash, void* value, size_t charge,
+	void (*deleter)(const Slice& key, void* value),
+	Cache::Priority priority, Cache::EntryRole role,
+	void (*evictor)(const Slice& key, void* value)) {
+	LRUHandle* e = NULL;
+	LRUHandle* garbage;
+	{
+		MutexLock l(&mutex_);
+
+		// Make room before inserting, so that a strict limit can turn the
+		// entry away when the entries in use leave too little
+		while (usage_ + charge > capacity_ && EvictOne(charge)) {
+		}
+		if (!strict_capacity_limit_ || usage_ + charge <= capacity_) {
+			e = reinterpret_cast<LRUHandle*>(
+				malloc(sizeof(LRUHandle)-1 + key.size()));
+			e->value = value;
+			e->deleter = deleter;
+			e->evictor = evictor;
+			e->charge = charge;
+			e->key_length = key.size();
+			e->hash = hash;
+			e->in_cache = false;
+			e->high_priority = (priority == Cache::kHighPriority);
+			e->in_high_pri_pool = false;
+			e->in_window = false;
+			e->evicted = false;
+			e->role = role;
+			e->refs = 1;  // for the returned handle.
+			memcpy(e->key_data, key.data(), key.size());
+
+			if (capacity_ > 0) {
+				e->refs++;  // for the cache's reference.
+				e->in_cache = true;
+				LRU_Append(&in_use_, e);
+				usage_ += charge;
+				stats_->RecordInsert(role, charge);
+				if (sketch_ != NULL) {
+					e->in_window = true;
+					window_usage_ += charge;
+				}
+				FinishErase(table_.Insert(e));
+			} else {  // don't cache. (capacity_==0 is supported and turns off caching.)
+				// next is read by key() in an assert, so it must be initialized
+				e->next = NULL;
+			}
+		}
+		garbage = TakeGarbage();
+	}
+	FreeEntries(garbage);
+
+	return reinterpret_cast<Cache::Handle*>(e);
+}
+
+// If e != NULL, finish removing *e from the cache; it has already been
+// removed from the hash table.  "evicted" tells whether it goes to make
+// room.  Return whether e != NULL.
+bool LRUCache::FinishErase(LRUHandle* e, bool evicted) {
+	if (e != NULL) {
+		assert(e->in_cache);
+		LRU_Remove(e);
+		e->in_cache = false;
+		e->evicted = evicted;
+		usage_ -= e->charge;
+		stats_->RecordRemoval(e->role, e->charge, evicted);
+		if (e->in_window) {
+			e->in_window = false;
+			window_usage_ -= e->charge;
+		}
+		Unref(e);
+	}
+	return e != NULL;
+}
+
+void LRUCache::MaintainWindowSize() {
+	while (window_usage_ > window_capacity_ && usage_ < capacity_ && window_.next != &window_) {
+		LRUHandle* e = window_.next;
+		LRU_Remove(e);
+		e->in_window = false;
+		window_usage_ -= e->charge;
+		LRU_Insert(e);
+	}
+}
+
+bool LRUCache::EvictOne(size_t charge) {
+	LRUHandle* victim = (lru_.next != &lru_ ? lru_.next : NULL);
+	if (sketch_ != NULL && window_.next != &window_ &&
+		(victim == NULL || window_usage_ + charge > window_capacity_)) {
+		LRUHandle* candidate = window_.next;
+		if (victim != NULL &&
+			sketch_->Estimate(candidate->hash) <= sketch_->Estimate(victim->hash)) {
+			victim = candidate;  // Not admitted
+		} else {
+			LRU_Remove(candidate);
+			candidate->in_window = false;
+			window_usage_ -= candidate->charge;
+			LRU_Insert(candidate);
+			return true;
+		}
+	}
+	if (victim == NULL) {
+		return false;
+	}
+	assert(victim->refs == 1);
+	bool erased = FinishErase(table_.Remove(victim->key(), victim->hash), true);
+	if (!erased) {  // to avoid unused variable when compiled NDEBUG
+		assert(erased);
+	}
+	return true;
+}
+
+void LRUCache::Erase(const Slice& key, uint32_t hash) {
+	LRUHandle* garbage;
+	{
+		MutexLock l(&mutex_);
+		FinishErase(table_.Remove(key, hash));
+		garbage = TakeGarbage();
+	}
+	FreeEntries(garbage);
+}
+
+void LRUCache::Prune() {
+	LRUHandle* garbage;
+	{
+		MutexLock l(&mutex_);
+		LRUHandle* lists[] = { &lru_, &window_ };
+		for (int i = 0; i < 2; i++) {
+			while (lists[i]->next != lists[i]) {
+				LRUHandle* e = lists[i]->next;
+				assert(e->refs == 1);
+				bool erased = FinishErase(table_.Remove(e->key(), e->hash));
+				if (!erased) {  // to avoid unused variable when compiled NDEBUG
+					assert(erased);
+				}
+			}
+		}
+		garbage = TakeGarbage();
+	}
+	FreeEntries(garbage);
+}
+
+// Each shard has its own mutex, hash table and LRU list, so threads that
+// touch different shards never wait for each other.
+static const int kNumShardBits = 4;
+
+class ShardedLRUCache : public Cache {
+private:
+	const int num_shard_bits_;
+	const int num_shards_;
+	LRUCache* shard_;
+	port::Mutex id_mutex_;
+	uint64_t last_id_;
+	CacheStatisticsCounters stats_;
+
+	static inline uint32_t HashSlice(const Slice& s) {
+		return Hash(s.data(), s.size(), 0);
+	}
+
+	uint32_t Shard(uint32_t hash) const {
+		return (num_shard_bits_ == 0 ? 0 : hash >> (32 - num_shard_bits_));
+	}
+
+public:
+	// An estimated_entry_charge of zero turns admission control off.
+	ShardedLRUCache(size_t capacity, double high_pri_pool_ratio, bool strict_capacity_limit,
+		size_t estimated_entry_charge, int num_shard_bits)
+		: num_shard_bits_(num_shard_bits),
+		  num_shards_(1 << num_shard_bits),
+		  shard_(new LRUCache[1 << num_shard_bits]),
+		  last_id_(0) {
+		const size_t per_shard = (capacity + (num_shards_ - 1)) / num_shards_;
+		for (int s = 0; s < num_shards_; s++) {
+			shard_[s].SetCapacity(per_shard, high_pri_pool_ratio, strict_capacity_limit);
+			shard_[s].SetStatistics(&stats_);
+			if (estimated_entry_charge > 0) {
+				shard_[s].EnableAdmission(estimated_entry_charge);
+			}
+		}
+	}
+	virtual ~ShardedLRUCache() {
+		delete[] shard_;
+	}
+	virtual Handle* Insert(const Slice& key, void* value, size_t charge,
+		void (*deleter)(const Slice& key, void* value), Priority priority = kLowPriority,
+		EntryRole role = kOtherEntry, void (*evictor)(const Slice& key, void* value) = NULL) {
+		const uint32_t hash = HashSlice(key);
+		return shard_[Shard(hash)].Insert(key, hash, value, charge, deleter, priority, role,
+			evictor);
+	}
+	virtual Handle* Lookup(const Slice& key, EntryRole role = kOtherEntry) {
+		const uint32_t hash = HashSlice(key);
+		Handle* h = shard_[Shard(hash)].Lookup(key, hash);
+		stats_.RecordLookup(role, h != NULL);
+		return h;
+	}
+	virtual void Release(Handle* handle) {
+		LRUHandle* h = reinterpret_cast<LRUHandle*>(handle);
+		shard_[Shard(h->hash)].Release(handle);
+	}
+	virtual void Erase(const Slice& key) {
+		const uint32_t hash = HashSlice(key);
+		shard_[Shard(hash)].Erase(key, hash);
+	}
+	virtual void* Value(Handle* handle) {
+		return reinterpret_cast<LRUHandle*>(handle)->value;
+	}
+	virtual uint64_t NewId() {
+		MutexLock l(&id_mutex_);
+		return ++(last_id_);
+	}
+	virtual void Prune() {
+		for (int s = 0; s < num_shards_; s++) {
+			shard_[s].Prune();
+		}
+	}
+	virtual size_t TotalCharge() const {
+		size_t total = 0;
+		for (int s = 0; s < num_shards_; s++) {
+			total += shard_[s].TotalCharge();
+		}
+		return total;
+	}
+	virtual void GetStatistics(Statistics* stats) const {
+		stats_.Snapshot(stats);
+	}
+};
+
+}  // end anonymous namespace
+
+Cache* NewLRUCache(size_t capacity, double high_pri_pool_ratio, bool strict_capacity_limit,
+	int num_shard_bits) {
+	assert(num_shard_bits >= 0 && num_shard_bits < 20);
+	return new ShardedLRUCache(capacity, high_pri_pool_ratio, strict_capacity_limit, 0,
+		num_shard_bits);
+}
+
+Cache* NewTinyLFUCache(size_t capacity, size_t estimated_entry_charge) {
+	if (estimated_entry_charge == 0) {
+		estimated_entry_charge = 1;
+	}
+	return new ShardedLRUCache(capacity, 0.0, false, estimated_entry_charge, kNumShardBits);
+}
+
+}  // namespace leveldb
@@ -0,0 +1,67 @@
+#ifndef STORAGE_LEVELDB_UTIL_CACHE_STATISTICS_H_
+#define STORAGE_LEVELDB_UTIL_CACHE_STATISTICS_H_
+
+#include "include/leveldb/cache.h"
+#include "util/core_local.h"
+
+namespace leveldb {
+
+// The counters behind Cache::GetStatistics(), for cache implementations.
+// Lookups of different shards, or of a lock-free cache, run in parallel,
+// so the counters are core-local.
+class CacheStatisticsCounters {
+public:
+	CacheStatisticsCounters() : counters_(kNumMetrics * Cache::kNumEntryRoles) { }
+
+	// One counter per lookup, which keeps the cost of a hit to one
+	// uncontended add.
+	void RecordLookup(Cache::EntryRole role, bool hit) {
+		counters_.Add(Index(hit ? kHits : kMisses, role), 1);
+	}
+
+	// An entry of "role" and "charge" entered the cache.
+	void RecordInsert(Cache::EntryRole role, size_t charge) {
+		counters_.Add(Index(kInserts, role), 1);
+		counters_.Add(Index(kBytes, role), charge);
+	}
+
+	// An entry left the cache, evicted to make room or for any other
+	// reason.
+	void RecordRemoval(Cache::EntryRole role, size_t charge, bool evicted) {
+		if (evicted) {
+			counters_.Add(Index(kEvictions, role), 1);
+		}
+		counters_.Add(Index(kBytes, role), static_cast<uint64_t>(0) - charge);
+	}
+
+	void Snapshot(Cache::Statistics* stats) const {
+		for (int r = 0; r < Cache::kNumEntryRoles; r++) {
+			const Cache::EntryRole role = static_cast<Cache::EntryRole>(r);
+			stats->hits[r] = counters_.Sum(Index(kHits, role));
+			stats->lookups[r] = stats->hits[r] + counters_.Sum(Index(kMisses, role));
+			stats->inserts[r] = counters_.Sum(Index(kInserts, role));
+			stats->evictions[r] = counters_.Sum(Index(kEvictions, role));
+			stats->bytes[r] = counters_.Sum(Index(kBytes, role));
+			if (stats->bytes[r] > (~static_cast<uint64_t>(0) >> 1)) {
+				stats->bytes[r] = 0;  // Read a removal, but not yet its insert
+			}
+		}
+	}
+
+private:
+	enum Metric { kHits, kMisses, kInserts, kEvictions, kBytes, kNumMetrics };
+
+	static int Index(Metric metric, Cache::EntryRole role) {
+		return metric * Cache::kNumEntryRoles + role;
+	}
+
+	CoreLocalCounters counters_;
+
+	// No copying allowed
+	CacheStatisticsCounters(const CacheStatisticsCounters&);
+	void operator=(const CacheStatisticsCounters&);
+};
+
+}  // namespace leveldb
+
+#endif  // STORAGE_LEVELDB_UTIL_CACHE_STATISTICS_H_
@@ -0,0 +1,437 @@
+#include <assert.h>
+#include <string.h>
+
+#include "include/leveldb/cache.h"
+#include "port/port.h"
+#include "util/cache_statistics.h"
+#include "util/hash.h"
+
+namespace leveldb {
+
+namespace {
+
+// CLOCK cache implementation
+//
+// Entries live in the slots of a fixed open-addressing table with linear
+// probing.  Each slot has one atomic word, "meta", that holds its state,
+// the number of handles clients hold on it, and a CLOCK countdown.
+// Lookup() and Release() only change meta with compare-and-swap and never
+// take a lock, and a hit moves nothing: it just raises the countdown.
+// Eviction sweeps a clock hand over the slots and frees the unreferenced
+// entries whose countdown has run down, decrementing it on the way.
+//
+// A slot is in one of four states:
+// - empty
+// - construction: owned by the one thread that claimed it to insert or
+//   to free an entry; no other thread reads its fields
+// - visible: holds an entry that lookups can find
+// - invisible: holds an erased entry that clients still reference; it is
+//   freed when the last reference is released
+//
+// A new entry starts with a full countdown if it has high priority and
+// with a countdown of one otherwise, so that entries of low priority that
+// are never hit again, like the blocks of a scan, go in the next sweep.
+//
+// Every slot also counts the entries whose probe sequence passes over it
+// ("displacements").  A lookup stops at the first slot without a match
+// that no entry was displaced past.
+//
+// Insert() erases the old entry of its key before it claims a slot, but
+// another thread may insert the same key in between.  So once the new
+// entry is visible, Insert() looks for other visible entries of the key
+// and erases whichever of each pair was inserted first (by "sequence"):
+// of racing inserts of a key, the last one wins.
+static const uint64_t kRefsMask = 0xffffffffu;
+static const int kCountdownShift = 32;
+static const uint64_t kCountdownMask = static_cast<uint64_t>(3) << kCountdownShift;
+static const uint64_t kMaxCountdown = 3;
+static const uint64_t kLowPriorityCountdown = 1;
+static const int kStateShift = 56;
+static const uint64_t kStateMask = static_cast<uint64_t>(3) << kStateShift;
+static const uint64_t kStateEmpty = 0;
+static const uint64_t kStateConstruction = static_cast<uint64_t>(1) << kStateShift;
+static const uint64_t kStateVisible = static_cast<uint64_t>(2) << kStateShift;
+static const uint64_t kStateInvisible = static_cast<uint64_t>(3) << kStateShift;
+
+// Fraction of the slots that may hold entries; lookups of absent keys
+// get slow as linear probing fills the table.
+static const double kMaxLoadFactor = 0.85;
+
+struct ClockHandle {
+	port::AtomicUint64 meta;
+	port::AtomicUint64 displacements;
+
+	// Written while the slot is in construction, read by holders of a
+	// reference.
+	uint32_t hash;
+	bool detached;      // Not in the table: the cache had no room for it
+	char* key_data;
+	size_t key_length;
+	void* value;
+	void (*deleter)(const Slice&, void* value);
+	void (*evictor)(const Slice&, void* value);  // For evicted entries, if non-NULL
+	size_t charge;
+	Cache::EntryRole role;
+	uint64_t sequence;  // Order of the Insert() among all inserts
+
+	ClockHandle() : hash(0), detached(false), key_data(NULL), key_length(0),
+		value(NULL), deleter(NULL), evictor(NULL), charge(0), role(Cache::kOtherEntry),
+		sequence(0) { }
+
+	Slice key() const { return Slice(key_data, key_length); }
+};
+
+class ClockCache : public Cache {
+public:
+	ClockCache(size_t capacity, size_t estimated_entry_charge, bool strict_capacity_limit);
+	virtual ~ClockCache();
+
+	virtual Handle* Insert(const Slice& key, void* value, size_t charge,
+		void (*deleter)(const Slice& key, void* value), Priority priority = kLowPriority,
+		EntryRole role = kOtherEntry, void (*evictor)(const Slice& key, void* value) = NULL);
+	virtual Handle* Lookup(const Slice& key, EntryRole role = kOtherEntry);
+	virtual void Release(Handle* handle);
+	virtual void* Value(Handle* handle) {
+		return reinterpret_cast<ClockHandle*>(handle)->value;
+	}
+	virtual void Erase(const Slice& key);
+	virtual uint64_t NewId() {
+		return last_id_.FetchAdd(1) + 1;
+	}
+	virtual void Prune();
+	virtual size_t TotalCharge() const {
+		return static_cast<size_t>(usage_.Load());
+	}
+	virtual void GetStatistics(Statistics* stats) const {
+		stats_.Snapshot(stats);
+	}
+
+private:
+	static uint32_t HashSlice(const Slice& s) {
+		return Hash(s.data(), s.size(), 0);
+	}
+
+	// Find the visible entry for "key" and take a reference on it.
+	ClockHandle* Find(const Slice& key, uint32_t hash);
+
+	// Take a reference on slot "h" if it holds a visible entry.
+	bool Ref(ClockHandle* h);
+	void Unref(ClockHandle* h);
+
+	// Make slot "h" invisible if it holds a visible entry.  The caller
+	// holds a reference on it.
+	void MakeInvisible(ClockHandle* h);
+
+	// Erase the entries of "key" that an Insert() racing with the one of
+	// the visible entry "h" left, or "h" itself if it lost the race.
+	void EraseDuplicates(ClockHandle* h, const Slice& key);
+
+	// Free the entry of slot "h", which the caller has put in construction.
+	// "evicted" tells whether it goes to make room.
+	void Free(ClockHandle* h, bool evicted = false);
+
+	// Advance the clock hand until "charge" more bytes fit and a slot is
+	// free, or until every entry has been passed over several times.
+	void Evict(size_t charge);
+
+	const size_t capacity_;
+	const bool strict_capacity_limit_;
+	uint32_t length_;                  // Number of slots, a power of two
+	uint32_t max_occupancy_;
+	ClockHandle* slots_;
+	port::AtomicUint64 usage_;
+	port::AtomicUint64 occupancy_;    // Slots that are not empty
+	port::AtomicUint64 clock_hand_;
+	port::AtomicUint64 last_id_;
+	port::AtomicUint64 last_sequence_;
+	CacheStatisticsCounters stats_;
+};
+
+ClockCache::ClockCache(size_t capacity, size_t estimated_entry_charge, bool strict_capacity_limit)
+	: capacity_(capacity),
+	  strict_capacity_limit_(strict_capacity_limit),
+	  length_(16)
+{
+	if (estimated_entry_charge == 0) {
+		estimated_entry_charge = 1;
+	}
+	const double entries = double(capacity) / estimated_entry_charge;
+	while (length_ < entries / kMaxLoadFactor && length_ < (1u << 30)) {
+		length_ *= 2;
+	}
+	max_occupancy_ = static_cast<uint32_t>(length_ * kMaxLoadFactor);
+	slots_ = new ClockHandle[length_];
+}
+
+ClockCache::~ClockCache()
+{
+	for (uint32_t i = 0; i < length_; i++) {
+		const uint64_t meta = slots_[i].meta.Load();
+		if ((meta & kStateMask) == kStateVisible) {
+			assert((meta & kRefsMask) == 0);  // Error if caller has an unreleased handle
+			Free(&slots_[i]);
+		}
+	}
+	delete[] slots_;
+}
+
+bool ClockCache::Ref(ClockHandle* h)
+{
+	for (;;) {
+		const uint64_t meta = h->meta.Load();
+		if ((meta & kStateMask) != kStateVisible) {
+			return false;
+		}
+		const uint64_t new_meta = ((meta + 1) & ~kCountdownMask) |
+			(kMaxCountdown << kCountdownShift);
+		if (h->meta.CompareAndSwap(meta, new_meta)) {
+			return true;
+		}
+	}
+}
+
+void ClockCache::Unref(ClockHandle* h)
+{
+	uint64_t new_meta;
+	for (;;) {
+		const uint64_t meta = h->meta.Load();
+		assert((meta & kRefsMask) > 0);
+		new_meta = meta - 1;
+		if (h->meta.CompareAndSwap(meta, new_meta)) {
+			break;
+		}
+	}
+	if ((new_meta & kStateMask) == kStateInvisible && (new_meta & kRefsMask) == 0 &&
+		h->meta.CompareAndSwap(new_meta, kStateConstruction)) {
+		Free(h);
+	}
+}
+
+void ClockCache::Free(ClockHandle* h, bool evicted)
+{
+	// Undo the displacements of the entry's probe sequence
+	const uint32_t mask = length_ - 1;
+	const uint32_t index = static_cast<uint32_t>(h - slots_);
+	for (uint32_t i = h->hash & mask; i != index; i = (i + 1) & mask) {
+		slots_[i].displacements.FetchAdd(static_cast<uint64_t>(-1));
+	}
+
+	if (evicted && h->evictor != NULL) {
+		(*h->evictor)(h->key(), h->value);
+	} else {
+		(*h->deleter)(h->key(), h->value);
+	}
+	delete[] h->key_data;
+	h->key_data = NULL;
+	usage_.FetchAdd(static_cast<uint64_t>(0) - h->charge);
+	stats_.RecordRemoval(h->role, h->charge, evicted);
+	occupancy_.FetchAdd(static_cast<uint64_t>(-1));
+	h->meta.Store(kStateEmpty);
+}
+
+ClockHandle* ClockCache::Find(const Slice& key, uint32_t hash)
+{
+	const uint32_t mask = length_ - 1;
+	uint32_t i = hash & mask;
+	for (uint32_t probes = 0; probes < length_; probes++) {
+		ClockHandle* h = &slots_[i];
+		// The hash is only a hint until a reference pins the entry
+		if (h->hash == hash && Ref(h)) {
+			if (h->hash == hash && h->key() == key) {
+				return h;
+			}
+			Unref(h);
+		}
+		if (h->displacements.Load() == 0) {
+			break;
+		}
+		i = (i + 1) & mask;
+	}
+	return NULL;
+}
+
+Cache::Handle* ClockCache::Lookup(const Slice& key, EntryRole role)
+{
+	ClockHandle* h = Find(key, HashSlice(key));
+	stats_.RecordLookup(role, h != NULL);
+	return reinterpret_cast<Cache::Handle*>(h);
+}
+
+void ClockCache::Release(Handle* handle)
+{
+	ClockHandle* h = reinterpret_cast<ClockHandle*>(handle);
+	if (h->detached) {
+		(*h->deleter)(h->key(), h->value);
+		delete[] h->key_data;
+		delete h;
+		return;
+	}
+	Unref(h);
+}
+
+void ClockCache::MakeInvisible(ClockHandle* h)
+{
+	for (;;) {
+		const uint64_t meta = h->meta.Load();
+		if ((meta & kStateMask) != kStateVisible) {
+			break;  // Erased by another thread
+		}
+		if (h->meta.CompareAndSwap(meta, (meta & ~kStateMask) | kStateInvisible)) {
+			break;
+		}
+	}
+}
+
+void ClockCache::Erase(const Slice& key)
+{
+	ClockHandle* h = Find(key, HashSlice(key));
+	if (h == NULL) {
+		return;
+	}
+	MakeInvisible(h);
+	Unref(h);
+}
+
+void ClockCache::EraseDuplicates(ClockHandle* h, const Slice& key)
+{
+	const uint32_t mask = length_ - 1;
+	uint32_t i = h->hash & mask;
+	for (uint32_t probes = 0; probes < length_; probes++) {
+		ClockHandle* other = &slots_[i];
+		if (other != h && other->hash == h->hash && Ref(other)) {
+			if (other->hash == h->hash && other->key() == key) {
+				MakeInvisible(other->sequence < h->sequence ? other : h);
+			}
+			Unref(other);
+		}
+		if (other->displacements.Load() == 0) {
+			break;
+		}
+		i = (i + 1) & mask;
+	}
+}
+
+void ClockCache::Evict(size_t charge)
+{
+	const uint32_t mask = length_ - 1;
+	const uint64_t max_steps = static_cast<uint64_t>(length_) * (kMaxCountdown + 2);
+	for (uint64_t step = 0; step < max_steps; step++) {
+		if (usage_.Load() + charge <= capacity_ && occupancy_.Load() < max_occupancy_) {
+			return;
+		}
+		ClockHandle* h = &slots_[clock_hand_.FetchAdd(1) & mask];
+		const uint64_t meta = h->meta.Load();
+		if ((meta & kStateMask) != kStateVisible || (meta & kRefsMask) != 0) {
+			continue;
+		}
+		if ((meta & kCountdownMask) != 0) {
+			// Second chance: hits since the last sweep keep the entry
+			h->meta.CompareAndSwap(meta, meta - (static_cast<uint64_t>(1) << kCountdownShift));
+		} else if (h->meta.CompareAndSwap(meta, kStateConstruction)) {
+			Free(h, true);
+		}
+	}
+}
+
+Cache::Handle* ClockCache::Insert(const Slice& key, void* value, size_t charge,
+	void (*deleter)(const Slice& key, void* value), Priority priority, EntryRole role,
+	void (*evictor)(const Slice& key, void* value))
+{
+	const uint32_t hash = HashSlice(key);
+	Erase(key);
+	if (capacity_ > 0) {
+		Evict(charge);
+	}
+	if (strict_capacity_limit_) {
+		// Reserve the charge, so that concurrent inserts cannot overshoot
+		if (usage_.FetchAdd(charge) + charge > capacity_) {
+			usage_.FetchAdd(static_cast<uint64_t>(0) - charge);
+			return NULL;
+		}
+	}
+
+	char* key_data = new char[key.size() > 0 ? key.size() : 1];
+	memcpy(key_data, key.data(), key.size());
+
+	// Claim the first empty slot of the probe sequence, counting the
+	// displacement on every slot passed over
+	ClockHandle* h = NULL;
+	const uint32_t mask = length_ - 1;
+	const uint32_t home = hash & mask;
+	if (capacity_ > 0 && occupancy_.FetchAdd(1) < max_occupancy_) {
+		uint32_t i = home;
+		for (uint32_t probes = 0; probes < length_; probes++) {
+			if (slots_[i].meta.CompareAndSwap(kStateEmpty, kStateConstruction)) {
+				h = &slots_[i];
+				break;
+			}
+			slots_[i].displacements.FetchAdd(1);
+			i = (i + 1) & mask;
+		}
+		if (h == NULL) {
+			for (uint32_t j = home; j != i; j = (j + 1) & mask) {
+				slots_[j].displacements.FetchAdd(static_cast<uint64_t>(-1));
+			}
+		}
+	}
+	if (h == NULL) {
+		if (capacity_ > 0) {
+			occupancy_.FetchAdd(static_cast<uint64_t>(-1));
+		}
+		if (strict_capacity_limit_) {
+			usage_.FetchAdd(static_cast<uint64_t>(0) - charge);
+			delete[] key_data;
+			return NULL;
+		}
+		// Not cached: hand out a handle of its own, freed by Release()
+		h = new ClockHandle;
+		h->detached = true;
+	}
+
+	h->hash = hash;
+	h->key_data = key_data;
+	h->key_length = key.size();
+	h->value = value;
+	h->deleter = deleter;
+	h->evictor = evictor;
+	h->charge = charge;
+	h->role = role;
+	h->sequence = last_sequence_.FetchAdd(1);
+	if (!h->detached) {
+		if (!strict_capacity_limit_) {
+			usage_.FetchAdd(charge);
+		}
+		stats_.RecordInsert(role, charge);
+		const uint64_t countdown = (priority == kHighPriority ? kMaxCountdown : kLowPriorityCountdown);
+		// One reference for the returned handle.  Publishing with a full
+		// barrier makes sure that of two racing inserts of a key, at least
+		// one sees the other's entry in EraseDuplicates().
+		bool published = h->meta.CompareAndSwap(kStateConstruction,
+			kStateVisible | (countdown << kCountdownShift) | 1);
+		if (!published) {  // to avoid unused variable when compiled NDEBUG
+			assert(published);
+		}
+		EraseDuplicates(h, key);
+	}
+	return reinterpret_cast<Cache::Handle*>(h);
+}
+
+void ClockCache::Prune()
+{
+	for (uint32_t i = 0; i < length_; i++) {
+		ClockHandle* h = &slots_[i];
+		const uint64_t meta = h->meta.Load();
+		if ((meta & kStateMask) == kStateVisible && (meta & kRefsMask) == 0 &&
+			h->meta.CompareAndSwap(meta, kStateConstruction)) {
+			Free(h);
+		}
+	}
+}
+
+}  // end anonymous namespace
+
+Cache* NewClockCache(size_t capacity, size_t estimated_entry_charge, bool strict_capacity_limit) {
+	return new ClockCache(capacity, estimated_entry_charge, strict_capacity_limit);
+}
+
+}  // namespace leveldb
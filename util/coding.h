@@ -43,6 +43,8 @@ extern bool GetVarint32(Slice* input, uint32_t* value);
 extern bool GetVarint64(Slice* input, uint64_t* value);
 extern bool GetLengthPrefixedSlice(Slice* input, Slice* result);
 
+extern const char* GetVarint64Ptr(const char* p, const char* limit, uint64_t* value);
+
 extern const char* GetVarint32PtrFallback(const char* p, const char* limit, uint32_t* value);
 
 inline const char* GetVarint32Ptr(const char* p, const char* limit, uint32_t* value)
@@ -0,0 +1,40 @@
+#include "util/core_local.h"
+
+namespace leveldb {
+
+static const int kCacheLineSize = 64;
+static const int kCountersPerLine = kCacheLineSize / sizeof(port::AtomicUint64);
+
+CoreLocalCounters::CoreLocalCounters(int num_counters) {
+	stride_ = (num_counters + kCountersPerLine - 1) / kCountersPerLine * kCountersPerLine;
+	storage_ = new port::AtomicUint64[kNumSlots * stride_ + kCountersPerLine];
+	counters_ = storage_;
+	while (reinterpret_cast<uintptr_t>(counters_) % kCacheLineSize != 0) {
+		counters_++;
+	}
+}
+
+CoreLocalCounters::~CoreLocalCounters() {
+	delete[] storage_;
+}
+
+int CoreLocalCounters::Slot() {
+	int cpu = port::CurrentCpu();
+	if (cpu < 0) {
+		// Threads have stacks of their own, so the address of a local
+		// variable at least spreads different threads over the slots
+		char local;
+		cpu = static_cast<int>(reinterpret_cast<uintptr_t>(&local) >> 16);
+	}
+	return cpu & (kNumSlots - 1);
+}
+
+uint64_t CoreLocalCounters::Sum(int counter) const {
+	uint64_t sum = 0;
+	for (int s = 0; s < kNumSlots; s++) {
+		sum += counters_[s * stride_ + counter].Load();
+	}
+	return sum;
+}
+
+}  // namespace leveldb
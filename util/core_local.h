@@ -0,0 +1,43 @@
+#ifndef STORAGE_LEVELDB_UTIL_CORE_LOCAL_H_
+#define STORAGE_LEVELDB_UTIL_CORE_LOCAL_H_
+
+#include <stdint.h>
+#include "port/port.h"
+
+namespace leveldb {
+
+// A set of counters that many threads add to and few read.  Every
+// counter has one copy per slot, and a thread adds to the copy of the
+// slot of the CPU it runs on, so threads on different cores touch
+// different cache lines and never contend.  Sum() adds up the copies; it
+// does not see the counters at a single point in time.
+class CoreLocalCounters {
+public:
+	explicit CoreLocalCounters(int num_counters);
+	~CoreLocalCounters();
+
+	// Add "n" to counter "counter".  Negative amounts are added as their
+	// two's complement; the sums wrap back.
+	void Add(int counter, uint64_t n) {
+		counters_[Slot() * stride_ + counter].FetchAdd(n);
+	}
+
+	uint64_t Sum(int counter) const;
+
+private:
+	static const int kNumSlots = 32;   // A power of two
+
+	static int Slot();
+
+	int stride_;                       // Counters per slot, padded to cache lines
+	port::AtomicUint64* storage_;
+	port::AtomicUint64* counters_;     // Cache-line aligned, inside storage_
+
+	// No copying allowed
+	CoreLocalCounters(const CoreLocalCounters&);
+	void operator=(const CoreLocalCounters&);
+};
+
+}  // namespace leveldb
+
+#endif  // STORAGE_LEVELDB_UTIL_CORE_LOCAL_H_
@@ -262,23 +262,7 @@ template <int N>
 
 }  // namespace
 
-// Determine if the CPU running this program can accelerate the CRC32C
-// calculation.
-static bool CanAccelerateCRC32C() {
-  // port::AcceleretedCRC32C returns zero when unable to accelerate.
-  static const char kTestCRCBuffer[] = "TestCRCBuffer";
-  static const char kBufSize = sizeof(kTestCRCBuffer) - 1;
-  static const uint32_t kTestCRCValue = 0xdcbc59fa;
-
-  return Extend(0, reinterpret_cast<const uint8_t*>(kTestCRCBuffer), kBufSize) == kTestCRCValue;
-}
-
 uint32_t Extend(uint32_t crc, const char* buf, size_t size) {
-  static bool accelerate = CanAccelerateCRC32C();
-  if (accelerate) {
-	  return Extend(crc, reinterpret_cast<const uint8_t*>(buf), size);
-  }
-
   const uint8_t* p = reinterpret_cast<const uint8_t*>(buf);
   const uint8_t* e = p + size;
   uint32_t l = crc ^ kCRC32Xor;
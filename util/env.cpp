@@ -0,0 +1,20 @@
+#include "include/leveldb/env.h"
+
+namespace leveldb {
+
+Env::~Env() {
+}
+
+SequentialFile::~SequentialFile() {
+}
+
+RandomAccessFile::~RandomAccessFile() {
+}
+
+WritableFile::~WritableFile() {
+}
+
+EnvWrapper::~EnvWrapper() {
+}
+
+}  // namespace leveldb
@@ -0,0 +1,506 @@
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <algorithm>
+#if defined(__linux__)
+#include <linux/falloc.h>
+#include <linux/fs.h>
+#endif
+#include "include/leveldb/env.h"
+#include "include/leveldb/slice.h"
+#include "include/leveldb/status.h"
+#include "port/port.h"
+#include "util/coding.h"
+
+namespace leveldb {
+
+namespace {
+
+static Status IOError(const std::string& context, int err_number) {
+	return Status::IOError(context, strerror(err_number));
+}
+
+// The device and inode number identify a file among the files that exist
+// at the same time.  An inode number can be reused once its file is
+// deleted, so where the file system has them the inode's generation,
+// which changes on reuse, is added.
+static std::string UniqueFileId(int fd, const struct stat& sbuf) {
+	std::string id;
+	PutFixed64(&id, static_cast<uint64_t>(sbuf.st_dev));
+	PutFixed64(&id, static_cast<uint64_t>(sbuf.st_ino));
+#if defined(FS_IOC_GETVERSION)
+	long version = 0;
+	if (ioctl(fd, FS_IOC_GETVERSION, &version) == 0) {
+		PutFixed64(&id, static_cast<uint64_t>(version));
+	}
+#endif
+	return id;
+}
+
+// Copies a unique id for RandomAccessFile::GetUniqueId().
+static size_t CopyUniqueId(const std::string& unique_id, char* id, size_t max_size) {
+	if (unique_id.size() > max_size) {
+		return 0;
+	}
+	memcpy(id, unique_id.data(), unique_id.size());
+	return unique_id.size();
+}
+
+// Reads through a file with read(), after telling the kernel to read
+// ahead aggressively.
+class PosixSequentialFile : public SequentialFile {
+private:
+	std::string filename_;
+	int fd_;
+
+public:
+	PosixSequentialFile(const std::string& fname, int fd)
+		: filename_(fname), fd_(fd) {
+#if defined(POSIX_FADV_SEQUENTIAL)
+		posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+	}
+
+	virtual ~PosixSequentialFile() {
+		close(fd_);
+	}
+
+	virtual Status Read(size_t n, Slice* result, char* scratch) {
+		Status s;
+		size_t done = 0;
+		while (done < n) {
+			ssize_t r = read(fd_, scratch + done, n - done);
+			if (r < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				s = IOError(filename_, errno);
+				break;
+			}
+			if (r == 0) {  // End of file
+				break;
+			}
+			done += r;
+		}
+		*result = Slice(scratch, done);
+		return s;
+	}
+
+	virtual Status Skip(uint64_t n) {
+		if (lseek(fd_, n, SEEK_CUR) == static_cast<off_t>(-1)) {
+			return IOError(filename_, errno);
+		}
+		return Status::OK();
+	}
+};
+
+// Serves every read with a pread() of the descriptor, which it keeps
+// open, so it is safe for concurrent use without locking.
+class PosixRandomAccessFile : public RandomAccessFile {
+private:
+	std::string filename_;
+	int fd_;
+	std::string unique_id_;
+
+public:
+	PosixRandomAccessFile(const std::string& fname, int fd, const std::string& unique_id)
+		: filename_(fname), fd_(fd), unique_id_(unique_id) {
+	}
+
+	virtual ~PosixRandomAccessFile() {
+		close(fd_);
+	}
+
+	virtual Status Read(uint64_t offset, size_t n, Slice* result,
+		char* scratch) const {
+		Status s;
+		size_t done = 0;
+		while (done < n) {
+			ssize_t r = pread(fd_, scratch + done, n - done, static_cast<off_t>(offset + done));
+			if (r < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				s = IOError(filename_, errno);
+				break;
+			}
+			if (r == 0) {  // End of file
+				break;
+			}
+			done += r;
+		}
+		*result = Slice(scratch, done);
+		return s;
+	}
+
+	virtual size_t GetUniqueId(char* id, size_t max_size) const {
+		return CopyUniqueId(unique_id_, id, max_size);
+	}
+
+	virtual void Hint(AccessPattern pattern) {
+#if defined(POSIX_FADV_RANDOM)
+		static const int kAdvice[] = { POSIX_FADV_NORMAL, POSIX_FADV_RANDOM,
+			POSIX_FADV_SEQUENTIAL, POSIX_FADV_WILLNEED, POSIX_FADV_DONTNEED };
+		posix_fadvise(fd_, 0, 0, kAdvice[pattern]);
+#endif
+	}
+};
+
+// Serves reads straight out of a read-only mapping of the whole file, so
+// Read() never copies and the returned slices live as long as the file.
+class PosixMmapReadableFile : public RandomAccessFile {
+private:
+	std::string filename_;
+	void* mmapped_region_;
+	size_t length_;
+	std::string unique_id_;
+
+public:
+	// base[0,length-1] contains the mmapped contents of the file.
+	PosixMmapReadableFile(const std::string& fname, void* base, size_t length,
+		const std::string& unique_id)
+		: filename_(fname), mmapped_region_(base), length_(length), unique_id_(unique_id) {
+	}
+
+	virtual ~PosixMmapReadableFile() {
+		if (mmapped_region_ != NULL) {
+			munmap(mmapped_region_, length_);
+		}
+	}
+
+	virtual Status Read(uint64_t offset, size_t n, Slice* result,
+		char* scratch) const {
+		Status s;
+		if (offset + n > length_) {
+			*result = Slice();
+			s = IOError(filename_, EINVAL);
+		} else {
+			*result = Slice(reinterpret_cast<char*>(mmapped_region_) + offset, n);
+		}
+		return s;
+	}
+
+	virtual bool ReturnsStablePointers() const { return true; }
+
+	virtual size_t GetUniqueId(char* id, size_t max_size) const {
+		return CopyUniqueId(unique_id_, id, max_size);
+	}
+
+	virtual void Hint(AccessPattern pattern) {
+#if defined(POSIX_MADV_RANDOM)
+		static const int kAdvice[] = { POSIX_MADV_NORMAL, POSIX_MADV_RANDOM,
+			POSIX_MADV_SEQUENTIAL, POSIX_MADV_WILLNEED, POSIX_MADV_DONTNEED };
+		if (mmapped_region_ != NULL) {
+			posix_madvise(mmapped_region_, length_, kAdvice[pattern]);
+		}
+#endif
+	}
+};
+
+// Collects appends in a buffer and writes it out in large pieces.  Disk
+// space can be preallocated ahead of the writes and written-back pages
+// are handed to the kernel for writeback as the file grows.
+class PosixWritableFile : public WritableFile {
+private:
+	std::string filename_;
+	int fd_;
+	char* buf_;
+	size_t buf_size_;
+	size_t pos_;                    // Bytes in buf_
+	uint64_t filesize_;             // Bytes handed to the OS
+	uint64_t preallocation_size_;
+	uint64_t preallocated_;         // Space is reserved up to here
+	uint64_t bytes_per_sync_;
+	uint64_t last_sync_;            // Writeback was started up to here
+
+public:
+	PosixWritableFile(const std::string& fname, int fd, const WritableFileOptions& options)
+		: filename_(fname),
+		  fd_(fd),
+		  buf_(options.buffer_size > 0 ? new char[options.buffer_size] : NULL),
+		  buf_size_(options.buffer_size),
+		  pos_(0),
+		  filesize_(0),
+		  preallocation_size_(options.preallocation_size),
+		  preallocated_(0),
+		  bytes_per_sync_(options.bytes_per_sync),
+		  last_sync_(0) {
+	}
+
+	virtual ~PosixWritableFile() {
+		if (fd_ >= 0) {
+			Close();
+		}
+		delete[] buf_;
+	}
+
+	virtual Status Append(const Slice& data) {
+		const char* src = data.data();
+		size_t left = data.size();
+
+		// Fill the buffer as far as possible
+		const size_t copy = std::min(left, buf_size_ - pos_);
+		if (copy > 0) {
+			memcpy(buf_ + pos_, src, copy);
+			pos_ += copy;
+			src += copy;
+			left -= copy;
+		}
+		if (left == 0) {
+			return Status::OK();
+		}
+
+		// The buffer is full.  Write it out, then buffer the rest of the
+		// data or write it directly if it would fill the buffer again.
+		Status s = FlushBuffered();
+		if (!s.ok()) {
+			return s;
+		}
+		if (left < buf_size_) {
+			memcpy(buf_, src, left);
+			pos_ = left;
+			return Status::OK();
+		}
+		return WriteRaw(src, left);
+	}
+
+	virtual Status Close() {
+		Status result = FlushBuffered();
+#if defined(FALLOC_FL_KEEP_SIZE)
+		if (preallocated_ > filesize_ && ftruncate(fd_, filesize_) < 0 && result.ok()) {
+			// Give back the space reserved past the end of the data
+			result = IOError(filename_, errno);
+		}
+#endif
+		if (close(fd_) < 0 && result.ok()) {
+			result = IOError(filename_, errno);
+		}
+		fd_ = -1;
+		return result;
+	}
+
+	virtual Status Flush() {
+		return FlushBuffered();
+	}
+
+	virtual Status Sync() {
+		Status s = FlushBuffered();
+		if (s.ok() && fdatasync(fd_) < 0) {
+			s = IOError(filename_, errno);
+		}
+		return s;
+	}
+
+private:
+	Status FlushBuffered() {
+		Status s = WriteRaw(buf_, pos_);
+		pos_ = 0;
+		return s;
+	}
+
+	Status WriteRaw(const char* src, size_t size) {
+		Preallocate(filesize_ + size);
+		size_t left = size;
+		while (left > 0) {
+			ssize_t done = write(fd_, src, left);
+			if (done < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				return IOError(filename_, errno);
+			}
+			left -= done;
+			src += done;
+		}
+		filesize_ += size;
+		RangeSync();
+		return Status::OK();
+	}
+
+	// Make sure that space is reserved up to "offset".  Failures are not
+	// errors: the writes themselves will allocate what they need.
+	void Preallocate(uint64_t offset) {
+#if defined(FALLOC_FL_KEEP_SIZE)
+		if (preallocation_size_ == 0 || offset <= preallocated_) {
+			return;
+		}
+		uint64_t new_end = (offset / preallocation_size_ + 1) * preallocation_size_;
+		if (fallocate(fd_, FALLOC_FL_KEEP_SIZE, preallocated_, new_end - preallocated_) == 0) {
+			preallocated_ = new_end;
+		} else {
+			preallocation_size_ = 0;
+		}
+#endif
+	}
+
+	// Start writeback of the data written since the last call once there
+	// is at least bytes_per_sync_ of it.
+	void RangeSync() {
+#if defined(SYNC_FILE_RANGE_WRITE)
+		if (bytes_per_sync_ > 0 && filesize_ - last_sync_ >= bytes_per_sync_) {
+			sync_file_range(fd_, last_sync_, filesize_ - last_sync_, SYNC_FILE_RANGE_WRITE);
+			last_sync_ = filesize_;
+		}
+#endif
+	}
+};
+
+class PosixEnv : public Env {
+public:
+	PosixEnv() { }
+	virtual ~PosixEnv() {
+		char msg[] = "Destroying Env::Default()\n";
+		fwrite(msg, 1, sizeof(msg), stderr);
+		abort();
+	}
+
+	virtual Status NewSequentialFile(const std::string& fname,
+		SequentialFile** result) {
+		int fd = open(fname.c_str(), O_RDONLY);
+		if (fd < 0) {
+			*result = NULL;
+			return IOError(fname, errno);
+		}
+		*result = new PosixSequentialFile(fname, fd);
+		return Status::OK();
+	}
+
+	virtual Status NewRandomAccessFile(const std::string& fname,
+		RandomAccessFile** result) {
+		return NewRandomAccessFile(fname, RandomAccessFileOptions(), result);
+	}
+
+	virtual Status NewRandomAccessFile(const std::string& fname,
+		const RandomAccessFileOptions& options, RandomAccessFile** result) {
+		*result = NULL;
+		Status s;
+		int fd = open(fname.c_str(), O_RDONLY);
+		if (fd < 0) {
+			return IOError(fname, errno);
+		}
+
+		struct stat sbuf;
+		if (fstat(fd, &sbuf) != 0) {
+			s = IOError(fname, errno);
+		} else if (!options.use_mmap_reads) {
+			*result = new PosixRandomAccessFile(fname, fd, UniqueFileId(fd, sbuf));
+			return s;
+		} else {
+			size_t size = static_cast<size_t>(sbuf.st_size);
+			void* base = NULL;
+			if (size > 0) {
+				base = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+				if (base == MAP_FAILED) {
+					base = NULL;
+					s = IOError(fname, errno);
+				}
+			}
+			if (s.ok()) {
+				*result = new PosixMmapReadableFile(fname, base, size, UniqueFileId(fd, sbuf));
+			}
+		}
+		// The mapping stays valid after the descriptor is closed
+		close(fd);
+		return s;
+	}
+
+	virtual Status NewWritableFile(const std::string& fname,
+		WritableFile** result) {
+		return NewWritableFile(fname, WritableFileOptions(), result);
+	}
+
+	virtual Status NewWritableFile(const std::string& fname,
+		const WritableFileOptions& options, WritableFile** result) {
+		int fd = open(fname.c_str(), O_TRUNC | O_WRONLY | O_CREAT, 0644);
+		if (fd < 0) {
+			*result = NULL;
+			return IOError(fname, errno);
+		}
+		*result = new PosixWritableFile(fname, fd, options);
+		return Status::OK();
+	}
+
+	virtual Status GetChildren(const std::string& dir,
+		std::vector<std::string>* result) {
+		result->clear();
+		DIR* d = opendir(dir.c_str());
+		if (d == NULL) {
+			return IOError(dir, errno);
+		}
+		struct dirent* entry;
+		while ((entry = readdir(d)) != NULL) {
+			result->push_back(entry->d_name);
+		}
+		closedir(d);
+		return Status::OK();
+	}
+
+	virtual Status RemoveFile(const std::string& fname) {
+		if (unlink(fname.c_str()) != 0) {
+			return IOError(fname, errno);
+		}
+		return Status::OK();
+	}
+
+	virtual void StartThread(void (*function)(void* arg), void* arg);
+
+	virtual uint64_t NowMicros() {
+		struct timeval tv;
+		gettimeofday(&tv, NULL);
+		return static_cast<uint64_t>(tv.tv_sec) * 1000000 + tv.tv_usec;
+	}
+
+private:
+	void PthreadCall(const char* label, int result) {
+		if (result != 0) {
+			fprintf(stderr, "pthread %s: %s\n", label, strerror(result));
+			abort();
+		}
+	}
+};
+
+namespace {
+struct StartThreadState {
+	void (*user_function)(void*);
+	void* arg;
+};
+}
+static void* StartThreadWrapper(void* arg) {
+	StartThreadState* state = reinterpret_cast<StartThreadState*>(arg);
+	state->user_function(state->arg);
+	delete state;
+	return NULL;
+}
+
+void PosixEnv::StartThread(void (*function)(void* arg), void* arg) {
+	pthread_t t;
+	StartThreadState* state = new StartThreadState;
+	state->user_function = function;
+	state->arg = arg;
+	PthreadCall("start thread",
+		pthread_create(&t, NULL,  &StartThreadWrapper, state));
+	PthreadCall("detach thread", pthread_detach(t));
+}
+
+}  // namespace
+
+static port::OnceType once = LEVELDB_ONCE_INIT;
+static Env* default_env;
+static void InitDefaultEnv() { default_env = new PosixEnv; }
+
+Env* Env::Default() {
+	port::InitOnce(&once, InitDefaultEnv);
+	return default_env;
+}
+
+}  // namespace leveldb
@@ -0,0 +1,31 @@
+#include "include/leveldb/filter_policy.h"
+
+#include <assert.h>
+#include "include/leveldb/slice.h"
+
+namespace leveldb {
+
+FilterPolicy::~FilterPolicy() { }
+
+void FilterPolicy::KeysMayMatch(const Slice* keys, const Slice* filters, int n,
+	bool* results) const {
+	for (int i = 0; i < n; i++) {
+		results[i] = KeyMayMatch(keys[i], filters[i]);
+	}
+}
+
+bool FilterPolicy::SupportsKeyHashes() const {
+	return false;
+}
+
+uint64_t FilterPolicy::HashKey(const Slice& key) const {
+	assert(false);
+	return 0;
+}
+
+void FilterPolicy::CreateFilterFromHashes(const uint64_t* hashes, int n,
+	std::string* dst) const {
+	assert(false);
+}
+
+}  // namespace leveldb
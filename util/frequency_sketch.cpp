@@ -0,0 +1,76 @@
+#include "util/frequency_sketch.h"
+
+namespace leveldb {
+
+static const int kDepth = 4;
+static const uint64_t kSeeds[kDepth] = {
+	0xc3a5c85c97cb3127ull, 0xb492b66fbe98f273ull,
+	0x9ae16a3b2f90404full, 0xcbf29ce484222325ull
+};
+static const uint64_t kResetMask = 0x7777777777777777ull;
+
+FrequencySketch::FrequencySketch(size_t max_entries)
+	: additions_(0)
+{
+	if (max_entries < 16) {
+		max_entries = 16;
+	}
+	// One word, i.e. 16 counters, per key keeps collisions rare
+	uint32_t words = 16;
+	while (words < max_entries && words < (1u << 28)) {
+		words *= 2;
+	}
+	table_.resize(words, 0);
+	mask_ = words - 1;
+	sample_size_ = 10 * max_entries;
+}
+
+void FrequencySketch::Locate(uint32_t hash, int i, uint32_t* word, int* shift) const
+{
+	uint64_t h = (hash + kSeeds[i]) * kSeeds[i];
+	h += h >> 32;
+	*word = static_cast<uint32_t>(h >> 4) & mask_;
+	*shift = static_cast<int>(h & 15) << 2;
+}
+
+void FrequencySketch::Increment(uint32_t hash)
+{
+	bool added = false;
+	for (int i = 0; i < kDepth; i++) {
+		uint32_t word;
+		int shift;
+		Locate(hash, i, &word, &shift);
+		if (((table_[word] >> shift) & 15) != 15) {
+			table_[word] += static_cast<uint64_t>(1) << shift;
+			added = true;
+		}
+	}
+	if (added && ++additions_ >= sample_size_) {
+		Reset();
+	}
+}
+
+int FrequencySketch::Estimate(uint32_t hash) const
+{
+	int result = 15;
+	for (int i = 0; i < kDepth; i++) {
+		uint32_t word;
+		int shift;
+		Locate(hash, i, &word, &shift);
+		const int count = static_cast<int>((table_[word] >> shift) & 15);
+		if (count < result) {
+			result = count;
+		}
+	}
+	return result;
+}
+
+void FrequencySketch::Reset()
+{
+	for (size_t i = 0; i < table_.size(); i++) {
+		table_[i] = (table_[i] >> 1) & kResetMask;
+	}
+	additions_ /= 2;
+}
+
+}  // namespace leveldb
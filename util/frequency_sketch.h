@@ -0,0 +1,46 @@
+#ifndef STORAGE_LEVELDB_UTIL_FREQUENCY_SKETCH_H_
+#define STORAGE_LEVELDB_UTIL_FREQUENCY_SKETCH_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace leveldb {
+
+// Estimates how often keys were seen recently, in a fixed amount of
+// memory: a count-min sketch of 4-bit counters, four per key.  A key's
+// estimate is the smallest of its counters, so collisions can only
+// overstate it.  Once the increments reach ten times the number of keys
+// the sketch was sized for, all counters are halved, so that estimates
+// follow a changing workload (the "reset" of TinyLFU).
+class FrequencySketch {
+public:
+	// Size the sketch for about "max_entries" distinct keys of interest.
+	explicit FrequencySketch(size_t max_entries);
+
+	// Record one occurrence of the key with the given hash.
+	void Increment(uint32_t hash);
+
+	// Return the estimated number of occurrences, at most 15.
+	int Estimate(uint32_t hash) const;
+
+private:
+	// Position of the i-th counter of "hash": the word in table_ and the
+	// counter within it.
+	void Locate(uint32_t hash, int i, uint32_t* word, int* shift) const;
+
+	void Reset();
+
+	std::vector<uint64_t> table_;   // 16 counters per word
+	uint32_t mask_;                 // table_.size() - 1
+	size_t additions_;
+	size_t sample_size_;
+
+	// No copying allowed
+	FrequencySketch(const FrequencySketch&);
+	void operator=(const FrequencySketch&);
+};
+
+}  // namespace leveldb
+
+#endif  // STORAGE_LEVELDB_UTIL_FREQUENCY_SKETCH_H_
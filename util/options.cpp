@@ -0,0 +1,31 @@
+#include "include/leveldb/options.h"
+
+#include "include/leveldb/comparator.h"
+
+namespace leveldb {
+
+Options::Options()
+	: comparator(BytewiseComparator()),
+	  block_restart_interval(16),
+	  filter_policy(NULL),
+	  whole_table_filter(false),
+	  prefix_extractor(NULL),
+	  range_filter(false),
+	  block_size(4096),
+	  compression(kSnappyCompression),
+	  paranoid_checks(false),
+	  block_cache(NULL),
+	  cache_index_and_filter_blocks(false),
+	  compressed_block_cache(NULL),
+	  persistent_cache(NULL),
+	  use_mmap_reads(true),
+	  advise_random_on_open(true),
+	  tail_prefetch_size(64 * 1024),
+	  plain_table_prefix_length(0),
+	  min_blob_size(0),
+	  blob_cache(NULL),
+	  blob_files(NULL)
+{
+}
+
+}  // namespace leveldb
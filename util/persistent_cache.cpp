@@ -0,0 +1,419 @@
+#include "include/leveldb/persistent_cache.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <map>
+#include <vector>
+#include "include/leveldb/env.h"
+#include "port/port.h"
+#include "util/coding.h"
+#include "util/crc32c.h"
+#include "util/mutexlock.h"
+
+// The cache appends blocks to one file at a time.  Files are numbered in
+// the order they are written and named after their number; a full file
+// is closed and read back from then on, and once the files reach the
+// capacity the oldest is deleted.  An in-memory index maps every key to
+// the file and offset of its record, and is rebuilt when the cache is
+// opened by reading the records of all files, oldest first.
+//
+// File format:
+//    magic: fixed64
+//    record*
+//
+// Record format:
+//    crc: fixed32          masked crc32c of the rest of the record
+//    key size: fixed32
+//    data size: fixed32
+//    key: char[key size]
+//    data: char[data size]
+//
+// A file that was being written when the process died ends at the first
+// record that is incomplete or fails its checksum.
+
+namespace leveldb {
+
+PersistentCache::~PersistentCache() {
+}
+
+PersistentCacheOptions::PersistentCacheOptions()
+	: env(NULL),
+	  capacity(1 << 30),
+	  file_size(4 << 20) {
+}
+
+namespace {
+
+static const uint64_t kFileMagic = 0x6865636163706c6cull;
+static const size_t kFileHeaderSize = 8;
+static const size_t kRecordHeaderSize = 12;
+static const char kFileSuffix[] = ".pcache";
+
+// A full cache file.  Lookups hold a reference while they read it, so
+// that it can be dropped from the cache meanwhile.
+struct CacheFile {
+	RandomAccessFile* file;  // NULL if it could not be opened
+	int refs;
+};
+
+class FilePersistentCache : public PersistentCache {
+public:
+	explicit FilePersistentCache(const PersistentCacheOptions& options);
+	virtual ~FilePersistentCache();
+
+	Status Recover();
+
+	virtual Status Insert(const Slice& key, const Slice& data);
+	virtual Status Lookup(const Slice& key, std::string* data);
+	virtual uint64_t Size();
+
+private:
+	struct Location {
+		uint64_t number;    // Of the file
+		uint32_t offset;    // Of the record in the file
+		uint32_t size;      // Of the data
+	};
+	typedef std::map<std::string, Location> Index;
+	typedef std::map<uint64_t, CacheFile*> FileMap;
+
+	std::string FileName(uint64_t number) const;
+	bool ReadRecord(RandomAccessFile* file, uint64_t offset, std::string* scratch,
+		Slice* key, Slice* data) const;
+	void AddRecords(uint64_t number, RandomAccessFile* file);
+	void Forget(const Slice& key, uint64_t number, uint32_t offset);
+	Status Roll();
+	void DropOldest();
+	static void Unref(CacheFile* f);
+
+	const PersistentCacheOptions options_;
+	const size_t num_files_;       // Including the one being written
+
+	port::Mutex mutex_;
+	Index index_;
+	uint64_t size_;                // Data bytes of the entries in index_
+	FileMap files_;                // The full files, by number
+	uint64_t active_number_;       // Of the file being written
+	WritableFile* active_file_;    // NULL if it could not be created
+	std::string active_contents_;  // Everything appended to active_file_
+
+	// No copying allowed
+	FilePersistentCache(const FilePersistentCache&);
+	void operator=(const FilePersistentCache&);
+};
+
+FilePersistentCache::FilePersistentCache(const PersistentCacheOptions& options)
+	: options_(options),
+	  num_files_(std::max<uint64_t>(2, options.capacity / options.file_size)),
+	  size_(0),
+	  active_number_(0),
+	  active_file_(NULL) {
+}
+
+FilePersistentCache::~FilePersistentCache() {
+	if (active_file_ != NULL) {
+		active_file_->Close();
+		delete active_file_;
+	}
+	for (FileMap::iterator it = files_.begin(); it != files_.end(); ++it) {
+		assert(it->second->refs == 1);
+		Unref(it->second);
+	}
+}
+
+std::string FilePersistentCache::FileName(uint64_t number) const {
+	char buf[32];
+	snprintf(buf, sizeof(buf), "/%06llu%s", static_cast<unsigned long long>(number), kFileSuffix);
+	return options_.path + buf;
+}
+
+// Read the record at "offset" of "file" and point *key and *data at its
+// parts, which may live in *scratch.  Returns false at the end of the
+// file or at a damaged record.
+bool FilePersistentCache::ReadRecord(RandomAccessFile* file, uint64_t offset,
+	std::string* scratch, Slice* key, Slice* data) const {
+	char buf[kRecordHeaderSize];
+	Slice header;
+	if (!file->Read(offset, kRecordHeaderSize, &header, buf).ok() ||
+		header.size() != kRecordHeaderSize) {
+		return false;
+	}
+	const uint32_t crc = crc32c::Unmask(DecodeFixed32(header.data()));
+	const uint32_t key_size = DecodeFixed32(header.data() + 4);
+	const uint32_t data_size = DecodeFixed32(header.data() + 8);
+	if (key_size > options_.file_size || data_size > options_.file_size) {
+		return false;
+	}
+	const uint32_t header_crc = crc32c::Value(header.data() + 4, 8);
+
+	const size_t n = static_cast<size_t>(key_size) + data_size;
+	scratch->resize(n);
+	Slice body;
+	if (!file->Read(offset + kRecordHeaderSize, n, &body, &(*scratch)[0]).ok() ||
+		body.size() != n ||
+		crc32c::Extend(header_crc, body.data(), n) != crc) {
+		return false;
+	}
+	*key = Slice(body.data(), key_size);
+	*data = Slice(body.data() + key_size, data_size);
+	return true;
+}
+
+// Index the records of the full file "number".  Entries of older files
+// with the same keys are replaced.
+void FilePersistentCache::AddRecords(uint64_t number, RandomAccessFile* file) {
+	std::string scratch;
+	Slice key, data;
+	uint64_t offset = kFileHeaderSize;
+	while (ReadRecord(file, offset, &scratch, &key, &data)) {
+		Location loc;
+		loc.number = number;
+		loc.offset = static_cast<uint32_t>(offset);
+		loc.size = static_cast<uint32_t>(data.size());
+		std::pair<Index::iterator, bool> r = index_.insert(std::make_pair(key.ToString(), loc));
+		if (!r.second) {
+			size_ -= r.first->second.size;
+			r.first->second = loc;
+		}
+		size_ += loc.size;
+		offset += kRecordHeaderSize + key.size() + data.size();
+	}
+}
+
+// Remove the entry for "key" if it is still the record at "offset" of
+// file "number".
+void FilePersistentCache::Forget(const Slice& key, uint64_t number, uint32_t offset) {
+	mutex_.AssertHeld();
+	Index::iterator it = index_.find(key.ToString());
+	if (it != index_.end() && it->second.number == number && it->second.offset == offset) {
+		size_ -= it->second.size;
+		index_.erase(it);
+	}
+}
+
+void FilePersistentCache::Unref(CacheFile* f) {
+	assert(f->refs > 0);
+	f->refs--;
+	if (f->refs == 0) {
+		delete f->file;
+		delete f;
+	}
+}
+
+// Delete the oldest full file and forget its records.
+void FilePersistentCache::DropOldest() {
+	mutex_.AssertHeld();
+	const uint64_t number = files_.begin()->first;
+	CacheFile* f = files_.begin()->second;
+	files_.erase(files_.begin());
+	if (f->file != NULL) {
+		std::string scratch;
+		Slice key, data;
+		uint64_t offset = kFileHeaderSize;
+		while (ReadRecord(f->file, offset, &scratch, &key, &data)) {
+			Forget(key, number, static_cast<uint32_t>(offset));
+			offset += kRecordHeaderSize + key.size() + data.size();
+		}
+	}
+	// Entries of records that could not be read are found stale, and
+	// removed, by Lookup()
+	options_.env->RemoveFile(FileName(number));
+	Unref(f);
+}
+
+// Close the file being written, if any, and start the next one.
+Status FilePersistentCache::Roll() {
+	mutex_.AssertHeld();
+	if (active_file_ != NULL) {
+		active_file_->Close();
+		delete active_file_;
+		active_file_ = NULL;
+		CacheFile* f = new CacheFile;
+		f->refs = 1;
+		if (!options_.env->NewRandomAccessFile(FileName(active_number_), &f->file).ok()) {
+			f->file = NULL;
+		}
+		files_[active_number_] = f;
+	}
+	active_contents_.clear();
+	while (files_.size() + 1 > num_files_) {
+		DropOldest();
+	}
+
+	active_number_++;
+	WritableFileOptions file_options;
+	file_options.preallocation_size = options_.file_size;
+	Status s = options_.env->NewWritableFile(FileName(active_number_), file_options, &active_file_);
+	if (s.ok()) {
+		PutFixed64(&active_contents_, kFileMagic);
+		s = active_file_->Append(active_contents_);
+	}
+	return s;
+}
+
+Status FilePersistentCache::Recover() {
+	std::vector<std::string> children;
+	Status s = options_.env->GetChildren(options_.path, &children);
+	if (!s.ok()) {
+		return s;
+	}
+	const size_t suffix_length = sizeof(kFileSuffix) - 1;
+	std::vector<uint64_t> numbers;
+	for (size_t i = 0; i < children.size(); i++) {
+		const std::string& name = children[i];
+		if (name.size() <= suffix_length ||
+			name.compare(name.size() - suffix_length, suffix_length, kFileSuffix) != 0 ||
+			name.find_first_not_of("0123456789") != name.size() - suffix_length) {
+			continue;
+		}
+		numbers.push_back(strtoull(name.c_str(), NULL, 10));
+	}
+	std::sort(numbers.begin(), numbers.end());
+
+	MutexLock l(&mutex_);
+	for (size_t i = 0; i < numbers.size(); i++) {
+		const uint64_t number = numbers[i];
+		active_number_ = number;
+		// Keep the newest files that fit next to a new one
+		RandomAccessFile* file = NULL;
+		if (numbers.size() - i >= num_files_ ||
+			!options_.env->NewRandomAccessFile(FileName(number), &file).ok()) {
+			options_.env->RemoveFile(FileName(number));
+			continue;
+		}
+		char buf[kFileHeaderSize];
+		Slice header;
+		if (!file->Read(0, kFileHeaderSize, &header, buf).ok() ||
+			header.size() != kFileHeaderSize ||
+			DecodeFixed64(header.data()) != kFileMagic) {
+			delete file;
+			options_.env->RemoveFile(FileName(number));
+			continue;
+		}
+		AddRecords(number, file);
+		CacheFile* f = new CacheFile;
+		f->file = file;
+		f->refs = 1;
+		files_[number] = f;
+	}
+	return Roll();
+}
+
+Status FilePersistentCache::Insert(const Slice& key, const Slice& data) {
+	const size_t record_size = kRecordHeaderSize + key.size() + data.size();
+	if (kFileHeaderSize + record_size > options_.file_size) {
+		return Status::InvalidArgument("entry too large for the persistent cache");
+	}
+
+	MutexLock l(&mutex_);
+	const std::string k = key.ToString();
+	if (index_.find(k) != index_.end()) {
+		return Status::OK();
+	}
+	Status s;
+	if (active_file_ == NULL || active_contents_.size() + record_size > options_.file_size) {
+		s = Roll();
+		if (!s.ok()) {
+			return s;
+		}
+	}
+
+	char header[kRecordHeaderSize];
+	EncodeFixed32(header + 4, static_cast<uint32_t>(key.size()));
+	EncodeFixed32(header + 8, static_cast<uint32_t>(data.size()));
+	uint32_t crc = crc32c::Value(header + 4, 8);
+	crc = crc32c::Extend(crc, key.data(), key.size());
+	crc = crc32c::Extend(crc, data.data(), data.size());
+	EncodeFixed32(header, crc32c::Mask(crc));
+
+	const size_t offset = active_contents_.size();
+	active_contents_.append(header, kRecordHeaderSize);
+	active_contents_.append(key.data(), key.size());
+	active_contents_.append(data.data(), data.size());
+	s = active_file_->Append(Slice(active_contents_.data() + offset, record_size));
+	if (!s.ok()) {
+		// Give up on the file.  The records it has are still served until
+		// a read finds them damaged.
+		active_contents_.resize(offset);
+		Roll();
+		return s;
+	}
+
+	Location loc;
+	loc.number = active_number_;
+	loc.offset = static_cast<uint32_t>(offset);
+	loc.size = static_cast<uint32_t>(data.size());
+	index_[k] = loc;
+	size_ += loc.size;
+	return s;
+}
+
+Status FilePersistentCache::Lookup(const Slice& key, std::string* data) {
+	Location loc;
+	CacheFile* f = NULL;
+	{
+		MutexLock l(&mutex_);
+		Index::iterator it = index_.find(key.ToString());
+		if (it == index_.end()) {
+			return Status::NotFound(Slice());
+		}
+		loc = it->second;
+		if (loc.number == active_number_) {
+			// Not on disk completely yet; served from memory
+			data->assign(active_contents_.data() + loc.offset + kRecordHeaderSize + key.size(),
+				loc.size);
+			return Status::OK();
+		}
+		FileMap::iterator fit = files_.find(loc.number);
+		if (fit == files_.end() || fit->second->file == NULL) {
+			Forget(key, loc.number, loc.offset);
+			return Status::NotFound(Slice());
+		}
+		f = fit->second;
+		f->refs++;
+	}
+
+	std::string scratch;
+	Slice k, d;
+	const bool ok = ReadRecord(f->file, loc.offset, &scratch, &k, &d) &&
+		k == key && d.size() == loc.size;
+	if (ok) {
+		data->assign(d.data(), d.size());
+	}
+
+	MutexLock l(&mutex_);
+	Unref(f);
+	if (!ok) {
+		Forget(key, loc.number, loc.offset);
+		return Status::NotFound(Slice());
+	}
+	return Status::OK();
+}
+
+uint64_t FilePersistentCache::Size() {
+	MutexLock l(&mutex_);
+	return size_;
+}
+
+}  // namespace
+
+Status NewPersistentCache(const PersistentCacheOptions& options, PersistentCache** result) {
+	*result = NULL;
+	if (options.env == NULL) {
+		return Status::InvalidArgument("persistent cache needs an env");
+	}
+	if (options.file_size <= kFileHeaderSize + kRecordHeaderSize) {
+		return Status::InvalidArgument("persistent cache file_size is too small");
+	}
+	FilePersistentCache* cache = new FilePersistentCache(options);
+	Status s = cache->Recover();
+	if (!s.ok()) {
+		delete cache;
+		return s;
+	}
+	*result = cache;
+	return s;
+}
+
+}  // namespace leveldb
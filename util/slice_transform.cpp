@@ -0,0 +1,95 @@
+#include "include/leveldb/slice_transform.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <string>
+
+namespace leveldb {
+
+SliceTransform::~SliceTransform() { }
+
+namespace {
+
+class FixedPrefixTransform : public SliceTransform {
+public:
+	explicit FixedPrefixTransform(size_t prefix_len)
+		: prefix_len_(prefix_len) {
+		char buf[64];
+		snprintf(buf, sizeof(buf), "leveldb.FixedPrefix.%llu",
+			static_cast<unsigned long long>(prefix_len));
+		name_ = buf;
+	}
+
+	virtual const char* Name() const {
+		return name_.c_str();
+	}
+
+	virtual Slice Transform(const Slice& key) const {
+		assert(InDomain(key));
+		return Slice(key.data(), prefix_len_);
+	}
+
+	virtual bool InDomain(const Slice& key) const {
+		return key.size() >= prefix_len_;
+	}
+
+private:
+	size_t prefix_len_;
+	std::string name_;
+};
+
+class DelimitedPrefixTransform : public SliceTransform {
+public:
+	DelimitedPrefixTransform(char delimiter, int count)
+		: delimiter_(delimiter),
+		  count_(count) {
+		char buf[64];
+		snprintf(buf, sizeof(buf), "leveldb.DelimitedPrefix.%d.%d",
+			static_cast<int>(static_cast<unsigned char>(delimiter)), count);
+		name_ = buf;
+	}
+
+	virtual const char* Name() const {
+		return name_.c_str();
+	}
+
+	virtual Slice Transform(const Slice& key) const {
+		size_t n = PrefixLength(key);
+		assert(n > 0);
+		return Slice(key.data(), n);
+	}
+
+	virtual bool InDomain(const Slice& key) const {
+		return PrefixLength(key) > 0;
+	}
+
+private:
+	// Return the length of the prefix of "key", or 0 if the key has fewer
+	// than count_ delimiters.
+	size_t PrefixLength(const Slice& key) const {
+		int seen = 0;
+		for (size_t i = 0; i < key.size(); i++) {
+			if (key[i] == delimiter_ && ++seen == count_) {
+				return i + 1;
+			}
+		}
+		return 0;
+	}
+
+	char delimiter_;
+	int count_;
+	std::string name_;
+};
+
+}  // namespace
+
+const SliceTransform* NewFixedPrefixTransform(size_t prefix_len) {
+	return new FixedPrefixTransform(prefix_len);
+}
+
+const SliceTransform* NewDelimitedPrefixTransform(char delimiter, int count) {
+	assert(count > 0);
+	return new DelimitedPrefixTransform(delimiter, count);
+}
+
+}  // namespace leveldb